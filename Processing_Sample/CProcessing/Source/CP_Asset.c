@@ -0,0 +1,271 @@
+//---------------------------------------------------------
+// file:	CP_Asset.c
+// author:	CProcessing contributors
+// brief:	Reference counted registry of loaded images, fonts and sounds, indexed by path
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+//------------------------------------------------------------------------------
+// Defines and Internal Variables:
+//------------------------------------------------------------------------------
+
+typedef struct CP_AssetEntry
+{
+	void* asset;				// NULL when the slot is empty or deleted
+	bool deleted;				// keeps probe chains intact after a removal
+	CP_ASSET_TYPE type;
+	unsigned hash;
+	int refCount;
+	char filepath[MAX_PATH];	// normalized path
+} CP_AssetEntry;
+
+// Open addressing hash table with linear probing
+static CP_AssetEntry* _entries = NULL;
+static unsigned _capacity = 0;
+static unsigned _count = 0;
+static unsigned _deleted = 0;
+
+static unsigned _hits = 0;
+static unsigned _misses = 0;
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+// The same file can be named in many ways, so paths are compared in a canonical form:
+// forward slashes, lower case, and no "./" or repeated separators.
+static void CP_Asset_NormalizePath(const char* filepath, char* normalized)
+{
+	unsigned length = 0;
+
+	while (filepath[0] == '.' && (filepath[1] == '/' || filepath[1] == '\\'))
+	{
+		filepath += 2;
+	}
+
+	for (; *filepath && length < MAX_PATH - 1; ++filepath)
+	{
+		char c = *filepath == '\\' ? '/' : (char)tolower((unsigned char)*filepath);
+		if (c == '/' && length > 0 && normalized[length - 1] == '/')
+		{
+			continue;
+		}
+		if (c == '.' && length > 0 && normalized[length - 1] == '/' &&
+			(filepath[1] == '/' || filepath[1] == '\\'))
+		{
+			// skip a "./" in the middle of the path
+			continue;
+		}
+		normalized[length++] = c;
+	}
+	normalized[length] = '\0';
+}
+
+// FNV-1a
+static unsigned CP_Asset_Hash(CP_ASSET_TYPE type, const char* normalized)
+{
+	unsigned hash = 2166136261u ^ (unsigned)type;
+	for (; *normalized; ++normalized)
+	{
+		hash ^= (unsigned char)*normalized;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static CP_AssetEntry* CP_Asset_Find(CP_ASSET_TYPE type, const char* normalized, unsigned hash)
+{
+	if (_capacity == 0)
+	{
+		return NULL;
+	}
+
+	for (unsigned i = hash & (_capacity - 1); ; i = (i + 1) & (_capacity - 1))
+	{
+		CP_AssetEntry* entry = &_entries[i];
+		if (!entry->asset && !entry->deleted)
+		{
+			// an empty slot ends the probe chain
+			return NULL;
+		}
+		if (entry->asset && entry->hash == hash && entry->type == type && !strcmp(entry->filepath, normalized))
+		{
+			return entry;
+		}
+	}
+}
+
+static bool CP_Asset_Grow(void)
+{
+	// double when mostly full, otherwise rebuild at the same size to clear deleted slots
+	unsigned capacity = _capacity == 0 ? CP_ASSET_INITIAL_CAPACITY : (_count * 2 >= _capacity ? _capacity * 2 : _capacity);
+	CP_AssetEntry* entries = (CP_AssetEntry*)calloc(capacity, sizeof(CP_AssetEntry));
+	if (!entries)
+	{
+		return false;
+	}
+
+	for (unsigned i = 0; i < _capacity; ++i)
+	{
+		if (_entries[i].asset)
+		{
+			unsigned slot = _entries[i].hash & (capacity - 1);
+			while (entries[slot].asset)
+			{
+				slot = (slot + 1) & (capacity - 1);
+			}
+			entries[slot] = _entries[i];
+		}
+	}
+
+	free(_entries);
+	_entries = entries;
+	_capacity = capacity;
+	_deleted = 0;
+	return true;
+}
+
+static void CP_Asset_Remove(CP_AssetEntry* entry)
+{
+	entry->asset = NULL;
+	entry->deleted = true;
+	--_count;
+	++_deleted;
+}
+
+void* CP_Asset_Acquire(CP_ASSET_TYPE type, const char* filepath)
+{
+	char normalized[MAX_PATH];
+	CP_Asset_NormalizePath(filepath, normalized);
+
+	CP_AssetEntry* entry = CP_Asset_Find(type, normalized, CP_Asset_Hash(type, normalized));
+	if (!entry)
+	{
+		++_misses;
+		return NULL;
+	}
+
+	++_hits;
+	++entry->refCount;
+	return entry->asset;
+}
+
+bool CP_Asset_Register(CP_ASSET_TYPE type, const char* filepath, void* asset)
+{
+	if (!asset)
+	{
+		return false;
+	}
+
+	// keep the table at most 3/4 full, counting deleted slots since they lengthen probes
+	if ((_count + _deleted + 1) * 4 > _capacity * 3 && !CP_Asset_Grow())
+	{
+		return false;
+	}
+
+	CP_AssetEntry* entry = NULL;
+	char normalized[MAX_PATH];
+	CP_Asset_NormalizePath(filepath, normalized);
+	unsigned hash = CP_Asset_Hash(type, normalized);
+
+	for (unsigned i = hash & (_capacity - 1); ; i = (i + 1) & (_capacity - 1))
+	{
+		if (!_entries[i].asset)
+		{
+			entry = &_entries[i];
+			break;
+		}
+	}
+
+	if (entry->deleted)
+	{
+		--_deleted;
+	}
+	entry->asset = asset;
+	entry->deleted = false;
+	entry->type = type;
+	entry->hash = hash;
+	entry->refCount = 1;
+	strcpy_s(entry->filepath, MAX_PATH, normalized);
+	++_count;
+	return true;
+}
+
+bool CP_Asset_Release(CP_ASSET_TYPE type, const char* filepath, void* asset)
+{
+	char normalized[MAX_PATH];
+	CP_Asset_NormalizePath(filepath, normalized);
+
+	CP_AssetEntry* entry = CP_Asset_Find(type, normalized, CP_Asset_Hash(type, normalized));
+	if (!entry || entry->asset != asset)
+	{
+		// not a registered asset
+		return false;
+	}
+
+	if (--entry->refCount > 0)
+	{
+		return false;
+	}
+
+	CP_Asset_Remove(entry);
+	return true;
+}
+
+void CP_Asset_ReleaseAll(CP_ASSET_TYPE type, CP_AssetReleaseFunction release)
+{
+	for (unsigned i = 0; i < _capacity; ++i)
+	{
+		CP_AssetEntry* entry = &_entries[i];
+		if (entry->asset && entry->type == type)
+		{
+			void* asset = entry->asset;
+			CP_Asset_Remove(entry);
+			if (release) release(asset);
+		}
+	}
+}
+
+void CP_Asset_Shutdown(void)
+{
+	free(_entries);
+	_entries = NULL;
+	_capacity = 0;
+	_count = 0;
+	_deleted = 0;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+// Returns the number of images, fonts and sounds currently loaded.
+CP_API unsigned CP_Asset_GetCount(void)
+{
+	return _count;
+}
+
+// Returns how many loads found the asset already loaded.
+CP_API unsigned CP_Asset_GetHitCount(void)
+{
+	return _hits;
+}
+
+// Returns how many loads had to read the asset from disk.
+CP_API unsigned CP_Asset_GetMissCount(void)
+{
+	return _misses;
+}
+
+CP_API void CP_Asset_ResetStats(void)
+{
+	_hits = 0;
+	_misses = 0;
+}
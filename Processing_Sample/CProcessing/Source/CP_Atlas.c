@@ -0,0 +1,333 @@
+//---------------------------------------------------------
+// file:	CP_Atlas.c
+// author:	CProcessing contributors
+// brief:	Packs images into shared textures so sprites from the same page draw in one batch
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+//------------------------------------------------------------------------------
+// Defines and Internal Variables:
+//------------------------------------------------------------------------------
+
+// One segment of the skyline, the top edge of everything packed below it
+typedef struct CP_AtlasNode
+{
+	int x;
+	int y;
+	int w;
+} CP_AtlasNode;
+
+typedef struct CP_AtlasPage
+{
+	int handle;					// nanoVG image of the page
+	unsigned char* pixels;		// copy of the page, uploads and reads go through it
+	CP_AtlasNode* skyline;		// segments from left to right, covering the whole width
+	int nodeCount;
+	int imageCount;
+	int usedPixels;				// pixels covered by images, not counting padding
+} CP_AtlasPage;
+
+static CP_AtlasPage* _pages = NULL;
+static int _pageCount = 0;
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+static void CP_Atlas_ResetSkyline(CP_AtlasPage* page)
+{
+	page->skyline[0].x = 0;
+	page->skyline[0].y = 0;
+	page->skyline[0].w = CP_ATLAS_PAGE_SIZE;
+	page->nodeCount = 1;
+}
+
+static CP_AtlasPage* CP_Atlas_AddPage(void)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_AtlasPage* pages = (CP_AtlasPage*)realloc(_pages, sizeof(CP_AtlasPage) * (_pageCount + 1));
+	if (!pages)
+	{
+		return NULL;
+	}
+	_pages = pages;
+
+	CP_AtlasPage* page = &_pages[_pageCount];
+	memset(page, 0, sizeof(CP_AtlasPage));
+	page->pixels = (unsigned char*)calloc((size_t)CP_ATLAS_PAGE_SIZE * CP_ATLAS_PAGE_SIZE, 4);
+	// the skyline never has more segments than the page has columns
+	page->skyline = (CP_AtlasNode*)malloc(sizeof(CP_AtlasNode) * (CP_ATLAS_PAGE_SIZE + 1));
+	if (page->pixels && page->skyline)
+	{
+		page->handle = nvgCreateImageRGBA(CORE->nvg, CP_ATLAS_PAGE_SIZE, CP_ATLAS_PAGE_SIZE, 0, page->pixels);
+	}
+	if (page->handle == 0)
+	{
+		free(page->pixels);
+		free(page->skyline);
+		return NULL;
+	}
+
+	CP_Atlas_ResetSkyline(page);
+	++_pageCount;
+	return page;
+}
+
+// Returns the lowest y a w by h rect can sit at with its left edge on the node, or -1 if it doesn't fit.
+static int CP_Atlas_Fit(const CP_AtlasPage* page, int node, int w, int h)
+{
+	int y = 0;
+	int remaining = w;
+
+	if (page->skyline[node].x + w > CP_ATLAS_PAGE_SIZE)
+	{
+		return -1;
+	}
+
+	// the rect rests on the highest segment below it
+	for (; remaining > 0 && node < page->nodeCount; ++node)
+	{
+		y = max(y, page->skyline[node].y);
+		if (y + h > CP_ATLAS_PAGE_SIZE)
+		{
+			return -1;
+		}
+		remaining -= page->skyline[node].w;
+	}
+	return y;
+}
+
+// Bottom-left skyline packing: the spot with the lowest top edge wins, ties go to the narrowest segment.
+static bool CP_Atlas_Pack(CP_AtlasPage* page, int w, int h, int* x, int* y)
+{
+	int best = -1;
+	int bestTop = CP_ATLAS_PAGE_SIZE + 1;
+	int bestWidth = CP_ATLAS_PAGE_SIZE + 1;
+
+	for (int i = 0; i < page->nodeCount; ++i)
+	{
+		int fit = CP_Atlas_Fit(page, i, w, h);
+		if (fit >= 0 && (fit + h < bestTop || (fit + h == bestTop && page->skyline[i].w < bestWidth)))
+		{
+			best = i;
+			bestTop = fit + h;
+			bestWidth = page->skyline[i].w;
+		}
+	}
+	if (best < 0)
+	{
+		return false;
+	}
+
+	*x = page->skyline[best].x;
+	*y = bestTop - h;
+
+	// the new segment covers the rect, insert it before the one it starts on
+	memmove(&page->skyline[best + 1], &page->skyline[best], sizeof(CP_AtlasNode) * (page->nodeCount - best));
+	page->skyline[best].x = *x;
+	page->skyline[best].y = bestTop;
+	page->skyline[best].w = w;
+	++page->nodeCount;
+
+	// trim or drop the segments now hidden under it
+	for (int i = best + 1; i < page->nodeCount; )
+	{
+		CP_AtlasNode* node = &page->skyline[i];
+		int overlap = page->skyline[i - 1].x + page->skyline[i - 1].w - node->x;
+		if (overlap <= 0)
+		{
+			break;
+		}
+		if (overlap < node->w)
+		{
+			node->x += overlap;
+			node->w -= overlap;
+			break;
+		}
+		memmove(node, node + 1, sizeof(CP_AtlasNode) * (page->nodeCount - i - 1));
+		--page->nodeCount;
+	}
+
+	// join neighbors at the same height
+	for (int i = 0; i + 1 < page->nodeCount; )
+	{
+		if (page->skyline[i].y == page->skyline[i + 1].y)
+		{
+			page->skyline[i].w += page->skyline[i + 1].w;
+			memmove(&page->skyline[i + 1], &page->skyline[i + 2], sizeof(CP_AtlasNode) * (page->nodeCount - i - 2));
+			--page->nodeCount;
+		}
+		else
+		{
+			++i;
+		}
+	}
+	return true;
+}
+
+// Copies the image into its place on the page, repeating the edge pixels into the padding, and uploads it.
+static void CP_Atlas_Blit(CP_AtlasPage* page, CP_Image img, const unsigned char* pixels)
+{
+	const int x0 = img->atlas_x - CP_ATLAS_PADDING;
+	const int y0 = img->atlas_y - CP_ATLAS_PADDING;
+	const int w = img->w + CP_ATLAS_PADDING * 2;
+	const int h = img->h + CP_ATLAS_PADDING * 2;
+
+	for (int row = 0; row < h; ++row)
+	{
+		const int srcRow = CP_Math_ClampInt(row - CP_ATLAS_PADDING, 0, img->h - 1);
+		const unsigned char* src = pixels + (size_t)srcRow * img->w * 4;
+		unsigned char* dst = page->pixels + ((size_t)(y0 + row) * CP_ATLAS_PAGE_SIZE + x0) * 4;
+
+		for (int col = 0; col < CP_ATLAS_PADDING; ++col)
+		{
+			memcpy(dst + col * 4, src, 4);
+			memcpy(dst + (CP_ATLAS_PADDING + img->w + col) * 4, src + (img->w - 1) * 4, 4);
+		}
+		memcpy(dst + CP_ATLAS_PADDING * 4, src, (size_t)img->w * 4);
+	}
+
+	nvgUpdateImageRect(GetCPCore()->nvg, page->handle, x0, y0, w, h, page->pixels);
+}
+
+bool CP_Atlas_Add(CP_Image img, const unsigned char* pixels)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!img || !pixels || !CORE || !CORE->nvg || img->atlas_page >= 0 ||
+		img->w <= 0 || img->h <= 0 || img->w > CP_ATLAS_MAX_IMAGE_SIZE || img->h > CP_ATLAS_MAX_IMAGE_SIZE)
+	{
+		return false;
+	}
+
+	const int w = img->w + CP_ATLAS_PADDING * 2;
+	const int h = img->h + CP_ATLAS_PADDING * 2;
+	int page = 0, x = 0, y = 0;
+
+	// first fit over the pages, start a new one when none has room
+	while (page < _pageCount && !CP_Atlas_Pack(&_pages[page], w, h, &x, &y))
+	{
+		++page;
+	}
+	if (page == _pageCount && (!CP_Atlas_AddPage() || !CP_Atlas_Pack(&_pages[page], w, h, &x, &y)))
+	{
+		return false;
+	}
+
+	img->atlas_page = page;
+	img->atlas_x = x + CP_ATLAS_PADDING;
+	img->atlas_y = y + CP_ATLAS_PADDING;
+	CP_Atlas_Blit(&_pages[page], img, pixels);
+
+	++_pages[page].imageCount;
+	_pages[page].usedPixels += img->w * img->h;
+	return true;
+}
+
+void CP_Atlas_Remove(CP_Image img)
+{
+	if (!img || img->atlas_page < 0 || img->atlas_page >= _pageCount)
+	{
+		return;
+	}
+
+	CP_AtlasPage* page = &_pages[img->atlas_page];
+	page->usedPixels -= img->w * img->h;
+
+	// the skyline can't give back space in the middle, so a page is only reused once it is empty
+	if (--page->imageCount == 0)
+	{
+		page->usedPixels = 0;
+		CP_Atlas_ResetSkyline(page);
+	}
+	img->atlas_page = -1;
+}
+
+int CP_Atlas_GetPageHandle(CP_Image img)
+{
+	if (!img || img->atlas_page < 0 || img->atlas_page >= _pageCount)
+	{
+		return 0;
+	}
+	return _pages[img->atlas_page].handle;
+}
+
+void CP_Atlas_ReadPixels(CP_Image img, unsigned char* pixels)
+{
+	if (!img || !pixels || img->atlas_page < 0 || img->atlas_page >= _pageCount)
+	{
+		return;
+	}
+
+	const CP_AtlasPage* page = &_pages[img->atlas_page];
+	for (int row = 0; row < img->h; ++row)
+	{
+		memcpy(pixels + (size_t)row * img->w * 4,
+			page->pixels + ((size_t)(img->atlas_y + row) * CP_ATLAS_PAGE_SIZE + img->atlas_x) * 4,
+			(size_t)img->w * 4);
+	}
+}
+
+void CP_Atlas_WritePixels(CP_Image img, const unsigned char* pixels)
+{
+	if (!img || !pixels || img->atlas_page < 0 || img->atlas_page >= _pageCount)
+	{
+		return;
+	}
+	CP_Atlas_Blit(&_pages[img->atlas_page], img, pixels);
+}
+
+void CP_Atlas_Shutdown(void)
+{
+	CP_CorePtr CORE = GetCPCore();
+
+	for (int i = 0; i < _pageCount; ++i)
+	{
+		if (CORE && CORE->nvg)
+		{
+			nvgDeleteImage(CORE->nvg, _pages[i].handle);
+		}
+		free(_pages[i].pixels);
+		free(_pages[i].skyline);
+	}
+	free(_pages);
+	_pages = NULL;
+	_pageCount = 0;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+// Returns the number of atlas textures in use.
+CP_API unsigned CP_Atlas_GetPageCount(void)
+{
+	return (unsigned)_pageCount;
+}
+
+// Returns the number of images packed into atlas pages.
+CP_API unsigned CP_Atlas_GetImageCount(void)
+{
+	unsigned count = 0;
+	for (int i = 0; i < _pageCount; ++i)
+	{
+		count += (unsigned)_pages[i].imageCount;
+	}
+	return count;
+}
+
+// Returns the fraction of atlas pixels covered by images, from 0 to 1.
+CP_API float CP_Atlas_GetOccupancy(void)
+{
+	double used = 0;
+	for (int i = 0; i < _pageCount; ++i)
+	{
+		used += _pages[i].usedPixels;
+	}
+	return _pageCount ? (float)(used / ((double)_pageCount * CP_ATLAS_PAGE_SIZE * CP_ATLAS_PAGE_SIZE)) : 0.0f;
+}
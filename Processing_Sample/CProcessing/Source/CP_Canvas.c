@@ -0,0 +1,225 @@
+//---------------------------------------------------------
+// file:	CP_Canvas.c
+// author:	CProcessing contributors
+// brief:	Offscreen canvases drawn into like the window and drawn as images
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+//------------------------------------------------------------------------------
+// Defines and Internal Variables:
+//------------------------------------------------------------------------------
+
+// The pixels of a canvas are a render target image, GetCPCore returns its
+// copy of the core between Begin and End so drawing sees the canvas size
+typedef struct CP_Canvas_Struct
+{
+	CP_Core core;
+	CP_Image_Struct image;
+	struct NVGLUframebuffer* framebuffer;	// NULL with the software renderer
+	CP_CanvasCallback render;
+	void* userData;
+	CP_BOOL dirty;
+	CP_BOOL freed;							// released at the start of the next frame
+	struct CP_Canvas_Struct* next;
+} CP_Canvas_Struct;
+
+static CP_Canvas canvases = NULL;		// every canvas, including the freed ones not released yet
+static CP_Canvas activeCanvas = NULL;	// the canvas between Begin and End
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+static void CP_Canvas_Release(CP_Canvas canvas)
+{
+	CP_DeleteRenderTargetInternal(canvas->image.handle, canvas->framebuffer);
+	free(canvas);
+}
+
+void CP_Canvas_Update(void)
+{
+	// the last frame that could draw the freed canvases has ended
+	CP_Canvas* link = &canvases;
+	while (*link)
+	{
+		CP_Canvas canvas = *link;
+		if (canvas->freed)
+		{
+			*link = canvas->next;
+			CP_Canvas_Release(canvas);
+		}
+		else
+		{
+			link = &canvas->next;
+		}
+	}
+}
+
+void CP_Canvas_Shutdown(void)
+{
+	while (canvases)
+	{
+		CP_Canvas canvas = canvases;
+		canvases = canvas->next;
+		CP_Canvas_Release(canvas);
+	}
+	activeCanvas = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+CP_API CP_Canvas CP_Canvas_Create(int w, int h)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!CORE || !CORE->nvg || w <= 0 || h <= 0)
+	{
+		return NULL;
+	}
+
+	CP_Canvas canvas = (CP_Canvas)calloc(1, sizeof(CP_Canvas_Struct));
+	if (!canvas)
+	{
+		return NULL;
+	}
+
+	canvas->image.handle = CP_CreateRenderTargetInternal(w, h, &canvas->framebuffer);
+	if (canvas->image.handle == 0)
+	{
+		free(canvas);
+		return NULL;
+	}
+
+	// the image is owned by the canvas, it is never shared through the asset registry
+	sprintf_s(canvas->image.filepath, MAX_PATH, "<canvas %p>", (void*)canvas);
+	canvas->image.w = w;
+	canvas->image.h = h;
+	canvas->image.load_error = FALSE;
+	canvas->image.atlas_page = -1;
+	canvas->image.render_target = TRUE;
+	canvas->dirty = TRUE;
+
+	canvas->next = canvases;
+	canvases = canvas;
+	return canvas;
+}
+
+CP_API void CP_Canvas_Free(CP_Canvas* canvas)
+{
+	if (!canvas || !*canvas)
+	{
+		return;
+	}
+
+	if (*canvas == activeCanvas)
+	{
+		CP_Canvas_End(*canvas);
+	}
+
+	// draws of the canvas made this frame still need its texture
+	(*canvas)->freed = TRUE;
+	*canvas = NULL;
+}
+
+CP_API void CP_Canvas_Begin(CP_Canvas canvas)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!canvas || canvas->freed || activeCanvas || !CORE || !CORE->nvg)
+	{
+		return;
+	}
+
+	// render what was drawn so far to the current target before switching
+	CP_FlushFrameInternal();
+
+	// the canvas is drawn like a window of its own size with the current settings
+	canvas->core = *CORE;
+	canvas->core.window_width = canvas->image.w;
+	canvas->core.window_height = canvas->image.h;
+	canvas->core.canvas_width = canvas->image.w;
+	canvas->core.canvas_height = canvas->image.h;
+	canvas->core.pixel_ratio = 1.0f;
+	canvas->core.isRetained = false;
+	canvas->core.framebuffer = canvas->framebuffer;
+	activeCanvas = canvas;
+	SetThreadCPCore(&canvas->core);
+
+	CP_BindRenderTargetInternal(canvas->image.handle, canvas->framebuffer, canvas->image.w, canvas->image.h);
+	nvgBeginFrame(CORE->nvg, canvas->image.w, canvas->image.h, 1.0f);
+
+	// start at the top left of the canvas with nothing clipped, End puts the transform and scissor back
+	nvgSave(CORE->nvg);
+	nvgResetTransform(CORE->nvg);
+	nvgResetScissor(CORE->nvg);
+
+	canvas->dirty = FALSE;
+}
+
+CP_API void CP_Canvas_End(CP_Canvas canvas)
+{
+	if (!canvas || canvas != activeCanvas)
+	{
+		return;
+	}
+
+	NVGcontext* nvg = canvas->core.nvg;
+	nvgRestore(nvg);
+	CP_FlushFrameInternal();
+
+	activeCanvas = NULL;
+	SetThreadCPCore(NULL);
+
+	// carry on with the frame where it was left
+	CP_CorePtr CORE = GetCPCore();
+	CP_BindRenderTargetInternal(0, NULL, 0, 0);
+	nvgBeginFrame(nvg, CORE->window_width, CORE->window_height, CORE->pixel_ratio);
+}
+
+CP_API void CP_Canvas_SetRenderFunction(CP_Canvas canvas, CP_CanvasCallback render, void* userData)
+{
+	if (!canvas)
+	{
+		return;
+	}
+
+	canvas->render = render;
+	canvas->userData = userData;
+	canvas->dirty = TRUE;
+}
+
+CP_API void CP_Canvas_MarkDirty(CP_Canvas canvas)
+{
+	if (canvas)
+	{
+		canvas->dirty = TRUE;
+	}
+}
+
+CP_API CP_BOOL CP_Canvas_IsDirty(CP_Canvas canvas)
+{
+	return canvas && canvas->dirty;
+}
+
+CP_API CP_Image CP_Canvas_GetImage(CP_Canvas canvas)
+{
+	if (!canvas || canvas->freed)
+	{
+		return NULL;
+	}
+
+	// redraw lazily, only when the image is needed
+	if (canvas->dirty && canvas->render && !activeCanvas)
+	{
+		CP_Canvas_Begin(canvas);
+		canvas->render(canvas, canvas->userData);
+		CP_Canvas_End(canvas);
+	}
+	return &canvas->image;
+}
@@ -0,0 +1,133 @@
+//---------------------------------------------------------
+// file:	CP_DrawList.c
+// author:	CProcessing contributors
+// brief:	Draw lists recorded on worker threads and drawn on the main thread
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+//------------------------------------------------------------------------------
+// Defines and Internal Variables:
+//------------------------------------------------------------------------------
+
+// A copy of the core whose context records instead of drawing,
+// GetCPCore returns it on the thread recording into the list
+typedef struct CP_DrawList_Struct
+{
+	CP_Core core;
+} CP_DrawList_Struct;
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+// Follow the canvas size and settings of the main core, but keep the list's own context and settings
+static void CP_DrawList_SyncCore(CP_DrawList list, CP_CorePtr CORE)
+{
+	CP_Core core = *CORE;
+	core.nvg = list->core.nvg;
+	memcpy(core.states, list->core.states, sizeof(core.states));
+	core.nstates = list->core.nstates;
+	list->core = core;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+CP_API CP_DrawList CP_DrawList_Create(void)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!CORE || !CORE->nvg)
+	{
+		return NULL;
+	}
+
+	CP_DrawList list = (CP_DrawList)calloc(1, sizeof(CP_DrawList_Struct));
+	if (!list)
+	{
+		return NULL;
+	}
+
+	list->core.nvg = nvgCreateCommandList(CORE->nvg);
+	if (!list->core.nvg)
+	{
+		free(list);
+		return NULL;
+	}
+
+	// lists start with the same defaults as the canvas
+	list->core.nstates = 1;
+	list->core.states[0].rect_mode = CP_POSITION_CENTER;
+	list->core.states[0].ellipse_mode = CP_POSITION_CENTER;
+	list->core.states[0].image_mode = CP_POSITION_CENTER;
+	list->core.states[0].fill = TRUE;
+	list->core.states[0].stroke = TRUE;
+	list->core.states[0].camera = CP_Matrix_Identity();
+	CP_DrawList_SyncCore(list, CORE);
+
+	// the list's context has the nanovg defaults, apply the canvas settings to it
+	SetThreadCPCore(&list->core);
+	CP_ApplyDefaultSettingsInternal();
+	SetThreadCPCore(NULL);
+
+	return list;
+}
+
+CP_API void CP_DrawList_Begin(CP_DrawList list)
+{
+	if (!list)
+	{
+		return;
+	}
+
+	// everything drawn on this thread goes to the list until End
+	SetThreadCPCore(&list->core);
+	nvgBeginFrame(list->core.nvg, list->core.window_width, list->core.window_height, list->core.pixel_ratio);
+
+	// match the canvas, which resets its transform every frame
+	nvgResetTransform(list->core.nvg);
+}
+
+CP_API void CP_DrawList_End(CP_DrawList list)
+{
+	if (!list)
+	{
+		return;
+	}
+
+	nvgEndFrame(list->core.nvg);
+	SetThreadCPCore(NULL);
+}
+
+CP_API void CP_DrawList_Submit(CP_DrawList list)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!list || !CORE || !CORE->nvg)
+	{
+		return;
+	}
+
+	// the recorded draws go after what was drawn so far, so the submit order is the draw order
+	nvgSubmitCommandList(CORE->nvg, list->core.nvg);
+
+	// pick up window size changes for the next recording
+	CP_DrawList_SyncCore(list, CORE);
+}
+
+CP_API void CP_DrawList_Free(CP_DrawList* list)
+{
+	if (!list || !*list)
+	{
+		return;
+	}
+
+	nvgDeleteCommandList((*list)->core.nvg);
+	free(*list);
+	*list = NULL;
+}
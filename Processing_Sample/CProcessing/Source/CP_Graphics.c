@@ -10,14 +10,27 @@
 // Include Files:
 //------------------------------------------------------------------------------
 
+#include <stdlib.h>
 #include "cprocessing.h"
 #include "Internal_System.h"
+#include "nanovg_sw.h"
+#include "tinycthread.h"
 
 //------------------------------------------------------------------------------
 // Defines and Internal Variables:
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
-static CP_BOOL firstVertex = FALSE;
+// per thread so draw lists can build shapes in parallel
+static _Thread_local CP_BOOL firstVertex = FALSE;
+
+// retained shapes keep nanoVG's cached geometry
+typedef struct CP_Shape_Struct
+{
+	NVGshape* shape;
+} CP_Shape_Struct;
+
+static _Thread_local CP_BOOL shapeRecording = FALSE;
+static _Thread_local CP_BOOL shapeFirstVertex = FALSE;
 
 //------------------------------------------------------------------------------
 // Internal Functions:
@@ -59,24 +72,30 @@ static void CP_Graphics_DrawRectInternal(float x, float y, float w, float h, flo
 		nvgTranslate(CORE->nvg, -pointOfRotationX, -pointOfRotationY);
 	}
 
-	// Rectangle path
-	nvgBeginPath(CORE->nvg);
-	if (cornerRadius < 0.1f)
-	{
-		nvgRect(CORE->nvg, x, y, w, h);
-	}
-	else
-	{
-		nvgRoundedRect(CORE->nvg, x, y, w, h, cornerRadius);
-	}
-
-	if (DI->fill)
-	{
-		nvgFill(CORE->nvg);
-	}
-	if (DI->stroke)
+	// Rectangles out of view are skipped before any path work, solid color rectangles are batched,
+	// anything else goes through a path
+	if (!nvgCullRect(CORE->nvg, x, y, w, h, DI->stroke) &&
+		(cornerRadius >= 0.1f || !nvgQuad(CORE->nvg, NVG_QUAD_RECT, x + w * 0.5f, y + h * 0.5f, w * 0.5f, h * 0.5f, DI->fill, DI->stroke)))
 	{
-		nvgStroke(CORE->nvg);
+		// Rectangle path
+		nvgBeginPath(CORE->nvg);
+		if (cornerRadius < 0.1f)
+		{
+			nvgRect(CORE->nvg, x, y, w, h);
+		}
+		else
+		{
+			nvgRoundedRect(CORE->nvg, x, y, w, h, cornerRadius);
+		}
+
+		if (DI->fill)
+		{
+			nvgFill(CORE->nvg);
+		}
+		if (DI->stroke)
+		{
+			nvgStroke(CORE->nvg);
+		}
 	}
 
 	if (degrees != 0)
@@ -93,6 +112,17 @@ CP_API void CP_Graphics_ClearBackground(CP_Color c)
 {
 	// Set the background color
 	nvgCancelFrame(GetCPCore()->nvg);	// also wipe any prior render calls this frame
+	if (GetCPCore()->isRetained)
+	{
+		// the rest of the canvas keeps the previous frame
+		CP_ClearDirtyInternal(nvgRGBA(c.r, c.g, c.b, c.a));
+		return;
+	}
+	if (GetCPCore()->isSoftware)
+	{
+		nvgswClear(GetCPCore()->nvg, nvgRGBA(c.r, c.g, c.b, c.a));
+		return;
+	}
 	glClearColor(c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
@@ -102,22 +132,56 @@ CP_API void CP_Graphics_DrawPoint(float x, float y)
 	CP_CorePtr CORE = GetCPCore();
 	CP_DrawInfoPtr DI = GetDrawInfo();
 
-	// Point path and fill
+	// Solid color points are batched with the neighbouring shapes, anything else goes through a path
 	if (DI->fill)
 	{
+		float xy[2] = { x, y };
+		if (nvgPoints(CORE->nvg, xy, NULL, 1))
+		{
+			return;
+		}
+
 		nvgBeginPath(CORE->nvg);
 		nvgPoint(CORE->nvg, x, y);
 		nvgFillPoint(CORE->nvg);
 	}
 }
 
+CP_API void CP_Graphics_DrawPoints(const CP_Vector* positions, const CP_Color* colors, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !positions || count <= 0 || !DI->fill)
+		return;
+
+	// Solid color points are batched in one go, colors replace the stroke color points are drawn with
+	int drawn = nvgPoints(CORE->nvg, &positions[0].x, colors ? colors[0].rgba : NULL, count);
+	if (drawn == count)
+		return;
+
+	// Otherwise draw the rest one path at a time
+	nvgSave(CORE->nvg);
+	for (int i = drawn; i < count; ++i)
+	{
+		if (colors)
+		{
+			nvgStrokeColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		nvgBeginPath(CORE->nvg);
+		nvgPoint(CORE->nvg, positions[i].x, positions[i].y);
+		nvgFillPoint(CORE->nvg);
+	}
+	nvgRestore(CORE->nvg);
+}
+
 CP_API void CP_Graphics_DrawLine(float x1, float y1, float x2, float y2)
 {
 	CP_CorePtr CORE = GetCPCore();
 	CP_DrawInfoPtr DI = GetDrawInfo();
 
 	// Line stroke
-	if (DI->stroke)
+	if (DI->stroke && !nvgCullRect(CORE->nvg, x1, y1, x2 - x1, y2 - y1, TRUE))
 	{
 		nvgBeginPath(CORE->nvg);
 		nvgMoveTo(CORE->nvg, x1, y1);
@@ -138,7 +202,7 @@ CP_API void CP_Graphics_DrawLineAdvanced(float x1, float y1, float x2, float y2,
 	nvgTranslate(CORE->nvg, -((x1 + x2) / 2.0f), -((y1 + y2) / 2.0f));
 
 	// Line stroke
-	if (DI->stroke)
+	if (DI->stroke && !nvgCullRect(CORE->nvg, x1, y1, x2 - x1, y2 - y1, TRUE))
 	{
 		nvgBeginPath(CORE->nvg);
 		nvgMoveTo(CORE->nvg, x1, y1);
@@ -149,6 +213,35 @@ CP_API void CP_Graphics_DrawLineAdvanced(float x1, float y1, float x2, float y2,
 	nvgRestore(CORE->nvg);
 }
 
+CP_API void CP_Graphics_DrawLines(const CP_Vector* points, const CP_Color* colors, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !points || count <= 0 || !DI->stroke)
+		return;
+
+	// Solid color lines are batched in one go
+	int drawn = nvgLines(CORE->nvg, &points[0].x, colors ? colors[0].rgba : NULL, count);
+	if (drawn == count)
+		return;
+
+	// Otherwise draw the rest one path at a time
+	nvgSave(CORE->nvg);
+	for (int i = drawn; i < count; ++i)
+	{
+		if (colors)
+		{
+			nvgStrokeColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		nvgBeginPath(CORE->nvg);
+		nvgMoveTo(CORE->nvg, points[i * 2].x, points[i * 2].y);
+		nvgLineTo(CORE->nvg, points[i * 2 + 1].x, points[i * 2 + 1].y);
+		nvgStroke(CORE->nvg);
+	}
+	nvgRestore(CORE->nvg);
+}
+
 CP_API void CP_Graphics_DrawRect(float x, float y, float w, float h)
 {
 	CP_Graphics_DrawRectInternal(x, y, w, h, 0, 0);
@@ -159,11 +252,77 @@ CP_API void CP_Graphics_DrawRectAdvanced(float x, float y, float w, float h, flo
 	CP_Graphics_DrawRectInternal(x, y, w, h, degrees, cornerRadius);
 }
 
+CP_API void CP_Graphics_DrawRects(const CP_Vector* positions, const CP_Vector* sizes, const CP_Color* colors, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !positions || !sizes || count <= 0 || (!DI->fill && !DI->stroke))
+		return;
+
+	// Solid color rectangles are batched, colors replace the fill (or the stroke if there is no fill)
+	float align = DI->rect_mode == CP_POSITION_CORNER ? 0.5f : 0.0f;
+	int i = 0;
+	while (i < count)
+	{
+		i += nvgQuads(CORE->nvg, NVG_QUAD_RECT, &positions[i].x, &sizes[i].x, 2, align, colors ? colors[i].rgba : NULL, count - i, DI->fill, DI->stroke);
+		if (i == count)
+			break;
+
+		// The batch stopped at a rectangle it can't draw (zero sized ones are stroked as lines), draw it as a path
+		nvgSave(CORE->nvg);
+		if (colors && DI->fill)
+		{
+			nvgFillColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		else if (colors)
+		{
+			nvgStrokeColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		CP_Graphics_DrawRectInternal(positions[i].x, positions[i].y, sizes[i].x, sizes[i].y, 0, 0);
+		nvgRestore(CORE->nvg);
+		++i;
+	}
+}
+
 CP_API void CP_Graphics_DrawCircle(float x, float y, float d)
 {
 	CP_Graphics_DrawEllipse(x, y, d, d);
 }
 
+CP_API void CP_Graphics_DrawCircles(const CP_Vector* positions, const float* diameters, const CP_Color* colors, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !positions || !diameters || count <= 0 || (!DI->fill && !DI->stroke))
+		return;
+
+	// Solid color circles are batched, colors replace the fill (or the stroke if there is no fill)
+	float align = DI->ellipse_mode == CP_POSITION_CORNER ? 0.5f : 0.0f;
+	int i = 0;
+	while (i < count)
+	{
+		i += nvgQuads(CORE->nvg, NVG_QUAD_ELLIPSE, &positions[i].x, &diameters[i], 1, align, colors ? colors[i].rgba : NULL, count - i, DI->fill, DI->stroke);
+		if (i == count)
+			break;
+
+		// The batch stopped at a circle it can't draw (a zero diameter one is stroked like in DrawCircle), draw it as a path
+		nvgSave(CORE->nvg);
+		if (colors && DI->fill)
+		{
+			nvgFillColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		else if (colors)
+		{
+			nvgStrokeColor(CORE->nvg, nvgRGBA(colors[i].r, colors[i].g, colors[i].b, colors[i].a));
+		}
+		CP_Graphics_DrawEllipse(positions[i].x, positions[i].y, diameters[i], diameters[i]);
+		nvgRestore(CORE->nvg);
+		++i;
+	}
+}
+
 CP_API void CP_Graphics_DrawEllipse(float x, float y, float w, float h)
 {
 	CP_CorePtr CORE = GetCPCore();
@@ -185,6 +344,12 @@ CP_API void CP_Graphics_DrawEllipse(float x, float y, float w, float h)
 		break;
 	}
 
+	// Ellipses out of view are skipped, solid color ellipses are batched, anything else goes through a path
+	if (nvgCullRect(CORE->nvg, x - rw, y - rh, w, h, DI->stroke) || nvgQuad(CORE->nvg, NVG_QUAD_ELLIPSE, x, y, rw, rh, DI->fill, DI->stroke))
+	{
+		return;
+	}
+
 	// Ellipse path
 	nvgBeginPath(CORE->nvg);
 	nvgEllipse(CORE->nvg, x, y, rw, rh);
@@ -222,6 +387,14 @@ CP_API void CP_Graphics_DrawTriangle(float x1, float y1, float x2, float y2, flo
 	CP_CorePtr CORE = GetCPCore();
 	CP_DrawInfoPtr DI = GetDrawInfo();
 
+	// Skip triangles out of view
+	float minX = min(x1, min(x2, x3));
+	float minY = min(y1, min(y2, y3));
+	if (nvgCullRect(CORE->nvg, minX, minY, max(x1, max(x2, x3)) - minX, max(y1, max(y2, y3)) - minY, DI->stroke))
+	{
+		return;
+	}
+
 	// Triangle path
 	nvgBeginPath(CORE->nvg);
 	nvgMoveTo(CORE->nvg, x1, y1);
@@ -267,6 +440,14 @@ CP_API void CP_Graphics_DrawQuad(float x1, float y1, float x2, float y2, float x
 	CP_CorePtr CORE = GetCPCore();
 	CP_DrawInfoPtr DI = GetDrawInfo();
 
+	// Skip quads out of view
+	float minX = min(min(x1, x2), min(x3, x4));
+	float minY = min(min(y1, y2), min(y3, y4));
+	if (nvgCullRect(CORE->nvg, minX, minY, max(max(x1, x2), max(x3, x4)) - minX, max(max(y1, y2), max(y3, y4)) - minY, DI->stroke))
+	{
+		return;
+	}
+
 	// Quad path
 	nvgBeginPath(CORE->nvg);
 	nvgMoveTo(CORE->nvg, x1, y1);
@@ -343,3 +524,260 @@ CP_API void CP_Graphics_EndShape(void)
 		nvgStroke(CORE->nvg);
 	}
 }
+
+// Appends the points as one sub-path, returns FALSE when there is nothing to draw or it is out of view
+static CP_BOOL CP_Graphics_AddPolyline(const CP_Vector* points, int count, int stroke)
+{
+	CP_CorePtr CORE = GetCPCore();
+	float minX = points[0].x, minY = points[0].y, maxX = points[0].x, maxY = points[0].y;
+
+	for (int i = 1; i < count; ++i)
+	{
+		minX = min(minX, points[i].x);
+		minY = min(minY, points[i].y);
+		maxX = max(maxX, points[i].x);
+		maxY = max(maxY, points[i].y);
+	}
+	if (nvgCullRect(CORE->nvg, minX, minY, maxX - minX, maxY - minY, stroke))
+	{
+		return FALSE;
+	}
+
+	nvgBeginPath(CORE->nvg);
+	nvgPolyline(CORE->nvg, &points[0].x, count);
+	return TRUE;
+}
+
+CP_API void CP_Graphics_DrawPolyline(const CP_Vector* points, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !points || count < 2 || !DI->stroke)
+		return;
+
+	// Polyline stroke, the line is left open
+	if (CP_Graphics_AddPolyline(points, count, TRUE))
+	{
+		nvgStroke(CORE->nvg);
+	}
+}
+
+CP_API void CP_Graphics_DrawPolygon(const CP_Vector* points, int count)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+
+	if (!CORE || !CORE->nvg || !DI || !points || count < 2 || (!DI->fill && !DI->stroke))
+		return;
+
+	// Same as a shape made with BeginShape, AddVertex and EndShape except the outline is always closed
+	if (!CP_Graphics_AddPolyline(points, count, DI->stroke))
+	{
+		return;
+	}
+	nvgClosePath(CORE->nvg);
+
+	// Polygon fill
+	if (DI->fill)
+	{
+		nvgFill(CORE->nvg);
+	}
+
+	// Polygon stroke
+	if (DI->stroke)
+	{
+		nvgStroke(CORE->nvg);
+	}
+}
+
+CP_API void CP_Graphics_SetDeferredTessellation(CP_BOOL enabled)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!CORE || !CORE->nvg)
+		return;
+
+	int threads = 0;
+	if (enabled)
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		threads = (int)systemInfo.dwNumberOfProcessors;
+	}
+
+	// paths drawn so far are flushed before switching
+	nvgDeferTessellation(CORE->nvg, threads);
+}
+
+CP_API void CP_Graphics_SetRetainedMode(CP_BOOL enabled)
+{
+	CP_SetRetainedInternal(enabled);
+}
+
+CP_API void CP_Graphics_MarkDirty(float x, float y, float w, float h)
+{
+	CP_MarkDirtyInternal(x, y, w, h);
+}
+
+CP_API void CP_Shape_Begin(void)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!CORE || !CORE->nvg || shapeRecording)
+	{
+		return;
+	}
+
+	// record in local space, the transform is applied when the shape is drawn
+	nvgSave(CORE->nvg);
+	nvgResetTransform(CORE->nvg);
+	nvgBeginPath(CORE->nvg);
+	shapeRecording = TRUE;
+	shapeFirstVertex = TRUE;
+}
+
+CP_API void CP_Shape_AddVertex(float x, float y)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!shapeRecording)
+	{
+		return;
+	}
+
+	if (shapeFirstVertex)
+	{
+		nvgMoveTo(CORE->nvg, x, y);
+		shapeFirstVertex = FALSE;
+	}
+	else
+	{
+		nvgLineTo(CORE->nvg, x, y);
+	}
+}
+
+CP_API void CP_Shape_AddRect(float x, float y, float w, float h, float cornerRadius)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+	if (!shapeRecording)
+	{
+		return;
+	}
+
+	if (DI->rect_mode == CP_POSITION_CENTER)
+	{
+		x -= w * 0.5f;
+		y -= h * 0.5f;
+	}
+
+	if (cornerRadius >= 0.1f)
+	{
+		nvgRoundedRect(CORE->nvg, x, y, w, h, cornerRadius);
+	}
+	else
+	{
+		nvgRect(CORE->nvg, x, y, w, h);
+	}
+
+	// the next vertex starts a new outline
+	shapeFirstVertex = TRUE;
+}
+
+CP_API void CP_Shape_AddEllipse(float x, float y, float w, float h)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+	if (!shapeRecording)
+	{
+		return;
+	}
+
+	if (DI->ellipse_mode == CP_POSITION_CORNER)
+	{
+		x += w * 0.5f;
+		y += h * 0.5f;
+	}
+	nvgEllipse(CORE->nvg, x, y, w * 0.5f, h * 0.5f);
+
+	// the next vertex starts a new outline
+	shapeFirstVertex = TRUE;
+}
+
+CP_API CP_Shape CP_Shape_End(CP_BOOL close)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!shapeRecording)
+	{
+		return NULL;
+	}
+
+	if (close)
+	{
+		nvgClosePath(CORE->nvg);
+	}
+
+	CP_Shape shape = (CP_Shape)malloc(sizeof(CP_Shape_Struct));
+	if (shape)
+	{
+		shape->shape = nvgCreateShape(CORE->nvg);
+		if (!shape->shape)
+		{
+			free(shape);
+			shape = NULL;
+		}
+	}
+
+	nvgBeginPath(CORE->nvg);
+	nvgRestore(CORE->nvg);
+	shapeRecording = FALSE;
+	return shape;
+}
+
+CP_API void CP_Shape_Draw(CP_Shape shape, float x, float y)
+{
+	CP_Shape_DrawAdvanced(shape, x, y, 0, 1.0f);
+}
+
+CP_API void CP_Shape_DrawAdvanced(CP_Shape shape, float x, float y, float degrees, float scale)
+{
+	CP_CorePtr CORE = GetCPCore();
+	CP_DrawInfoPtr DI = GetDrawInfo();
+	if (!shape || !CORE || !CORE->nvg || !DI)
+	{
+		return;
+	}
+
+	// only the transform changes between draws, the cached geometry is reused
+	nvgSave(CORE->nvg);
+	nvgTranslate(CORE->nvg, x, y);
+	if (degrees != 0)
+	{
+		nvgRotate(CORE->nvg, CP_Math_Radians(degrees));
+	}
+	if (scale != 1.0f)
+	{
+		nvgScale(CORE->nvg, scale, scale);
+	}
+
+	if (DI->fill)
+	{
+		nvgFillShape(CORE->nvg, shape->shape);
+	}
+	if (DI->stroke)
+	{
+		nvgStrokeShape(CORE->nvg, shape->shape);
+	}
+
+	nvgRestore(CORE->nvg);
+}
+
+CP_API void CP_Shape_Free(CP_Shape* shape)
+{
+	if (!shape || !*shape)
+	{
+		return;
+	}
+
+	nvgDeleteShape((*shape)->shape);
+	free(*shape);
+	*shape = NULL;
+}
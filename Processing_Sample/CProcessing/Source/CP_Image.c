@@ -24,31 +24,36 @@
 
 VECT_GENERATE_TYPE(CP_Image)
 
-static vect_CP_Image* image_vector = NULL;
 static vect_CP_Image* free_image_queue = NULL; // free image in the same frame can result in the image not being drawn
 
 //------------------------------------------------------------------------------
 // Internal Functions:
 //------------------------------------------------------------------------------
 
-static CP_Image CP_CheckIfImageIsLoaded(const char* filepath)
+static void CP_Image_Release(void* asset)
 {
-	for (unsigned i = 0; i < image_vector->size; ++i)
+	CP_Image const image = (CP_Image)asset;
+
+	if (image->atlas_page >= 0)
 	{
-		CP_Image const image = vect_at_CP_Image(image_vector, i);
-		if (image && !strcmp(filepath, image->filepath))
-		{
-			return image;
-		}
+		CP_Atlas_Remove(image);
 	}
-
-	return NULL;
+	else
+	{
+		nvgDeleteImage(GetCPCore()->nvg, image->handle); // free nanoVG's data
+	}
+	free(image);
 }
 
-static void CP_AddImageHandle(CP_Image img)
+static CP_Image CP_AddImageHandle(CP_Image img)
 {
-	// push a new image
-	vect_push_CP_Image(image_vector, img);
+	// add the image to the asset registry, loads of the same file will share it
+	if (!CP_Asset_Register(CP_ASSET_IMAGE, img->filepath, img))
+	{
+		CP_Image_Release(img);
+		return NULL;
+	}
+	return img;
 }
 
 void CP_Image_Clear_Vect(vect_CP_Image* vector)
@@ -60,10 +65,7 @@ void CP_Image_Clear_Vect(vect_CP_Image* vector)
 	while (vector->size)
 	{
 		// start at the end
-		CP_Image const image = vect_at_CP_Image(vector, vector->size - 1);
-
-		nvgDeleteImage(CORE->nvg, image->handle); // free nanoVG's data
-		free(image);
+		CP_Image_Release(vect_at_CP_Image(vector, vector->size - 1));
 
 		vect_pop_CP_Image(vector);
 	}
@@ -71,10 +73,6 @@ void CP_Image_Clear_Vect(vect_CP_Image* vector)
 
 void CP_Image_Init(void)
 {
-	if (image_vector == NULL)
-	{
-		image_vector = vect_init_CP_Image(CP_INITIAL_IMAGE_COUNT);
-	}
 	if (free_image_queue == NULL)
 	{
 		free_image_queue = vect_init_CP_Image(CP_INITIAL_IMAGE_COUNT);
@@ -92,11 +90,12 @@ void CP_Image_Shutdown(void)
 	if (!CORE || !CORE->nvg) return;
 
 	// free all images
-	CP_Image_Clear_Vect(image_vector);
+	CP_Asset_ReleaseAll(CP_ASSET_IMAGE, CP_Image_Release);
 	CP_Image_Clear_Vect(free_image_queue);
+	CP_Atlas_Shutdown();
 
-	vect_free_CP_Image(image_vector);
 	vect_free_CP_Image(free_image_queue);
+	free_image_queue = NULL;
 }
 
 static void CP_Image_DrawInternal(CP_Image img, float x, float y, float w, float h, float s0, float t0, float s1, float t1, int alpha, float degrees)
@@ -128,32 +127,62 @@ static void CP_Image_DrawInternal(CP_Image img, float x, float y, float w, float
 
 	const float a = CP_Math_ClampInt(alpha, 0, 255) / 255.0f;
 
-	// translate and scale image pattern for subimages
-	NVGpaint image = { 0 };
-	if (s0 != s1 && t0 != t1)
+	// rotation
+	nvgSave(CORE->nvg);
+	nvgTranslate(CORE->nvg, x + (w / 2.0f), y + (h / 2.0f));
+	nvgRotate(CORE->nvg, CP_Math_Radians(degrees));
+	nvgTranslate(CORE->nvg, -(x + (w / 2.0f)), -(y + (h / 2.0f)));
+
+	// Skip images out of view before building any geometry
+	if (nvgCullRect(CORE->nvg, x, y, w, h, FALSE))
+	{
+		nvgRestore(CORE->nvg);
+		return;
+	}
+
+	if (img->atlas_page >= 0)
 	{
-		const float posRatioX = (w / (s1 - s0));
-		const float posRatioY = (h / (t1 - t0));
-		const float scaleRatioX = (img->w / w) * posRatioX;
-		const float scaleRatioY = (img->h / h) * posRatioY;
+		// atlas images are drawn as textured rects, so consecutive draws from the same page batch into one draw call
+		if (s0 == s1 || t0 == t1)
+		{
+			s0 = 0;
+			t0 = 0;
+			s1 = (float)img->w;
+			t1 = (float)img->h;
+		}
+
+		// never sample the neighbors on the page
+		const float scale = 1.0f / CP_ATLAS_PAGE_SIZE;
+		s0 = (img->atlas_x + CP_Math_ClampFloat(s0, 0, (float)img->w)) * scale;
+		s1 = (img->atlas_x + CP_Math_ClampFloat(s1, 0, (float)img->w)) * scale;
+		t0 = (img->atlas_y + CP_Math_ClampFloat(t0, 0, (float)img->h)) * scale;
+		t1 = (img->atlas_y + CP_Math_ClampFloat(t1, 0, (float)img->h)) * scale;
 
-		image = nvgImagePattern(CORE->nvg, x - s0 * posRatioX, y - t0 * posRatioY, w * scaleRatioX, h * scaleRatioY, 0, img->handle, a);
+		nvgImageRect(CORE->nvg, CP_Atlas_GetPageHandle(img), x, y, w, h, s0, t0, s1, t1, a);
 	}
 	else
 	{
-		image = nvgImagePattern(CORE->nvg, x, y, w, h, 0, img->handle, a);
-	}
+		// translate and scale image pattern for subimages
+		NVGpaint image = { 0 };
+		if (s0 != s1 && t0 != t1)
+		{
+			const float posRatioX = (w / (s1 - s0));
+			const float posRatioY = (h / (t1 - t0));
+			const float scaleRatioX = (img->w / w) * posRatioX;
+			const float scaleRatioY = (img->h / h) * posRatioY;
 
-	// rotation
-	nvgSave(CORE->nvg);
-	nvgTranslate(CORE->nvg, x + (w / 2.0f), y + (h / 2.0f));
-	nvgRotate(CORE->nvg, CP_Math_Radians(degrees));
-	nvgTranslate(CORE->nvg, -(x + (w / 2.0f)), -(y + (h / 2.0f)));
+			image = nvgImagePattern(CORE->nvg, x - s0 * posRatioX, y - t0 * posRatioY, w * scaleRatioX, h * scaleRatioY, 0, img->handle, a);
+		}
+		else
+		{
+			image = nvgImagePattern(CORE->nvg, x, y, w, h, 0, img->handle, a);
+		}
 
-	nvgBeginPath(CORE->nvg);
-	nvgRect(CORE->nvg, x, y, w, h);
-	nvgFillPaint(CORE->nvg, image);
-	nvgFill(CORE->nvg);
+		nvgBeginPath(CORE->nvg);
+		nvgRect(CORE->nvg, x, y, w, h);
+		nvgFillPaint(CORE->nvg, image);
+		nvgFill(CORE->nvg);
+	}
 
 	nvgRestore(CORE->nvg);
 }
@@ -177,7 +206,7 @@ CP_API CP_Image CP_Image_Load(const char* filepath)
 	}
 
 	// Check if the image is already loaded
-	img = CP_CheckIfImageIsLoaded(filepath);
+	img = (CP_Image)CP_Asset_Acquire(CP_ASSET_IMAGE, filepath);
 	if (img)
 	{
 		return img;
@@ -208,10 +237,49 @@ CP_API CP_Image CP_Image_Load(const char* filepath)
 	nvgImageSize(CORE->nvg, img->handle, &img->w, &img->h);
 
 	img->load_error = FALSE;
+	img->atlas_page = -1;
+	img->render_target = FALSE;
 
-	CP_AddImageHandle(img);
+	return CP_AddImageHandle(img);
+}
 
-	return img;
+// Creates an image from pixels that were decoded from the file off the main thread
+CP_Image CP_Image_CreateFromDecodedInternal(const char* filepath, int w, int h, unsigned char* pixels)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!filepath || !pixels || !CORE || !CORE->nvg)
+	{
+		return NULL;
+	}
+
+	// the same file may have finished loading in the meantime
+	CP_Image img = (CP_Image)CP_Asset_Acquire(CP_ASSET_IMAGE, filepath);
+	if (img)
+	{
+		return img;
+	}
+
+	img = (CP_Image)malloc(sizeof(CP_Image_Struct));
+	if (!img)
+	{
+		return NULL;
+	}
+
+	strcpy_s(img->filepath, MAX_PATH, filepath);
+	img->handle = nvgCreateImageRGBA(CORE->nvg, w, h, 0, pixels);
+	if (img->handle == 0)
+	{
+		free(img);
+		return NULL;
+	}
+
+	img->w = w;
+	img->h = h;
+	img->load_error = FALSE;
+	img->atlas_page = -1;
+	img->render_target = FALSE;
+
+	return CP_AddImageHandle(img);
 }
 
 CP_API void CP_Image_Free(CP_Image* img)
@@ -221,20 +289,12 @@ CP_API void CP_Image_Free(CP_Image* img)
 		return;
 	}
 
-	// find the image in the list
-	for (unsigned i = 0; i < image_vector->size; ++i)
+	// drop this reference, once nobody holds the image place it on the free queue
+	if (CP_Asset_Release(CP_ASSET_IMAGE, (*img)->filepath, *img))
 	{
-		if (vect_at_CP_Image(image_vector, i) == *img)
-		{
-			// remove the image from the list and place on the free queue
-			vect_rem_CP_Image(image_vector, i);
-			vect_push_CP_Image(free_image_queue, *img);
-			*img = NULL;
-			return;
-		}
+		vect_push_CP_Image(free_image_queue, *img);
 	}
-
-	// TODO: handle error - we reached the end of the list without finding the image
+	*img = NULL;
 }
 
 CP_API int CP_Image_GetWidth(CP_Image img)
@@ -297,8 +357,8 @@ CP_API CP_Image CP_Image_CreateFromData(int w, int h, unsigned char* pixelDataIn
 		return NULL;
 	}
 
-	char buffer[MAX_PATH] = { 0 };
-	strcpy_s(img->filepath, MAX_PATH, buffer);
+	// images made from data have no file, name them after their address so they are never shared
+	sprintf_s(img->filepath, MAX_PATH, "<data %p>", (void*)img);
 
 	// load the image
 	img->handle = nvgCreateImageRGBA(CORE->nvg, w, h, 0, pixelDataInput);
@@ -314,51 +374,33 @@ CP_API CP_Image CP_Image_CreateFromData(int w, int h, unsigned char* pixelDataIn
 	img->h = h;
 
 	img->load_error = FALSE;
+	img->atlas_page = -1;
+	img->render_target = FALSE;
 
-	CP_AddImageHandle(img);
-
-	return img;
+	return CP_AddImageHandle(img);
 }
 
 CP_API CP_Image CP_Image_Screenshot(int x, int y, int w, int h)
 {
 	unsigned char* buffer = (unsigned char*)malloc(4 * w * h);
-	unsigned char* rowTemp = (unsigned char*)malloc(4 * w);
-	if (!buffer || !rowTemp)
+	if (!buffer)
 	{
 		return NULL;
 	}
 	CP_CorePtr CORE = GetCPCore();
 
-	// glReadPixles uses x,y as the lower left, so lets convert that
-	// to the top right for the sake of consistency
-	y = (CORE->window_height - h) - y;
-
 	// flush nanovg so image can be captured
-	nvgEndFrame(CORE->nvg);
+	CP_FlushFrameInternal();
 
-	glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+	// reads with x,y as the top left, for both the GL and software renderers
+	CP_ReadCanvasPixels(x, y, w, h, buffer);
 
 	nvgBeginFrame(CORE->nvg, CORE->window_width, CORE->window_height, CORE->pixel_ratio);
 
-	int rowWidth = w * 4;
-	int size = h;
-	
-	for (int rowIndex = 0; rowIndex < (size / 2); ++rowIndex) // loop through each row
-	{
-		unsigned char* rowFront = &buffer[rowIndex * rowWidth];
-		unsigned char* rowBack = &buffer[(h - rowIndex - 1) * rowWidth];
-
-		memcpy(rowTemp, rowFront, rowWidth);
-		memcpy(rowFront, rowBack, rowWidth);
-		memcpy(rowBack, rowTemp, rowWidth);
-	}
-
 	// createImage returns NULL if it fails, we want to pass that along as well
 	CP_Image newImg = CP_Image_CreateFromData(w, h, buffer);
 
 	free(buffer);
-	free(rowTemp);
 
 	return newImg;
 }
@@ -373,6 +415,12 @@ CP_API void CP_Image_GetPixelData(CP_Image img, CP_Color* pixelDataOutput)
         return;
     }
 
+    if (img->atlas_page >= 0)
+    {
+        CP_Atlas_ReadPixels(img, (unsigned char*)pixelDataOutput);
+        return;
+    }
+
     nvgGetImagePixelsRGBA(CORE->nvg, img->handle, (unsigned char*)pixelDataOutput);
 }
 
@@ -386,5 +434,69 @@ CP_API void CP_Image_UpdatePixelData(CP_Image img, CP_Color* pixelDataInput)
 		return;
 	}
 
+	if (img->atlas_page >= 0)
+	{
+		CP_Atlas_WritePixels(img, (unsigned char*)pixelDataInput);
+		return;
+	}
+
 	nvgUpdateImage(CORE->nvg, img->handle, (unsigned char*)pixelDataInput);
 }
+
+CP_API CP_BOOL CP_Image_SetAtlased(CP_Image img, CP_BOOL atlased)
+{
+	CP_CorePtr CORE = GetCPCore();
+	if (!img || !CORE || !CORE->nvg)
+	{
+		return FALSE;
+	}
+	if ((img->atlas_page >= 0) == (atlased != FALSE))
+	{
+		return TRUE;
+	}
+	if (img->render_target)
+	{
+		// canvases keep drawing into their own texture
+		return FALSE;
+	}
+
+	unsigned char* pixels = (unsigned char*)malloc((size_t)img->w * img->h * 4);
+	if (!pixels)
+	{
+		return FALSE;
+	}
+
+	CP_BOOL result = FALSE;
+	if (atlased)
+	{
+		// move the pixels onto a shared page and drop the image's own texture
+		nvgGetImagePixelsRGBA(CORE->nvg, img->handle, pixels);
+		const int handle = img->handle;
+		if (CP_Atlas_Add(img, pixels))
+		{
+			nvgDeleteImage(CORE->nvg, handle);
+			img->handle = 0;
+			result = TRUE;
+		}
+	}
+	else
+	{
+		// give the image its own texture again
+		CP_Atlas_ReadPixels(img, pixels);
+		const int handle = nvgCreateImageRGBA(CORE->nvg, img->w, img->h, 0, pixels);
+		if (handle != 0)
+		{
+			CP_Atlas_Remove(img);
+			img->handle = handle;
+			result = TRUE;
+		}
+	}
+
+	free(pixels);
+	return result;
+}
+
+CP_API CP_BOOL CP_Image_IsAtlased(CP_Image img)
+{
+	return img && img->atlas_page >= 0;
+}
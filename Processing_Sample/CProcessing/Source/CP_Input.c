@@ -174,7 +174,11 @@ void CP_Input_Init(void)
 	}
 
     CP_CorePtr CORE = GetCPCore();
-    glfwSetInputMode(CORE->window, GLFW_STICKY_MOUSE_BUTTONS, 1);
+    if (CORE->window)
+    {
+        // headless runs have no window and no mouse
+        glfwSetInputMode(CORE->window, GLFW_STICKY_MOUSE_BUTTONS, 1);
+    }
 
 	CP_Input_MouseUpdate();
 	CP_Input_MouseUpdate(); // intentionally called twice to setup curr and prev mouse values
@@ -223,9 +227,12 @@ void CP_Input_MouseUpdate(void)
 	_pmouseX = _mouseX;
 	_pmouseY = _mouseY;
 
-	glfwGetCursorPos(GetCPCore()->window, &mx, &my);
-	_mouseX = (float)mx;
-	_mouseY = (float)my;
+	if (GetCPCore()->window)
+	{
+		glfwGetCursorPos(GetCPCore()->window, &mx, &my);
+		_mouseX = (float)mx;
+		_mouseY = (float)my;
+	}
 
     CP_Input_WorldMouseUpdate();
 
@@ -0,0 +1,450 @@
+//---------------------------------------------------------
+// file:	CP_Load.c
+// author:	CProcessing contributors
+// brief:	Background loading of images, fonts and sounds on a pool of worker threads
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+#include "Internal_Load.h"
+#include "tinycthread.h"
+#include "stb_image.h"
+
+//------------------------------------------------------------------------------
+// Defines and Internal Variables:
+//------------------------------------------------------------------------------
+
+// Workers only read and decode files, anything touching NanoVG, the GPU or the asset
+// registry is done by CP_Load_Update on the main thread when the job is finished.
+typedef struct CP_LoadHandle_Struct
+{
+	CP_ASSET_TYPE type;
+	char filepath[MAX_PATH];
+	CP_LOAD_STATUS status;		// only changed on the main thread
+	CP_LoadCallback callback;
+	void* userData;
+	bool released;				// the handle was freed before the load finished
+
+	// written by the worker
+	bool failed;
+	unsigned char* data;		// RGBA pixels for images, file contents for fonts
+	int w;
+	int h;
+	int size;
+	Wav* wav;
+
+	// the loaded asset, owned by the caller once complete
+	void* asset;
+
+	struct CP_LoadHandle_Struct* next;
+} CP_LoadHandle_Struct;
+
+typedef struct CP_LoadQueue
+{
+	CP_LoadHandle head;
+	CP_LoadHandle tail;
+} CP_LoadQueue;
+
+static thrd_t _workers[CP_LOAD_MAX_WORKERS];
+static int _workerCount = 0;
+static mtx_t _lock;
+static cnd_t _wake;
+static bool _quit = false;
+static bool _started = false;
+
+static CP_LoadQueue _pending = { 0 };	// waiting for a worker
+static CP_LoadQueue _finished = { 0 };	// waiting for the main thread
+static unsigned _inFlight = 0;			// requested and not yet finished on the main thread
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+static void CP_Load_Push(CP_LoadQueue* queue, CP_LoadHandle job)
+{
+	job->next = NULL;
+	if (queue->tail)
+	{
+		queue->tail->next = job;
+	}
+	else
+	{
+		queue->head = job;
+	}
+	queue->tail = job;
+}
+
+static CP_LoadHandle CP_Load_Pop(CP_LoadQueue* queue)
+{
+	CP_LoadHandle job = queue->head;
+	if (job)
+	{
+		queue->head = job->next;
+		if (!queue->head)
+		{
+			queue->tail = NULL;
+		}
+		job->next = NULL;
+	}
+	return job;
+}
+
+static unsigned char* CP_Load_ReadFile(const char* filepath, int* size)
+{
+	FILE* file = NULL;
+	unsigned char* data = NULL;
+	long length = 0;
+
+	if (fopen_s(&file, filepath, "rb") != 0 || !file)
+	{
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	data = length > 0 ? (unsigned char*)malloc(length) : NULL;
+	if (data && fread(data, 1, length, file) != (size_t)length)
+	{
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+
+	*size = (int)length;
+	return data;
+}
+
+static void CP_Load_Decode(CP_LoadHandle job)
+{
+	switch (job->type)
+	{
+	case CP_ASSET_IMAGE:
+	{
+		int channels = 0;
+		job->data = stbi_load(job->filepath, &job->w, &job->h, &channels, 4);
+		job->failed = job->data == NULL;
+		break;
+	}
+	case CP_ASSET_FONT:
+		job->data = CP_Load_ReadFile(job->filepath, &job->size);
+		job->failed = job->data == NULL;
+		break;
+	case CP_ASSET_SOUND:
+		job->wav = Wav_create();
+		job->failed = !job->wav || Wav_load(job->wav, job->filepath) != 0;
+		break;
+	default:
+		job->failed = true;
+		break;
+	}
+}
+
+static void CP_Load_DiscardDecoded(CP_LoadHandle job)
+{
+	if (job->type == CP_ASSET_IMAGE && job->data)
+	{
+		stbi_image_free(job->data);
+	}
+	else if (job->data)
+	{
+		free(job->data);
+	}
+	if (job->wav)
+	{
+		Wav_destroy(job->wav);
+	}
+	job->data = NULL;
+	job->wav = NULL;
+}
+
+static int CP_Load_Worker(void* arg)
+{
+	UNREFERENCED_PARAMETER(arg);
+
+	mtx_lock(&_lock);
+	for (;;)
+	{
+		while (!_quit && !_pending.head)
+		{
+			cnd_wait(&_wake, &_lock);
+		}
+		if (_quit)
+		{
+			break;
+		}
+
+		CP_LoadHandle job = CP_Load_Pop(&_pending);
+		mtx_unlock(&_lock);
+
+		CP_Load_Decode(job);
+
+		mtx_lock(&_lock);
+		CP_Load_Push(&_finished, job);
+	}
+	mtx_unlock(&_lock);
+	return 0;
+}
+
+static bool CP_Load_StartWorkers(void)
+{
+	if (_started)
+	{
+		return _workerCount > 0;
+	}
+	_started = true;
+
+	if (mtx_init(&_lock, mtx_plain) != thrd_success || cnd_init(&_wake) != thrd_success)
+	{
+		return false;
+	}
+
+	// keep a core for the main thread
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	int count = CP_Math_ClampInt((int)systemInfo.dwNumberOfProcessors - 1, 1, CP_LOAD_MAX_WORKERS);
+
+	// match the settings nvgCreateImage uses before any worker decodes
+	stbi_set_unpremultiply_on_load(1);
+	stbi_convert_iphone_png_to_rgb(1);
+
+	_quit = false;
+	for (int i = 0; i < count; ++i)
+	{
+		if (thrd_create(&_workers[_workerCount], CP_Load_Worker, NULL) == thrd_success)
+		{
+			++_workerCount;
+		}
+	}
+	return _workerCount > 0;
+}
+
+static CP_LoadHandle CP_Load_Request(CP_ASSET_TYPE type, const char* filepath, CP_LoadCallback callback, void* userData)
+{
+	if (!filepath || !CP_Load_StartWorkers())
+	{
+		return NULL;
+	}
+
+	CP_LoadHandle job = (CP_LoadHandle)calloc(1, sizeof(CP_LoadHandle_Struct));
+	if (!job)
+	{
+		return NULL;
+	}
+
+	job->type = type;
+	strcpy_s(job->filepath, MAX_PATH, filepath);
+	job->status = CP_LOAD_PENDING;
+	job->callback = callback;
+	job->userData = userData;
+
+	// already loaded assets skip the workers, the callback still comes from CP_Load_Update
+	job->asset = CP_Asset_Acquire(type, filepath);
+
+	mtx_lock(&_lock);
+	if (job->asset)
+	{
+		CP_Load_Push(&_finished, job);
+	}
+	else
+	{
+		CP_Load_Push(&_pending, job);
+		cnd_signal(&_wake);
+	}
+	mtx_unlock(&_lock);
+
+	++_inFlight;
+	return job;
+}
+
+// Creates the asset from the decoded data, this is the only part that needs the main thread
+static void* CP_Load_Finish(CP_LoadHandle job)
+{
+	void* asset = NULL;
+
+	switch (job->type)
+	{
+	case CP_ASSET_IMAGE:
+		asset = CP_Image_CreateFromDecodedInternal(job->filepath, job->w, job->h, job->data);
+		break;
+	case CP_ASSET_FONT:
+		// the font takes ownership of the file data
+		asset = CP_Font_LoadFromMemoryInternal(job->filepath, job->data, job->size);
+		job->data = NULL;
+		break;
+	case CP_ASSET_SOUND:
+		// the sound takes ownership of the decoded wave
+		asset = CP_Sound_AddLoadedInternal(job->filepath, job->wav);
+		job->wav = NULL;
+		break;
+	default:
+		break;
+	}
+
+	CP_Load_DiscardDecoded(job);
+	return asset;
+}
+
+static void CP_Load_ReleaseAsset(CP_LoadHandle job)
+{
+	switch (job->type)
+	{
+	case CP_ASSET_IMAGE: CP_Image_Free((CP_Image*)&job->asset); break;
+	case CP_ASSET_FONT: CP_Font_Free((CP_Font*)&job->asset); break;
+	case CP_ASSET_SOUND: CP_Sound_Free((CP_Sound*)&job->asset); break;
+	default: break;
+	}
+}
+
+void CP_Load_Update(void)
+{
+	CP_LoadQueue finished = { 0 };
+
+	if (_inFlight == 0)
+	{
+		return;
+	}
+
+	// take everything that is done in one go so workers aren't blocked while uploading
+	mtx_lock(&_lock);
+	finished = _finished;
+	_finished.head = NULL;
+	_finished.tail = NULL;
+	mtx_unlock(&_lock);
+
+	CP_LoadHandle job = NULL;
+	while ((job = CP_Load_Pop(&finished)) != NULL)
+	{
+		--_inFlight;
+
+		if (!job->asset && !job->failed)
+		{
+			job->asset = CP_Load_Finish(job);
+		}
+		CP_Load_DiscardDecoded(job);
+		job->status = job->asset ? CP_LOAD_COMPLETE : CP_LOAD_FAILED;
+
+		if (job->released)
+		{
+			// nobody is waiting for this one anymore
+			CP_Load_ReleaseAsset(job);
+			free(job);
+			continue;
+		}
+
+		if (job->callback)
+		{
+			job->callback(job, job->userData);
+		}
+	}
+}
+
+void CP_Load_Shutdown(void)
+{
+	if (!_started)
+	{
+		return;
+	}
+
+	mtx_lock(&_lock);
+	_quit = true;
+	cnd_broadcast(&_wake);
+	mtx_unlock(&_lock);
+
+	for (int i = 0; i < _workerCount; ++i)
+	{
+		thrd_join(_workers[i], NULL);
+	}
+	_workerCount = 0;
+
+	// loads still in flight are dropped, their assets were never created
+	CP_LoadHandle job = NULL;
+	while ((job = CP_Load_Pop(&_pending)) != NULL || (job = CP_Load_Pop(&_finished)) != NULL)
+	{
+		CP_Load_DiscardDecoded(job);
+		job->asset = NULL;
+		job->status = CP_LOAD_FAILED;
+		if (job->released)
+		{
+			free(job);
+		}
+	}
+	_inFlight = 0;
+
+	cnd_destroy(&_wake);
+	mtx_destroy(&_lock);
+	_started = false;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+// Starts loading an image on a background thread. The image is ready once the status of
+// the returned handle is CP_LOAD_COMPLETE, the callback (which may be NULL) is called on
+// the main thread at the start of the frame the load finishes in.
+CP_API CP_LoadHandle CP_Image_LoadAsync(const char* filepath, CP_LoadCallback callback, void* userData)
+{
+	return CP_Load_Request(CP_ASSET_IMAGE, filepath, callback, userData);
+}
+
+CP_API CP_LoadHandle CP_Font_LoadAsync(const char* filepath, CP_LoadCallback callback, void* userData)
+{
+	return CP_Load_Request(CP_ASSET_FONT, filepath, callback, userData);
+}
+
+CP_API CP_LoadHandle CP_Sound_LoadAsync(const char* filepath, CP_LoadCallback callback, void* userData)
+{
+	return CP_Load_Request(CP_ASSET_SOUND, filepath, callback, userData);
+}
+
+CP_API CP_LOAD_STATUS CP_Load_GetStatus(CP_LoadHandle handle)
+{
+	return handle ? handle->status : CP_LOAD_FAILED;
+}
+
+CP_API CP_Image CP_Load_GetImage(CP_LoadHandle handle)
+{
+	return handle && handle->type == CP_ASSET_IMAGE ? (CP_Image)handle->asset : NULL;
+}
+
+CP_API CP_Font CP_Load_GetFont(CP_LoadHandle handle)
+{
+	return handle && handle->type == CP_ASSET_FONT ? (CP_Font)handle->asset : NULL;
+}
+
+CP_API CP_Sound CP_Load_GetSound(CP_LoadHandle handle)
+{
+	return handle && handle->type == CP_ASSET_SOUND ? (CP_Sound)handle->asset : NULL;
+}
+
+// Returns the number of loads that haven't finished yet.
+CP_API unsigned CP_Load_GetPendingCount(void)
+{
+	return _inFlight;
+}
+
+// Frees the handle, a loaded asset stays loaded and is freed with its own Free function.
+// If the load hasn't finished it is cancelled and the asset is released once it completes.
+CP_API void CP_Load_Free(CP_LoadHandle* handle)
+{
+	if (handle == NULL || *handle == NULL)
+	{
+		return;
+	}
+
+	if ((*handle)->status == CP_LOAD_PENDING)
+	{
+		(*handle)->released = true;
+	}
+	else
+	{
+		free(*handle);
+	}
+	*handle = NULL;
+}
@@ -0,0 +1,342 @@
+//---------------------------------------------------------
+// file:	CP_Pacer.c
+// author:	CProcessing contributors
+// brief:	Frame pacing with absolute deadlines, pacing statistics and a fixed timestep accumulator
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L	// clock_nanosleep and clock_gettime
+#endif
+
+#include <math.h>
+#include <string.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <timeapi.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#define CP_PACER_PAUSE() YieldProcessor()
+#else
+#include <errno.h>
+#include <time.h>
+#define CP_PACER_PAUSE() ((void)0)
+#endif
+
+//------------------------------------------------------------------------------
+// Private Variables:
+//------------------------------------------------------------------------------
+
+// Deadlines are absolute so the time lost to each wake up doesn't add up over frames
+static double _deadline = 0.0;
+static double _lastWake = 0.0;
+
+// The last part of the wait is spent spinning, sized from how late the OS wakes us up
+static double _oversleep = 0.001;
+
+#ifdef _WIN32
+static HANDLE _timer = NULL;
+static LARGE_INTEGER _frequency;
+static bool _timerPeriodSet = false;
+#endif
+
+// Pacing statistics, in seconds
+static double _wakeError[CP_PACER_FRAMES];
+static double _period[CP_PACER_FRAMES];
+static double _spin[CP_PACER_FRAMES];
+static unsigned _statIndex = 0;
+static unsigned _statCount = 0;
+static unsigned _missedFrames = 0;
+
+// Fixed timestep accumulator
+static double _fixedStep = 0.0;
+static double _accumulator = 0.0;
+static unsigned _fixedStepCount = 0;
+static bool _engineStepping = false;	// a fixed update function owns the accumulator
+
+// Takes one fixed step out of the accumulator if enough time has accumulated
+static bool CP_Pacer_TakeStep(void)
+{
+	if (_fixedStep <= 0.0 || _accumulator < _fixedStep)
+	{
+		return false;
+	}
+	_accumulator -= _fixedStep;
+	++_fixedStepCount;
+	return true;
+}
+
+static void CP_Pacer_SleepUntil(double wakeTime)
+{
+	double remaining = wakeTime - CP_Pacer_Now();
+	if (remaining <= 0.0)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	if (_timer)
+	{
+		// negative due times are relative, in 100 nanosecond units
+		LARGE_INTEGER due;
+		due.QuadPart = -(LONGLONG)(remaining * 1.0e7);
+		if (SetWaitableTimer(_timer, &due, 0, NULL, NULL, FALSE))
+		{
+			WaitForSingleObject(_timer, INFINITE);
+			return;
+		}
+	}
+	Sleep((DWORD)(remaining * 1000.0));
+#else
+	struct timespec ts;
+	ts.tv_sec = (time_t)wakeTime;
+	ts.tv_nsec = (long)((wakeTime - (double)ts.tv_sec) * 1.0e9);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+	{
+		// interrupted by a signal, the deadline is absolute so just wait again
+	}
+#endif
+}
+
+static void CP_Pacer_Record(double wakeError, double period, double spin)
+{
+	_wakeError[_statIndex] = wakeError;
+	_period[_statIndex] = period;
+	_spin[_statIndex] = spin;
+	_statIndex = (_statIndex + 1) % CP_PACER_FRAMES;
+	if (_statCount < CP_PACER_FRAMES)
+	{
+		++_statCount;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+// Returns the average distance between the frame deadlines and the actual wake up
+// times over the recent frames, in milliseconds.
+CP_API float CP_System_GetPacingErrorMillis(void)
+{
+	double total = 0.0;
+	for (unsigned i = 0; i < _statCount; ++i)
+	{
+		total += fabs(_wakeError[i]);
+	}
+	return _statCount ? (float)(total / _statCount * 1000.0) : 0.0f;
+}
+
+// Returns the standard deviation of the frame duration over the recent frames, in milliseconds.
+CP_API float CP_System_GetPacingJitterMillis(void)
+{
+	double mean = 0.0, variance = 0.0;
+	if (_statCount == 0)
+	{
+		return 0.0f;
+	}
+	for (unsigned i = 0; i < _statCount; ++i)
+	{
+		mean += _period[i];
+	}
+	mean /= _statCount;
+	for (unsigned i = 0; i < _statCount; ++i)
+	{
+		variance += (_period[i] - mean) * (_period[i] - mean);
+	}
+	return (float)(sqrt(variance / _statCount) * 1000.0);
+}
+
+// Returns the average time per frame spent busy waiting for the deadline, in milliseconds.
+CP_API float CP_System_GetPacingSpinMillis(void)
+{
+	double total = 0.0;
+	for (unsigned i = 0; i < _statCount; ++i)
+	{
+		total += _spin[i];
+	}
+	return _statCount ? (float)(total / _statCount * 1000.0) : 0.0f;
+}
+
+// Returns how many frames finished after their deadline since the program started.
+CP_API unsigned CP_System_GetMissedFrameCount(void)
+{
+	return _missedFrames;
+}
+
+// Sets the length of a fixed timestep in seconds, zero turns the accumulator off.
+// Each frame adds its dt to the accumulator and CP_System_FixedStep takes it out one
+// step at a time, so a simulation advances by the same amount no matter the frame rate.
+// Does nothing while CP_Engine_SetFixedUpdateFunction has a function registered.
+CP_API void CP_System_SetFixedTimestep(float seconds)
+{
+	if (_engineStepping)
+	{
+		return;
+	}
+	_fixedStep = seconds > 0.0f ? seconds : 0.0;
+	_accumulator = 0.0;
+}
+
+CP_API float CP_System_GetFixedTimestep(void)
+{
+	return (float)_fixedStep;
+}
+
+// Returns TRUE and consumes one fixed step while enough time has accumulated.
+// Call it in a loop: while (CP_System_FixedStep()) { Simulate(CP_System_GetFixedTimestep()); }
+// Always returns FALSE while a fixed update function is registered, the engine takes the steps.
+CP_API CP_BOOL CP_System_FixedStep(void)
+{
+	if (_engineStepping)
+	{
+		return FALSE;
+	}
+	return CP_Pacer_TakeStep() ? TRUE : FALSE;
+}
+
+// Returns how many fixed steps have been taken since the program started.
+CP_API unsigned CP_System_GetFixedStepCount(void)
+{
+	return _fixedStepCount;
+}
+
+// Returns how far (0 - 1) the current time is between the last fixed step and the next,
+// used to interpolate the drawn state between the previous and current simulation state.
+CP_API float CP_System_GetFixedStepAlpha(void)
+{
+	if (_fixedStep <= 0.0)
+	{
+		return 1.0f;
+	}
+	return CP_Math_ClampFloat((float)(_accumulator / _fixedStep), 0.0f, 1.0f);
+}
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+void CP_Pacer_Init(void)
+{
+#ifdef _WIN32
+	QueryPerformanceFrequency(&_frequency);
+
+	// high resolution timers wake up within a fraction of a millisecond (Windows 10 1803+),
+	// older systems get a normal timer with the scheduler period lowered to 1 ms
+	_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!_timer)
+	{
+		_timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+		_timerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+	}
+#endif
+
+	_lastWake = CP_Pacer_Now();
+	_deadline = _lastWake;
+	_statIndex = 0;
+	_statCount = 0;
+	_missedFrames = 0;
+	_accumulator = 0.0;
+}
+
+void CP_Pacer_Shutdown(void)
+{
+#ifdef _WIN32
+	if (_timer)
+	{
+		CloseHandle(_timer);
+		_timer = NULL;
+	}
+	if (_timerPeriodSet)
+	{
+		timeEndPeriod(1);
+		_timerPeriodSet = false;
+	}
+#endif
+}
+
+// Monotonic time in seconds
+double CP_Pacer_Now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)_frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+#endif
+}
+
+// Waits for the end of the current frame and returns the time since the previous frame ended.
+double CP_Pacer_Wait(double frameTime)
+{
+	double now = CP_Pacer_Now();
+	double spinStart = 0.0, wake = 0.0, period = 0.0;
+
+	_deadline += frameTime;
+	if (now > _deadline)
+	{
+		// the frame ran long, start the next one from now instead of rushing to catch up
+		++_missedFrames;
+		_deadline = now;
+	}
+
+	// sleep to just short of the deadline, then spin the rest of the way
+	if (_deadline - now > _oversleep)
+	{
+		double sleepUntil = _deadline - _oversleep;
+		CP_Pacer_SleepUntil(sleepUntil);
+
+		// track how late the OS wakes up, rising quickly and falling slowly
+		double late = CP_Pacer_Now() - sleepUntil;
+		_oversleep = late > _oversleep ? late : _oversleep * 0.95 + late * 0.05;
+		if (_oversleep < 0.0002) _oversleep = 0.0002;
+		if (_oversleep > 0.004) _oversleep = 0.004;
+	}
+
+	spinStart = CP_Pacer_Now();
+	wake = spinStart;
+	while (wake < _deadline)
+	{
+		CP_PACER_PAUSE();
+		wake = CP_Pacer_Now();
+	}
+
+	period = wake - _lastWake;
+	CP_Pacer_Record(wake - _deadline, period, wake - spinStart);
+	_lastWake = wake;
+	return period;
+}
+
+// Gives the accumulator to the engine's fixed update loop, zero hands it back to the sketch
+void CP_Pacer_SetEngineTimestep(double seconds)
+{
+	_engineStepping = seconds > 0.0;
+	_fixedStep = _engineStepping ? seconds : 0.0;
+	_accumulator = 0.0;
+}
+
+// Takes one of the engine's fixed steps, the counterpart of CP_System_FixedStep
+bool CP_Pacer_EngineStep(void)
+{
+	return _engineStepping && CP_Pacer_TakeStep();
+}
+
+void CP_Pacer_Accumulate(double dt)
+{
+	if (_fixedStep <= 0.0)
+	{
+		return;
+	}
+	_accumulator += dt;
+	if (_accumulator > CP_PACER_MAX_ACCUMULATED)
+	{
+		_accumulator = CP_PACER_MAX_ACCUMULATED;
+	}
+}
@@ -0,0 +1,128 @@
+//---------------------------------------------------------
+// file:	CP_Profiler.c
+// author:	CProcessing contributors
+// brief:	Frame phase timing, keeps the last frames to report percentiles
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cprocessing.h"
+#include "Internal_System.h"
+
+//------------------------------------------------------------------------------
+// Private Variables:
+//------------------------------------------------------------------------------
+
+// Ring buffer of phase times in milliseconds, one entry per frame
+static float _samples[CP_FRAME_PHASE_MAX][CP_PROFILER_FRAMES];
+static unsigned _sampleIndex = 0;
+static unsigned _sampleCount = 0;
+
+// Timing of the frame in progress, a phase can be entered more than once per frame
+static double _phaseTotal[CP_FRAME_PHASE_MAX];
+static double _phaseStart[CP_FRAME_PHASE_MAX];
+static double _frameStart = 0;
+
+static int CP_Profiler_CompareFloat(const void* a, const void* b)
+{
+	float fa = *(const float*)a;
+	float fb = *(const float*)b;
+	return (fa > fb) - (fa < fb);
+}
+
+static CP_BOOL CP_Profiler_IsValidPhase(CP_FRAME_PHASE phase)
+{
+	return phase >= 0 && phase < CP_FRAME_PHASE_MAX;
+}
+
+//------------------------------------------------------------------------------
+// Library Functions:
+//------------------------------------------------------------------------------
+
+// Returns how long the phase took in the last completed frame, in milliseconds.
+CP_API float CP_System_GetPhaseMillis(CP_FRAME_PHASE phase)
+{
+	if (!CP_Profiler_IsValidPhase(phase) || _sampleCount == 0)
+	{
+		return 0.0f;
+	}
+	return _samples[phase][(_sampleIndex + CP_PROFILER_FRAMES - 1) % CP_PROFILER_FRAMES];
+}
+
+// Returns the given percentile (0 - 100) of the phase time over the recorded frames,
+// in milliseconds. For example 50 is the median and 99 is the time only 1% of frames exceed.
+CP_API float CP_System_GetPhasePercentileMillis(CP_FRAME_PHASE phase, float percentile)
+{
+	float sorted[CP_PROFILER_FRAMES];
+	int rank = 0;
+
+	if (!CP_Profiler_IsValidPhase(phase) || _sampleCount == 0)
+	{
+		return 0.0f;
+	}
+
+	memcpy(sorted, _samples[phase], sizeof(float) * _sampleCount);
+	qsort(sorted, _sampleCount, sizeof(float), CP_Profiler_CompareFloat);
+
+	// nearest rank, so the result is always a time that was actually measured
+	rank = (int)ceilf(CP_Math_ClampFloat(percentile, 0.0f, 100.0f) / 100.0f * _sampleCount) - 1;
+	return sorted[CP_Math_ClampInt(rank, 0, (int)_sampleCount - 1)];
+}
+
+// Returns the number of frames the percentiles are computed from.
+CP_API unsigned CP_System_GetProfiledFrameCount(void)
+{
+	return _sampleCount;
+}
+
+// Forgets all recorded frames, useful to start measuring after loading is done.
+CP_API void CP_System_ResetProfiler(void)
+{
+	_sampleIndex = 0;
+	_sampleCount = 0;
+}
+
+//------------------------------------------------------------------------------
+// Internal Functions:
+//------------------------------------------------------------------------------
+
+void CP_Profiler_Init(void)
+{
+	memset(_samples, 0, sizeof(_samples));
+	CP_System_ResetProfiler();
+}
+
+void CP_Profiler_FrameStart(void)
+{
+	memset(_phaseTotal, 0, sizeof(_phaseTotal));
+	_frameStart = CP_GetTimeInternal();
+}
+
+void CP_Profiler_FrameEnd(void)
+{
+	_phaseTotal[CP_FRAME_PHASE_FRAME] = CP_GetTimeInternal() - _frameStart;
+
+	for (int phase = 0; phase < CP_FRAME_PHASE_MAX; ++phase)
+	{
+		_samples[phase][_sampleIndex] = (float)(_phaseTotal[phase] * 1000.0);
+	}
+
+	_sampleIndex = (_sampleIndex + 1) % CP_PROFILER_FRAMES;
+	if (_sampleCount < CP_PROFILER_FRAMES)
+	{
+		++_sampleCount;
+	}
+}
+
+void CP_Profiler_PhaseStart(CP_FRAME_PHASE phase)
+{
+	_phaseStart[phase] = CP_GetTimeInternal();
+}
+
+void CP_Profiler_PhaseEnd(CP_FRAME_PHASE phase)
+{
+	_phaseTotal[phase] += CP_GetTimeInternal() - _phaseStart[phase];
+}
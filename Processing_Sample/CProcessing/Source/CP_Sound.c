@@ -10,24 +10,19 @@
 // Include Files:
 //------------------------------------------------------------------------------
 
+#include <stdlib.h>
 #include "cprocessing.h"
 #include "Internal_Sound.h"
-#include "vect.h"
+#include "Internal_Asset.h"
 
 //------------------------------------------------------------------------------
 // Defines and Internal Variables:
 //------------------------------------------------------------------------------
 
-#define CP_INITIAL_SOUND_CAPACITY   12
-
-VECT_GENERATE_TYPE(CP_Sound)
-
 static Soloud* _soloud_system = NULL;
 
 static int result = 0;
 
-static vect_CP_Sound* sound_vector = NULL;
-
 static CP_VoiceGroup_Struct voice_groups[CP_SOUND_GROUP_MAX] = { 0 };
 
 //------------------------------------------------------------------------------
@@ -55,25 +50,18 @@ static BOOL CP_IsValidSoundGroup(CP_SOUND_GROUP group)
 	return group >= 0 && group < CP_SOUND_GROUP_MAX;
 }
 
-static CP_Sound CP_CheckIfSoundIsLoaded(const char* filepath)
+static void CP_Sound_Release(void* asset)
 {
-	for (unsigned i = 0; i < sound_vector->size; ++i)
-	{
-		CP_Sound snd = vect_at_CP_Sound(sound_vector, i);
-		if (snd && !strcmp(filepath, snd->filepath))
-		{
-			return snd;
-		}
-	}
+	CP_Sound sound = (CP_Sound)asset;
 
-	return NULL;
+	// Release the sound from SoLoud
+	SL_Sound_Release(sound);
+	// Free the struct's memory
+	free(sound);
 }
 
 void CP_Sound_Init(void)
 {
-	// Allocate the initial vector size for loaded sounds
-	sound_vector = vect_init_CP_Sound(CP_INITIAL_SOUND_CAPACITY);
-
 	// Create the SoLoud system
 	_soloud_system = Soloud_create();
 	result = Soloud_init(_soloud_system);
@@ -107,17 +95,7 @@ void CP_Sound_Shutdown(void)
 		CP_Sound_StopAll();
 
 		// Free sounds 
-		for (unsigned i = 0; i < sound_vector->size; ++i)
-		{
-			CP_Sound sound = vect_at_CP_Sound(sound_vector, i);
-			// Release the sound from SoLoud
-			SL_Sound_Release(sound);
-			// Free the struct's memory
-			free(sound);
-		}
-
-		// Free lists
-		vect_free(sound_vector);
+		CP_Asset_ReleaseAll(CP_ASSET_SOUND, CP_Sound_Release);
 
 		// Release system
 		Soloud_deinit(_soloud_system);
@@ -134,7 +112,7 @@ CP_Sound CP_Sound_LoadInternal(const char* filepath, CP_BOOL streamFromDisc)
 	CP_Sound sound = NULL;
 
 	// Check if the sound is already loaded
-	sound = CP_CheckIfSoundIsLoaded(filepath);
+	sound = (CP_Sound)CP_Asset_Acquire(CP_ASSET_SOUND, filepath);
 	if (sound)
 	{
 		return sound;
@@ -175,8 +153,48 @@ CP_Sound CP_Sound_LoadInternal(const char* filepath, CP_BOOL streamFromDisc)
 	// Set filepath string for cache checking
 	strcpy_s(sound->filepath, MAX_PATH, filepath);
 
-	// Add it to the list
-	vect_push_CP_Sound(sound_vector, sound);
+	// Add it to the registry, loads of the same file will share it
+	if (!CP_Asset_Register(CP_ASSET_SOUND, sound->filepath, sound))
+	{
+		CP_Sound_Release(sound);
+		return NULL;
+	}
+
+	return sound;
+}
+
+// Adds a sound that was decoded off the main thread, the sound takes ownership of the wave
+CP_Sound CP_Sound_AddLoadedInternal(const char* filepath, Wav* wav)
+{
+	if (!filepath || !wav)
+	{
+		return NULL;
+	}
+
+	// the same file may have finished loading in the meantime
+	CP_Sound sound = (CP_Sound)CP_Asset_Acquire(CP_ASSET_SOUND, filepath);
+	if (sound)
+	{
+		Wav_destroy(wav);
+		return sound;
+	}
+
+	sound = (CP_Sound)malloc(sizeof(CP_Sound_Struct));
+	if (!sound)
+	{
+		Wav_destroy(wav);
+		return NULL;
+	}
+
+	sound->sound = (AudioSource*)wav;
+	sound->type = SL_AUDIOSOURCE_WAV;
+	strcpy_s(sound->filepath, MAX_PATH, filepath);
+
+	if (!CP_Asset_Register(CP_ASSET_SOUND, sound->filepath, sound))
+	{
+		CP_Sound_Release(sound);
+		return NULL;
+	}
 
 	return sound;
 }
@@ -202,24 +220,12 @@ CP_API void CP_Sound_Free(CP_Sound* sound)
 		return;
 	}
 
-	// Find the sound in the list
-	for (unsigned i = 0; i < sound_vector->size; ++i)
+	// Drop this reference and free the sound once nobody holds it
+	if (CP_Asset_Release(CP_ASSET_SOUND, (*sound)->filepath, *sound))
 	{
-		// Check if this pointer is the same as the one we're looking for
-		if (vect_at_CP_Sound(sound_vector, i) == *sound)
-		{
-			// Remove the sound from the list
-			vect_rem_CP_Sound(sound_vector, i);
-			// Release the sound from SoLoud
-			SL_Sound_Release((*sound));
-			// Free the struct's memory
-			free(*sound);
-			*sound = NULL;
-			return;
-		}
+		CP_Sound_Release(*sound);
 	}
-
-	// TODO: handle error - we reached the end of the list without finding the sound
+	*sound = NULL;
 }
 
 CP_API void CP_Sound_Play(CP_Sound sound)
@@ -9,6 +9,9 @@
 #include "cprocessing.h"
 #include "Internal_System.h"
 #include "nanovg_gl.h"
+#include "nanovg_gl_utils.h"
+#define NANOVG_SW_IMPLEMENTATION
+#include "nanovg_sw.h"
 #include "tinycthread.h"
 
 #define GLFW_EXPOSE_NATIVE_WIN32
@@ -18,7 +21,9 @@
 
 // Internal information
 static CP_Core _CORE = { 0 };
+static _Thread_local CP_CorePtr _threadCore = NULL;	// set while a draw list records on this thread
 static bool _isInitialized = false;
+static bool _headlessTerminate = false;	// headless runs have no window to close
 
 CP_BOOL _deferredSizeChange = FALSE;
 int _deferredWidth = 0;
@@ -38,6 +43,8 @@ bool _stateIsChanging = false;
 
 FunctionPtr _preUpdateFunction = NULL;
 FunctionPtr _postUpdateFunction = NULL;
+FunctionPtr _fixedUpdateFunction = NULL;
+bool _inFixedUpdate = false;
 
 //------------------------------------------------------------------------------
 // Private Variables:
@@ -51,6 +58,22 @@ static double _frametime = 1.0 / 60.0;
 // Frames since the start of the program
 static unsigned int _frameCount;
 
+// Pacer time the headless run started at, GLFW and its timer aren't used in headless runs
+static double _headlessTimeStart = 0.0;
+
+// Retained frame mode
+static bool _retainedRequest = false;	// applied at the start of the next frame
+static bool _dirtyAll = false;			// the retained frame has to be redrawn entirely
+static int _dirty[4] = { 0 };			// canvas pixels x0, y0, x1, y1 redrawn this frame, empty when x1 <= x0
+static int _cleared[4] = { 0 };			// part of _dirty ClearBackground cleared so far this frame
+static bool _clearedBackground = false;
+static NVGcolor _clearColor;
+static float _dirtyPercent = 100.0f;
+
+// Renderer counters, a frame is flushed more than once when it draws canvases or takes screenshots
+static NVGframeStats _frameStats;		// the last frame, summed over its flushes
+static NVGframeStats _flushStats;		// the flushes of the current frame so far
+
 void error_callback_glfw(int error, const char* desc)
 {
 	printf("GLFW error %d: %s\n", error, desc);
@@ -58,12 +81,19 @@ void error_callback_glfw(int error, const char* desc)
 
 CP_CorePtr GetCPCore(void)
 {
-	return &_CORE;
+	return _threadCore ? _threadCore : &_CORE;
 }
 
 CP_DrawInfoPtr GetDrawInfo(void)
 {
-	return &_CORE.states[_CORE.nstates - 1];
+	CP_CorePtr CORE = GetCPCore();
+	return &CORE->states[CORE->nstates - 1];
+}
+
+// Redirects GetCPCore on the calling thread, NULL goes back to the canvas
+void SetThreadCPCore(CP_CorePtr core)
+{
+	_threadCore = core;
 }
 
 void SetCPCoreValues(void)
@@ -81,6 +111,10 @@ void SetCPCoreValues(void)
 	_CORE.pixel_ratio	= 1.0f;
 	_CORE.window_posX	= -1;
 	_CORE.window_posY	= -1;
+	_CORE.isHeadless	= FALSE;
+	_CORE.isSoftware	= FALSE;
+	_CORE.isRetained	= FALSE;
+	_CORE.framebuffer	= NULL;
 	_CORE.nstates		= 0;
 	memset(_CORE.states, 0, sizeof(CP_DrawInfo) * CP_MAX_STATES);
 }
@@ -101,50 +135,101 @@ CP_API void CP_Engine_Run(void)
 	}
 
 	// initialize the CProcessing Engine
-	CP_Initialize();
+	if (!CP_Initialize())
+	{
+		return;
+	}
 
 	// main loop
 	while (isRunning)
 	{
-		CP_FrameStart();
-		CP_Update();
-
-		if (_preUpdateFunction) _preUpdateFunction();
+		CP_Engine_Frame();
+	}
 
-		// change states and call associated functions
-		if (_stateIsChanging)
-		{
-			// exit current state
-			if (_currState.exit) _currState.exit();
+	// Exit the current state when the program is terminating
+	if (_currState.exit) _currState.exit();
 
-			// switch state tracking variables
-			_currState.init = _nextState.init;
-			_currState.update = _nextState.update;
-			_currState.exit = _nextState.exit;
+	CP_Shutdown();
+}
 
-			// init
-			if (_currState.init) _currState.init();
+// RunHeadless runs the engine with no window, no display and no GPU. GLFW is not used,
+// every frame is drawn by the software renderer into a canvas of the given size and
+// frames are run back to back with no frame rate limiting. The loop stops after
+// frameCount frames (or when terminated). If pixels is not NULL it receives the final
+// frame as RGBA data, top row first, and must hold at least width * height * 4 bytes.
+// Returns FALSE if the engine is already running or could not be initialized.
+CP_API CP_BOOL CP_Engine_RunHeadless(int width, int height, unsigned int frameCount, unsigned char* pixels)
+{
+	if (_isInitialized || width <= 0 || height <= 0)
+	{
+		// don't allow multiple Run loops
+		return FALSE;
+	}
 
-			_stateIsChanging = false;
-		}
+	// the canvas size is fixed for the whole run
+	_CORE.isHeadless = TRUE;
+	_CORE.isSoftware = TRUE;
+	_CORE.isFullscreen = FALSE;
+	_CORE.canvas_width = width;
+	_CORE.canvas_height = height;
+	_headlessTerminate = false;
 
-		if (_currState.update) _currState.update();
+	// initialize the CProcessing Engine
+	if (!CP_Initialize())
+	{
+		return FALSE;
+	}
 
-		if (_postUpdateFunction) _postUpdateFunction();
+	// main loop
+	while (!_headlessTerminate && _frameCount < frameCount)
+	{
+		CP_Engine_Frame();
+	}
 
-		CP_FrameEnd();
+	if (pixels)
+	{
+		CP_ReadCanvasPixels(0, 0, _CORE.canvas_width, _CORE.canvas_height, pixels);
 	}
 
 	// Exit the current state when the program is terminating
 	if (_currState.exit) _currState.exit();
 
 	CP_Shutdown();
+	return TRUE;
+}
+
+CP_API CP_BOOL CP_Engine_IsHeadless(void)
+{
+	return _CORE.isHeadless;
+}
+
+// SetSoftwareRendering selects the CPU renderer instead of OpenGL. It must be called
+// before the engine is started. The software renderer is also used automatically when
+// no OpenGL 3 context can be created.
+CP_API void CP_Engine_SetSoftwareRendering(CP_BOOL enabled)
+{
+	if (_isInitialized)
+	{
+		// the renderer can't be swapped once the engine is running
+		return;
+	}
+	_CORE.isSoftware = enabled ? TRUE : FALSE;
+}
+
+CP_API CP_BOOL CP_Engine_IsSoftwareRendering(void)
+{
+	return _CORE.isSoftware;
 }
 
 CP_API void CP_Engine_Terminate(void)
 {
 	// mark the program for termination
-	glfwSetWindowShouldClose(GetCPCore()->window, GL_TRUE);
+	if (_CORE.isHeadless)
+	{
+		_headlessTerminate = true;
+		return;
+	}
+	glfwSetWindowShouldClose(_CORE.window, GL_TRUE);
 }
 
 // Set the init, update and exit functions which CProcessing will call.
@@ -181,6 +266,25 @@ CP_API void CP_Engine_SetPostUpdateFunction(FunctionPtr postUpdateFunction)
 	_postUpdateFunction = postUpdateFunction;
 }
 
+// Registers a simulation function that runs at a fixed rate, independent of the frame rate.
+// Each frame it is called as many times as the elapsed time requires (possibly zero) before
+// the state update. Inside it CP_System_GetDt returns exactly 1 / hz, and the update function
+// can use CP_System_GetFixedStepAlpha to interpolate between the last two simulation states.
+// The engine owns the fixed timestep while it is set, CP_System_FixedStep and
+// CP_System_SetFixedTimestep do nothing. Pass NULL (or hz <= 0) to turn it off.
+CP_API void CP_Engine_SetFixedUpdateFunction(FunctionPtr fixedUpdateFunction, float hz)
+{
+	if (fixedUpdateFunction == NULL || hz <= 0.0f)
+	{
+		_fixedUpdateFunction = NULL;
+		CP_Pacer_SetEngineTimestep(0.0);
+		return;
+	}
+
+	_fixedUpdateFunction = fixedUpdateFunction;
+	CP_Pacer_SetEngineTimestep(1.0 / hz);
+}
+
 
 //---------------------------------------------------------
 // SYSTEM:
@@ -195,7 +299,7 @@ CP_API void CP_System_SetWindowPosition(int x, int y)
 {
 	_CORE.window_posX = x;
 	_CORE.window_posY = y;
-	if (_CORE.nvg)
+	if (_CORE.nvg && !_CORE.isHeadless)
 	{
 		glfwSetWindowPos(_CORE.window, x, y);
 	}
@@ -211,14 +315,15 @@ CP_API void CP_System_FullscreenAdvanced(int targetWidth, int targetHeight)
 	CP_SetWindowSizeInternal(targetWidth, targetHeight, true);
 }
 
+// The size of the canvas being drawn, which is the bound CP_Canvas between its Begin and End
 CP_API int CP_System_GetWindowWidth(void)
 {
-	return _CORE.canvas_width;
+	return GetCPCore()->canvas_width;
 }
 
 CP_API int CP_System_GetWindowHeight(void)
 {
-	return _CORE.canvas_height;
+	return GetCPCore()->canvas_height;
 }
 
 CP_API int CP_System_GetDisplayWidth(void)
@@ -233,6 +338,11 @@ CP_API int CP_System_GetDisplayHeight(void)
 
 CP_API int CP_System_GetDisplayRefreshRate(void)
 {
+	if (_CORE.isHeadless)
+	{
+		// there is no display to query
+		return 0;
+	}
 	return glfwGetVideoMode(glfwGetPrimaryMonitor())->refreshRate;
 }
 
@@ -243,17 +353,23 @@ CP_API HWND CP_System_GetWindowHandle(void)
 
 CP_API void CP_System_SetWindowTitle(const char* title)
 {
-	glfwSetWindowTitle(_CORE.window, title);
+	if (_CORE.window)
+	{
+		glfwSetWindowTitle(_CORE.window, title);
+	}
 }
 
 CP_API CP_BOOL CP_System_GetWindowFocus(void)
 {
-	return glfwGetWindowAttrib(_CORE.window, GLFW_FOCUSED);
+	return _CORE.window ? glfwGetWindowAttrib(_CORE.window, GLFW_FOCUSED) : FALSE;
 }
 
 CP_API void CP_System_ShowCursor(CP_BOOL show)
 {
-	glfwSetInputMode(_CORE.window, GLFW_CURSOR, show ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_HIDDEN);
+	if (_CORE.window)
+	{
+		glfwSetInputMode(_CORE.window, GLFW_CURSOR, show ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_HIDDEN);
+	}
 }
 
 CP_API unsigned CP_System_GetFrameCount(void)
@@ -266,6 +382,52 @@ CP_API float CP_System_GetFrameRate(void)
 	return (float)(1.0 / _frametime);
 }
 
+// Bytes of geometry and uniforms the last frame sent to the GPU, 0 with the software renderer
+CP_API unsigned CP_System_GetUploadBytes(void)
+{
+	return (unsigned)_frameStats.uploadBytes;
+}
+
+// Draw calls the last frame recorded in the renderer, before similar calls are merged
+CP_API unsigned CP_System_GetDrawCallCount(void)
+{
+	return (unsigned)_frameStats.callsBeforeMerge;
+}
+
+// Draw calls the last frame sent to the GPU once adjacent calls with the same state are merged
+CP_API unsigned CP_System_GetMergedDrawCallCount(void)
+{
+	return (unsigned)_frameStats.callsAfterMerge;
+}
+
+// Shapes and images the last frame skipped because they were out of view
+CP_API unsigned CP_System_GetCulledCount(void)
+{
+	return (unsigned)_frameStats.culled;
+}
+
+// Percentage of glyph lookups the last frame found already rasterized in the font atlas
+CP_API float CP_System_GetGlyphHitPercent(void)
+{
+	if (_frameStats.glyphLookups == 0)
+	{
+		return 100.0f;
+	}
+	return 100.0f * (float)(_frameStats.glyphLookups - _frameStats.glyphsRasterized) / (float)_frameStats.glyphLookups;
+}
+
+// Glyphs the last frame had to rasterize into the font atlas
+CP_API unsigned CP_System_GetGlyphsRasterized(void)
+{
+	return (unsigned)_frameStats.glyphsRasterized;
+}
+
+// Percentage of the canvas the last frame redrew, always 100 outside of retained mode
+CP_API float CP_System_GetDirtyPercent(void)
+{
+	return _dirtyPercent;
+}
+
 CP_API void CP_System_SetFrameRate(float fps)
 {
 	_frametimeTarget = 1.0 / fps; // seconds per frame
@@ -273,17 +435,18 @@ CP_API void CP_System_SetFrameRate(float fps)
 
 CP_API float CP_System_GetDt(void)
 {
-	return (float)_frametime;
+	// fixed updates always advance by one whole step
+	return _inFixedUpdate ? CP_System_GetFixedTimestep() : (float)_frametime;
 }
 
 CP_API float CP_System_GetMillis(void)
 {
-	return (float)(glfwGetTime() * 1000.0);
+	return (float)(CP_GetTimeInternal() * 1000.0);
 }
 
 CP_API float CP_System_GetSeconds(void)
 {
-	return (float)glfwGetTime();
+	return (float)CP_GetTimeInternal();
 }
 
 
@@ -291,10 +454,79 @@ CP_API float CP_System_GetSeconds(void)
 // INTERNAL Engine and System:
 //		Support functions not exposed to the user
 
-void CP_Initialize(void)
+void CP_Engine_Frame(void)
+{
+	CP_Profiler_FrameStart();
+	CP_FrameStart();
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_EVENTS);
+	CP_Update();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_EVENTS);
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_PRE_UPDATE);
+	if (_preUpdateFunction) _preUpdateFunction();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_PRE_UPDATE);
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_UPDATE);
+
+	// change states and call associated functions
+	if (_stateIsChanging)
+	{
+		// exit current state
+		if (_currState.exit) _currState.exit();
+
+		// switch state tracking variables
+		_currState.init = _nextState.init;
+		_currState.update = _nextState.update;
+		_currState.exit = _nextState.exit;
+
+		// init
+		if (_currState.init) _currState.init();
+
+		_stateIsChanging = false;
+	}
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_UPDATE);
+
+	// step the simulation to catch up with the time that has passed
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_FIXED_UPDATE);
+	if (_fixedUpdateFunction)
+	{
+		_inFixedUpdate = true;
+		while (CP_Pacer_EngineStep())
+		{
+			_fixedUpdateFunction();
+		}
+		_inFixedUpdate = false;
+	}
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_FIXED_UPDATE);
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_UPDATE);
+	if (_currState.update) _currState.update();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_UPDATE);
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_POST_UPDATE);
+	if (_postUpdateFunction) _postUpdateFunction();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_POST_UPDATE);
+
+	CP_FrameEnd();
+	CP_Profiler_FrameEnd();
+}
+
+// Default draw settings of the canvas, draw lists start with them too
+void CP_ApplyDefaultSettingsInternal(void)
+{
+	CP_Settings_Fill(CP_Color_Create(200, 200, 200, 255));
+	CP_Settings_Stroke(CP_Color_Create(0, 0, 0, 255));
+	CP_Settings_StrokeWeight(3.0f);
+	CP_Settings_LineCapMode(CP_LINE_CAP_BUTT);
+	CP_Settings_LineJointMode(CP_LINE_JOINT_BEVEL);
+	CP_Settings_ImageFilterMode(CP_IMAGE_FILTER_LINEAR);
+}
+
+bool CP_Initialize(void)
 {
 	if (_isInitialized == true)
-		return;
+		return true;
 
 	// Initialize CP_Core to default
 	_CORE.nvg = NULL;
@@ -308,9 +540,28 @@ void CP_Initialize(void)
 	GetDrawInfo()->fill = TRUE;
 	GetDrawInfo()->stroke = TRUE;
 
+	if (_CORE.isHeadless)
+	{
+		// headless runs may have no display or GPU, so there is no GLFW and no window,
+		// the software renderer draws a canvas of exactly the requested size
+		_CORE.native_width = _CORE.window_width = _CORE.canvas_width;
+		_CORE.native_height = _CORE.window_height = _CORE.canvas_height;
+		CP_InitializeRenderer();
+		if (_CORE.nvg == NULL)
+		{
+			printf("Could not init nanovg.\n");
+			return false;
+		}
+		CP_InitializeHeadless();
+		CP_InitializeCommon();
+		_headlessTimeStart = CP_Pacer_Now();
+		return true;
+	}
+
 	// Initialize GLFW
 	if (!glfwInit()) {
-		printf("Failed to init GLFW.");
+		printf("Failed to init GLFW.\n");
+		return false;
 	}
 
 	// we need GLFW to query the monitor, then set the correct resolution for the window
@@ -337,33 +588,65 @@ void CP_Initialize(void)
 	glfwWindowHint(GLFW_DOUBLEBUFFER, 0);
 	glfwWindowHint(GLFW_RESIZABLE, 0);
 	glfwWindowHint(GLFW_VISIBLE, 0);
+	if (_CORE.isSoftware)
+	{
+		// the software renderer doesn't need a GL context
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	}
 	_CORE.window = glfwCreateWindow(_CORE.window_width, _CORE.window_height, "CProcessing Application", _CORE.isFullscreen ? glfwGetPrimaryMonitor() : NULL, NULL);
 
+	if (!_CORE.window && !_CORE.isSoftware) {
+		// no usable OpenGL driver, try again without a context and render on the CPU
+		printf("Could not create an OpenGL context, using the software renderer.\n");
+		_CORE.isSoftware = TRUE;
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		_CORE.window = glfwCreateWindow(_CORE.window_width, _CORE.window_height, "CProcessing Application", _CORE.isFullscreen ? glfwGetPrimaryMonitor() : NULL, NULL);
+	}
+
 	if (!_CORE.window) {
+		printf("Could not create the window.\n");
 		glfwTerminate();
+		return false;
 	}
 
 	_CORE.hwnd = glfwGetWin32Window(_CORE.window);
 
-	glfwMakeContextCurrent(_CORE.window);
-	gladLoadGL();
-	_CORE.nvg = nvgCreateGL3(NVG_ANTIALIAS | NVG_STENCIL_STROKES | NVG_DEBUG);
+	CP_InitializeRenderer();
 	if (_CORE.nvg == NULL)
 	{
 		printf("Could not init nanovg.\n");
+		glfwTerminate();
+		_CORE.window = NULL;
+		return false;
 	}
 
-	// Init default draw settings state items here:
-	CP_Settings_Fill(CP_Color_Create(200, 200, 200, 255));
-	CP_Settings_Stroke(CP_Color_Create(0, 0, 0, 255));
-	CP_Settings_StrokeWeight(3.0f);
-	CP_Settings_LineCapMode(CP_LINE_CAP_BUTT);
-	CP_Settings_LineJointMode(CP_LINE_JOINT_BEVEL);
-	CP_Settings_ImageFilterMode(CP_IMAGE_FILTER_LINEAR);
-
-	glfwSwapInterval(0);
+	if (!_CORE.isSoftware)
+	{
+		glfwSwapInterval(0);
+	}
 	glfwSetTime(0);
 
+	CP_InitializeWindow();
+
+	// Set input callback
+	glfwSetInputMode(_CORE.window, GLFW_STICKY_KEYS, 1);
+	glfwSetKeyCallback(_CORE.window, CP_Input_KeyboardCallback);
+	glfwSetMouseButtonCallback(_CORE.window, CP_Input_MouseCallback);
+	glfwSetScrollCallback(_CORE.window, CP_Input_MouseWheelCallback);
+
+	CP_InitializeCommon();
+
+	// once everything is setup, show the window
+	glfwShowWindow(_CORE.window);
+	return true;
+}
+
+// Initialization shared by windowed and headless runs, once the renderer is created
+void CP_InitializeCommon(void)
+{
+	// Init default draw settings state items here:
+	CP_ApplyDefaultSettingsInternal();
+
 	// Initialize random number generators
 	// (Random first so Noise can use the better RNG)
 	CP_Random_Init();
@@ -372,14 +655,71 @@ void CP_Initialize(void)
 	// Initialize mouse position and keyboard state
 	CP_Input_Init();
 
+	// Set the background color
+	CP_Graphics_ClearBackground(CP_Color_Create(150, 150, 150, 255));
+
+	// Init frame rate control
+	CP_FrameRate_Init();
+	CP_Profiler_Init();
+
+	// Text Init
+	CP_Text_Init();
+
+	// Camera Init
+	GetDrawInfo()->camera = CP_Matrix_Identity();
+
+	// Sound Init
+	CP_Sound_Init();
+
+	// Image Init
+	CP_Image_Init();
+
+	_isInitialized = true;
+}
+
+void CP_InitializeRenderer(void)
+{
+	if (!_CORE.isSoftware)
+	{
+		glfwMakeContextCurrent(_CORE.window);
+		if (gladLoadGL())
+		{
+			_CORE.nvg = nvgCreateGL3(NVG_ANTIALIAS | NVG_STENCIL_STROKES | NVG_DEBUG);
+		}
+		if (_CORE.nvg)
+		{
+			return;
+		}
+
+		// the context is too old for the GL3 renderer, fall back to the CPU
+		printf("Could not init the OpenGL renderer, using the software renderer.\n");
+		_CORE.isSoftware = TRUE;
+	}
+
+	// rasterize on every core, the calling thread counts as one of them
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	_CORE.nvg = nvgCreateSW(NVGSW_ANTIALIAS | NVGSW_STENCIL_STROKES, (int)systemInfo.dwNumberOfProcessors);
+}
+
+void CP_InitializeWindow(void)
+{
 	// "Swap" buffers once so it properlly sets the background color
-	glfwSwapBuffers(_CORE.window);
+	if (_CORE.isSoftware)
+	{
+		CP_PresentSoftwareFrame();
+	}
+	else
+	{
+		glfwSwapBuffers(_CORE.window);
+	}
 
 	glfwGetFramebufferSize(_CORE.window, &_CORE.canvas_width, &_CORE.canvas_height);
 	glfwGetWindowSize(_CORE.window, &_CORE.window_width, &_CORE.window_height);
 	// Calculate pixel ratio for hi-dpi devices.
 	_CORE.pixel_ratio = (float)_CORE.canvas_width / (float)_CORE.window_width;
 
+	const GLFWvidmode* structure = NULL;
 	int windowPosX = 0;
 	int windowPosY = 0;
 	if (_CORE.window_posX >= 0 || _CORE.window_posY >= 0)
@@ -397,47 +737,129 @@ void CP_Initialize(void)
 	}
 	glfwSetWindowPos(_CORE.window, windowPosX, windowPosY);
 
+	if (_CORE.isSoftware)
+	{
+		// the software framebuffer is the canvas
+		nvgswResize(_CORE.nvg, _CORE.canvas_width, _CORE.canvas_height);
+		return;
+	}
+
 	// Update and render
 	glViewport(0, 0, _CORE.canvas_width, _CORE.canvas_height);
 
 	// Set readable front buffer for screen shot functionality
 	glReadBuffer(GL_FRONT);
+}
 
-	// Set the background color
-	CP_Graphics_ClearBackground(CP_Color_Create(150, 150, 150, 255));
+void CP_InitializeHeadless(void)
+{
+	// the software framebuffer is already offscreen and is exactly the requested size
+	_CORE.pixel_ratio = 1.0f;
+	nvgswResize(_CORE.nvg, _CORE.canvas_width, _CORE.canvas_height);
+}
 
-	// Set input callback
-	glfwSetInputMode(_CORE.window, GLFW_STICKY_KEYS, 1);
-	glfwSetKeyCallback(_CORE.window, CP_Input_KeyboardCallback);
-	glfwSetMouseButtonCallback(_CORE.window, CP_Input_MouseCallback);
-	glfwSetScrollCallback(_CORE.window, CP_Input_MouseWheelCallback);
+// Reads a w by h block of canvas pixels as RGBA data, x and y are the top left corner
+// and the rows are returned top row first. Pixels outside of the canvas are zero.
+void CP_ReadCanvasPixels(int x, int y, int w, int h, unsigned char* pixels)
+{
+	int rowWidth = w * 4;
 
-	// Init frame rate control
-	CP_FrameRate_Init();
+	if (_CORE.isSoftware)
+	{
+		int width = 0, height = 0;
+		const unsigned char* canvas = nvgswPixels(_CORE.nvg, &width, &height);
+		int x0 = CP_Math_ClampInt(x, 0, width);
+		int x1 = CP_Math_ClampInt(x + w, 0, width);
 
-	// Text Init
-	CP_Text_Init();
+		memset(pixels, 0, (size_t)rowWidth * h);
+		for (int rowIndex = 0; rowIndex < h; ++rowIndex)
+		{
+			int canvasRow = y + rowIndex;
+			if (canvasRow < 0 || canvasRow >= height || x0 >= x1)
+			{
+				continue;
+			}
+			memcpy(&pixels[rowIndex * rowWidth + (x0 - x) * 4], &canvas[(canvasRow * width + x0) * 4], (size_t)(x1 - x0) * 4);
+		}
+		return;
+	}
 
-	// Camera Init
-	GetDrawInfo()->camera = CP_Matrix_Identity();
+	unsigned char* rowTemp = (unsigned char*)malloc(rowWidth);
+	if (!rowTemp)
+	{
+		return;
+	}
 
-	// Sound Init
-	CP_Sound_Init();
+	// glReadPixels uses x,y as the lower left, so convert from the top left
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(x, _CORE.canvas_height - h - y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 
-	// Image Init
-	CP_Image_Init();
+	// glReadPixels returns the bottom row first so flip it
+	for (int rowIndex = 0; rowIndex < (h / 2); ++rowIndex)
+	{
+		unsigned char* rowFront = &pixels[rowIndex * rowWidth];
+		unsigned char* rowBack = &pixels[(h - rowIndex - 1) * rowWidth];
 
-	// once everything is setup, show the window
-	glfwShowWindow(_CORE.window);
+		memcpy(rowTemp, rowFront, rowWidth);
+		memcpy(rowFront, rowBack, rowWidth);
+		memcpy(rowBack, rowTemp, rowWidth);
+	}
 
-	_isInitialized = true;
+	free(rowTemp);
+}
+
+// Copies the software framebuffer to the window, there is no GL swap chain to present it
+void CP_PresentSoftwareFrame(void)
+{
+	static unsigned char* bgra = NULL;
+	static int bgraSize = 0;
+	int width = 0, height = 0;
+	const unsigned char* canvas = nvgswPixels(_CORE.nvg, &width, &height);
+	if (!canvas || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	// GDI expects BGRA so swizzle into a buffer that is kept between frames
+	if (bgraSize < width * height * 4)
+	{
+		unsigned char* resized = (unsigned char*)realloc(bgra, (size_t)width * height * 4);
+		if (!resized)
+		{
+			return;
+		}
+		bgra = resized;
+		bgraSize = width * height * 4;
+	}
+	for (int i = 0; i < width * height * 4; i += 4)
+	{
+		bgra[i + 0] = canvas[i + 2];
+		bgra[i + 1] = canvas[i + 1];
+		bgra[i + 2] = canvas[i + 0];
+		bgra[i + 3] = canvas[i + 3];
+	}
+
+	BITMAPINFO info = { 0 };
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = width;
+	info.bmiHeader.biHeight = -height;	// negative height is a top down bitmap
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	HDC dc = GetDC(_CORE.hwnd);
+	StretchDIBits(dc, 0, 0, width, height, 0, 0, width, height, bgra, &info, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(_CORE.hwnd, dc);
 }
 
 void CP_Update(void)
 {
 	// Update Input
 	CP_Input_Update();
-	glfwPollEvents();
+	if (!_CORE.isHeadless)
+	{
+		glfwPollEvents();
+	}
 
 	// Reset camera transforms
 	nvgResetTransform(_CORE.nvg);
@@ -447,17 +869,35 @@ void CP_Update(void)
 
 	// Image Update
 	CP_Image_Update();
+	CP_Canvas_Update();
+
+	// Finish background loads on the main thread
+	CP_Load_Update();
 }
 
 void CP_Shutdown(void)
 {
+	CP_Load_Shutdown();
 	CP_Text_Shutdown();
 	CP_Sound_Shutdown();
+	CP_Canvas_Shutdown();
 	CP_Image_Shutdown();
+	CP_Asset_Shutdown();
+	CP_Pacer_Shutdown();
 
 	// Clean up glfw and nvg
-	glfwTerminate();
-	nvgDeleteGL3(_CORE.nvg);
+	if (!_CORE.isHeadless)
+	{
+		glfwTerminate();
+	}
+	if (_CORE.isSoftware)
+	{
+		nvgDeleteSW(_CORE.nvg);
+	}
+	else
+	{
+		nvgDeleteGL3(_CORE.nvg);
+	}
 }
 
 void CP_FrameStart(void)
@@ -471,17 +911,79 @@ void CP_FrameStart(void)
 	}
 
 	nvgBeginFrame(_CORE.nvg, _CORE.window_width, _CORE.window_height, _CORE.pixel_ratio);
+
+	if (_retainedRequest != _CORE.isRetained)
+	{
+		CP_SwitchRetained(_retainedRequest);
+	}
+	if (_CORE.isRetained)
+	{
+		// nothing is redrawn until a region is marked dirty
+		_dirty[0] = _dirty[1] = _dirty[2] = _dirty[3] = 0;
+		if (_dirtyAll)
+		{
+			_dirty[2] = _CORE.canvas_width;
+			_dirty[3] = _CORE.canvas_height;
+			_dirtyAll = false;
+		}
+		_cleared[0] = _cleared[1] = _cleared[2] = _cleared[3] = 0;
+		_clearedBackground = false;
+	}
 }
 
 void CP_FrameEnd(void)
 {
-	nvgEndFrame(_CORE.nvg);
-	glfwSwapBuffers(_CORE.window);
-	glFlush();
-	glfwPollEvents();
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_RENDER);
+	CP_FlushFrameInternal();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_RENDER);
+	_frameStats = _flushStats;
+	memset(&_flushStats, 0, sizeof(_flushStats));
+
+	_dirtyPercent = 100.0f;
+	if (_CORE.isRetained && _CORE.canvas_width > 0 && _CORE.canvas_height > 0)
+	{
+		float dirtyArea = (float)CP_Math_ClampInt(_dirty[2] - _dirty[0], 0, _CORE.canvas_width) * (float)CP_Math_ClampInt(_dirty[3] - _dirty[1], 0, _CORE.canvas_height);
+		_dirtyPercent = 100.0f * dirtyArea / ((float)_CORE.canvas_width * (float)_CORE.canvas_height);
+	}
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_SWAP);
+	if (_CORE.isSoftware)
+	{
+		// the frame is already rasterized, there is nothing to flush
+		if (!_CORE.isHeadless)
+		{
+			CP_PresentSoftwareFrame();
+		}
+	}
+	else
+	{
+		if (!_CORE.isHeadless)
+		{
+			glfwSwapBuffers(_CORE.window);
+		}
+		glFlush();
+	}
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_SWAP);
+
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_EVENTS);
+	if (!_CORE.isHeadless)
+	{
+		glfwPollEvents();
+	}
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_EVENTS);
+
+	if (_CORE.isHeadless)
+	{
+		// run as fast as possible but keep a fixed dt so headless runs are repeatable
+		CP_UpdateFrameTime();
+		_frametime = _frametimeTarget;
+		return;
+	}
 
 	// Limit framerate
+	CP_Profiler_PhaseStart(CP_FRAME_PHASE_SLEEP);
 	CP_FrameRate_FrameEnd();
+	CP_Profiler_PhaseEnd(CP_FRAME_PHASE_SLEEP);
 }
 
 void CP_IncFrameCount(void)
@@ -493,62 +995,40 @@ void CP_FrameRate_Init(void)
 {
 	// start the app at frame zero
 	_frameCount = 0;
+
+	// the first frame deadline is counted from here
+	CP_Pacer_Init();
 }
 
 void CP_FrameRate_FrameStart(void)
 {
-	StartingTime = glfwGetTime();
+	StartingTime = CP_GetTimeInternal();
 
 	// Update frame count
 	CP_IncFrameCount();
-}
 
-double averageSleepCycles = 0.002;
-double additionalBuffer = 0.001;	// Sleep() isn't very accurate and we want to make sure we don't over sleep
+	// hand the last frame's time to the fixed timestep accumulator
+	CP_Pacer_Accumulate(_frametime);
+}
 
 void CP_FrameRate_FrameEnd(void)
 {
-	double prevSeconds = 0;
-	double currSeconds = 0;
-
-	do
-	{
-		CP_UpdateFrameTime();
-
-		// compute remaining microseconds in the frame
-		currSeconds = _frametimeTarget - ElapsedSeconds;
-
-		// if our remaining microseconds this frame are greater than the Sleep function's
-		// average margin of error (plus an additional buffer value) then go ahead and Sleep
-		if (currSeconds > averageSleepCycles + additionalBuffer)
-		{
-			prevSeconds = currSeconds;
-
-			// give back cycles to other processes if we don't need them
-			thrd_sleep(&(struct timespec) { .tv_nsec = 1000000 }, NULL);	// sleep 1 millisecond
-
-			// update the time after sleeping
-			CP_UpdateFrameTime();
-
-			// recompute remaining micros
-			currSeconds = _frametimeTarget - ElapsedSeconds;
-
-			// update the average sleep over 16 samples so we maintain awareness of the system's margin of error.
-			averageSleepCycles = ((averageSleepCycles * 15.0) + (prevSeconds - currSeconds)) / 16.0;	// multiply by 15, add new sample, divide by 16
-		}
-
-	} while (ElapsedSeconds < _frametimeTarget);
-
-	// Update time of the last frame
-	_frametime = ElapsedSeconds;
+	// sleep until the frame's deadline, the time between frame ends is the frame time
+	_frametime = CP_Pacer_Wait(_frametimeTarget);
 }
 
 void CP_UpdateFrameTime(void)
 {
-	EndingTime = glfwGetTime();
+	EndingTime = CP_GetTimeInternal();
 	ElapsedSeconds = EndingTime - StartingTime;
 }
 
+// Seconds since the engine started, headless runs read the pacer's clock instead of GLFW
+double CP_GetTimeInternal(void)
+{
+	return _CORE.isHeadless ? CP_Pacer_Now() - _headlessTimeStart : glfwGetTime();
+}
+
 void CP_SetWindowSizeInternal(int new_width, int new_height, bool isFullscreen)
 {
 	_deferredSizeChange = TRUE;
@@ -569,6 +1049,12 @@ void CP_DeferredSetWindowSizeInternal(int new_width, int new_height, bool isFull
 		return;
 	}
 
+	if (_CORE.isHeadless)
+	{
+		// the headless canvas keeps the size it was started with
+		return;
+	}
+
 	if (isFullscreen && new_width == 0 && new_height == 0)
 	{
 		// force full screen values
@@ -609,6 +1095,225 @@ void CP_DeferredSetWindowSizeInternal(int new_width, int new_height, bool isFull
 	glfwGetWindowSize(_CORE.window, &_CORE.window_width, &_CORE.window_height);
 	// Calculate pixel ratio for hi-dpi devices.
 	_CORE.pixel_ratio = (float)_CORE.canvas_width / (float)_CORE.window_width;
+	// the retained frame does not match the new canvas
+	_dirtyAll = true;
+	if (_CORE.isSoftware)
+	{
+		// resize the software framebuffer to the new canvas
+		nvgswResize(_CORE.nvg, _CORE.canvas_width, _CORE.canvas_height);
+		return;
+	}
 	// update openGL frame size
 	glViewport(0, 0, _CORE.canvas_width, _CORE.canvas_height);
 }
+
+void CP_SetRetainedInternal(bool enabled)
+{
+	// switching mid frame would split it between two framebuffers
+	_retainedRequest = enabled;
+}
+
+// Grows the region redrawn this frame, the rectangle is in window coordinates
+void CP_MarkDirtyInternal(float x, float y, float w, float h)
+{
+	if (!_CORE.isRetained || w <= 0.0f || h <= 0.0f)
+	{
+		return;
+	}
+
+	// snap outwards to whole pixels so the scissor has no partially covered edge
+	int x0 = CP_Math_ClampInt((int)floorf(x * _CORE.pixel_ratio), 0, _CORE.canvas_width);
+	int y0 = CP_Math_ClampInt((int)floorf(y * _CORE.pixel_ratio), 0, _CORE.canvas_height);
+	int x1 = CP_Math_ClampInt((int)ceilf((x + w) * _CORE.pixel_ratio), 0, _CORE.canvas_width);
+	int y1 = CP_Math_ClampInt((int)ceilf((y + h) * _CORE.pixel_ratio), 0, _CORE.canvas_height);
+	if (x1 <= x0 || y1 <= y0)
+	{
+		return;
+	}
+
+	if (_dirty[2] <= _dirty[0])
+	{
+		_dirty[0] = x0;
+		_dirty[1] = y0;
+		_dirty[2] = x1;
+		_dirty[3] = y1;
+	}
+	else
+	{
+		_dirty[0] = min(_dirty[0], x0);
+		_dirty[1] = min(_dirty[1], y0);
+		_dirty[2] = max(_dirty[2], x1);
+		_dirty[3] = max(_dirty[3], y1);
+	}
+}
+
+// Clears canvas pixels x0, y0 to x1, y1 of the current render target
+static void CP_ClearCanvasRect(int x0, int y0, int x1, int y1, NVGcolor color)
+{
+	if (x1 <= x0 || y1 <= y0)
+	{
+		return;
+	}
+
+	if (_CORE.isSoftware)
+	{
+		nvgswClearRect(_CORE.nvg, x0, y0, x1 - x0, y1 - y0, color);
+		return;
+	}
+
+	// GL rows start at the bottom
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(x0, _CORE.canvas_height - y1, x1 - x0, y1 - y0);
+	glClearColor(color.r, color.g, color.b, color.a);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
+}
+
+// Limits what the renderer draws to canvas pixels x0, y0 to x1, y1, or nothing when enabled is false.
+// The clip lives in the renderer rather than the nanovg state, so CP_Settings_Save and Restore keep it.
+static void CP_SetRendererClip(bool enabled, int x0, int y0, int x1, int y1)
+{
+	int w = enabled ? max(x1 - x0, 0) : -1;
+	int h = max(y1 - y0, 0);
+
+	if (_CORE.isSoftware)
+	{
+		nvgswClip(_CORE.nvg, x0, y0, w, h);
+		return;
+	}
+	// GL rows start at the bottom
+	nvglClipGL3(_CORE.nvg, x0, _CORE.canvas_height - y0 - h, w, h);
+}
+
+// Clears the dirty region of the retained frame, the rest keeps the previous frame
+void CP_ClearDirtyInternal(NVGcolor color)
+{
+	CP_ClearCanvasRect(_dirty[0], _dirty[1], _dirty[2], _dirty[3], color);
+	memcpy(_cleared, _dirty, sizeof(_cleared));
+	_clearColor = color;
+	_clearedBackground = true;
+}
+
+// Called before what was drawn to the retained frame is rendered. Regions marked after ClearBackground
+// are cleared as well, then drawing is clipped to the whole dirty region.
+void CP_PrepareDirtyFlushInternal(void)
+{
+	// canvases are drawn whole
+	if (!_CORE.isRetained || GetCPCore() != &_CORE)
+	{
+		return;
+	}
+
+	// the dirty region only grows, clear the bands around the part already cleared
+	if (_clearedBackground && memcmp(_cleared, _dirty, sizeof(_dirty)) != 0)
+	{
+		if (_cleared[2] <= _cleared[0] || _cleared[3] <= _cleared[1])
+		{
+			CP_ClearCanvasRect(_dirty[0], _dirty[1], _dirty[2], _dirty[3], _clearColor);
+		}
+		else
+		{
+			CP_ClearCanvasRect(_dirty[0], _dirty[1], _dirty[2], _cleared[1], _clearColor);
+			CP_ClearCanvasRect(_dirty[0], _cleared[3], _dirty[2], _dirty[3], _clearColor);
+			CP_ClearCanvasRect(_dirty[0], _cleared[1], _cleared[0], _cleared[3], _clearColor);
+			CP_ClearCanvasRect(_cleared[2], _cleared[1], _dirty[2], _cleared[3], _clearColor);
+		}
+		memcpy(_cleared, _dirty, sizeof(_cleared));
+	}
+
+	CP_SetRendererClip(true, _dirty[0], _dirty[1], _dirty[2], _dirty[3]);
+}
+
+// The window is single buffered, so like the software canvas and the headless framebuffer it keeps
+// the previous frame and the dirty region is redrawn in place
+// Renders what was drawn so far, the frame goes on after nvgBeginFrame. The renderer counters
+// of every flush add up to the ones of the frame.
+void CP_FlushFrameInternal(void)
+{
+	CP_PrepareDirtyFlushInternal();
+	nvgEndFrame(_CORE.nvg);
+
+	NVGframeStats stats;
+	nvgFrameStats(_CORE.nvg, &stats);
+	_flushStats.drawCalls += stats.drawCalls;
+	_flushStats.fillTriangles += stats.fillTriangles;
+	_flushStats.strokeTriangles += stats.strokeTriangles;
+	_flushStats.textTriangles += stats.textTriangles;
+	_flushStats.uploadBytes += stats.uploadBytes;
+	_flushStats.callsBeforeMerge += stats.callsBeforeMerge;
+	_flushStats.callsAfterMerge += stats.callsAfterMerge;
+	_flushStats.culled += stats.culled;
+	_flushStats.textCacheHits += stats.textCacheHits;
+	_flushStats.textCacheMisses += stats.textCacheMisses;
+	_flushStats.glyphLookups += stats.glyphLookups;
+	_flushStats.glyphsRasterized += stats.glyphsRasterized;
+}
+
+void CP_SwitchRetained(bool enabled)
+{
+	_CORE.isRetained = enabled;
+	_dirtyAll = true;
+	if (!enabled)
+	{
+		// the renderer keeps its clip across frames, drop the dirty region one
+		CP_SetRendererClip(false, 0, 0, 0, 0);
+	}
+}
+
+// Creates an image that can be rendered into and returns its handle, 0 on failure
+int CP_CreateRenderTargetInternal(int w, int h, struct NVGLUframebuffer** framebuffer)
+{
+	*framebuffer = NULL;
+	if (_CORE.isSoftware)
+	{
+		// the software renderer draws into the image pixels, which are top row first like its framebuffer
+		return nvgCreateImageRGBA(_CORE.nvg, w, h, NVG_IMAGE_PREMULTIPLIED, NULL);
+	}
+
+	*framebuffer = nvgluCreateFramebuffer(_CORE.nvg, w, h, 0);
+	if (*framebuffer == NULL)
+	{
+		printf("Could not create a %d x %d canvas framebuffer.\n", w, h);
+		return 0;
+	}
+	return (*framebuffer)->image;
+}
+
+void CP_DeleteRenderTargetInternal(int image, struct NVGLUframebuffer* framebuffer)
+{
+	if (framebuffer)
+	{
+		// also deletes the image
+		nvgluDeleteFramebuffer(framebuffer);
+	}
+	else if (image)
+	{
+		nvgDeleteImage(_CORE.nvg, image);
+	}
+}
+
+// Sends rendering to a render target image, or back to the canvas when image is 0
+void CP_BindRenderTargetInternal(int image, struct NVGLUframebuffer* framebuffer, int w, int h)
+{
+	// the dirty region clip belongs to the retained frame, it is set again before that is rendered
+	if (image != 0 && _CORE.isRetained)
+	{
+		CP_SetRendererClip(false, 0, 0, 0, 0);
+	}
+
+	if (_CORE.isSoftware)
+	{
+		nvgswSetTarget(_CORE.nvg, image);
+		return;
+	}
+
+	if (image == 0)
+	{
+		// the headless frame is drawn offscreen too
+		nvgluBindFramebuffer(_CORE.framebuffer);
+		glViewport(0, 0, _CORE.canvas_width, _CORE.canvas_height);
+		return;
+	}
+	nvgluBindFramebuffer(framebuffer);
+	glViewport(0, 0, w, h);
+}
@@ -10,10 +10,10 @@
 // Include Files:
 //------------------------------------------------------------------------------
 
+#include <stdlib.h>
 #include "cprocessing.h"
 #include "Internal_Text.h"
 #include "Internal_System.h"
-#include "vect.h"
 #include "Internal_Resources.h"
 
 //------------------------------------------------------------------------------
@@ -21,35 +21,20 @@
 //------------------------------------------------------------------------------
 
 #define FONT_LOAD_ERROR -1
-#define CP_INITIAL_FONT_COUNT 16
-
-VECT_GENERATE_TYPE(CP_Font)
 
 static CP_Font  _default_font = NULL;
 
-static vect_CP_Font* font_vector;
-
 //------------------------------------------------------------------------------
 // Internal Functions:
 //------------------------------------------------------------------------------
 
-static CP_Font CP_Font_IsLoaded(const char* filepath)
+static void CP_Font_Release(void* asset)
 {
-	for (unsigned i = 0; i < font_vector->size; ++i)
-	{
-		CP_Font font = vect_at_CP_Font(font_vector, i);
-		if (font && !strcmp(filepath, font->filepath))
-		{
-			return font;
-		}
-	}
-
-	return NULL;
-}
+	CP_Font font = (CP_Font)asset;
 
-static void CP_Font_AddHandle(CP_Font font)
-{
-	vect_push_CP_Font(font_vector, font);
+	// ask NVG to remove and free the font data
+	nvgFreeFont(GetCPCore()->nvg, font->filepath);
+	free(font);
 }
 
 static CP_Font CP_Font_LoadInternal(const char* filepath, bool fromMemory, unsigned char* data, int ndata, int freeData)
@@ -58,9 +43,10 @@ static CP_Font CP_Font_LoadInternal(const char* filepath, bool fromMemory, unsig
 	CP_CorePtr CORE = GetCPCore();
 
 	// Check if the font is already loaded
-	new_font = CP_Font_IsLoaded(filepath);
+	new_font = (CP_Font)CP_Asset_Acquire(CP_ASSET_FONT, filepath);
 	if (new_font)
 	{
+		if (freeData) free(data);
 		return new_font;
 	}
 
@@ -68,6 +54,7 @@ static CP_Font CP_Font_LoadInternal(const char* filepath, bool fromMemory, unsig
 	new_font = (CP_Font)malloc(sizeof(CP_Font_Struct));
 	if (!new_font)
 	{
+		if (freeData) free(data);
 		return NULL;
 	}
 
@@ -79,6 +66,7 @@ static CP_Font CP_Font_LoadInternal(const char* filepath, bool fromMemory, unsig
 	{
 		new_font->load_error = TRUE;
 		free(new_font);
+		if (freeData) free(data);
 		return NULL;
 	}
 
@@ -100,17 +88,24 @@ static CP_Font CP_Font_LoadInternal(const char* filepath, bool fromMemory, unsig
 
 	new_font->load_error = FALSE;
 
-	// Store a pointer to the font
-	CP_Font_AddHandle(new_font);
+	// Store a pointer to the font, loads of the same file will share it
+	if (!CP_Asset_Register(CP_ASSET_FONT, new_font->filepath, new_font))
+	{
+		CP_Font_Release(new_font);
+		return NULL;
+	}
 
 	return new_font;
 }
 
-void CP_Text_Init(void)
+// Creates a font from file contents read off the main thread, the font takes ownership of the data
+CP_Font CP_Font_LoadFromMemoryInternal(const char* filepath, unsigned char* data, int ndata)
 {
-	// initialize our vector
-	font_vector = vect_init_CP_Font(CP_INITIAL_FONT_COUNT);
+	return CP_Font_LoadInternal(filepath, true, data, ndata, 1);
+}
 
+void CP_Text_Init(void)
+{
 	// load the default font from internal binary resource data
 	_default_font = CP_Font_LoadInternal("./Assets/Exo2-Regular.ttf", true, Exo2_Regular_ttf, Exo2_Regular_ttf_size, 0);
 }
@@ -123,17 +118,8 @@ void CP_Text_Shutdown(void)
 		return;
 	}
 
-	for (unsigned i = 0; i < font_vector->size; ++i)
-	{
-		CP_Font font = vect_at_CP_Font(font_vector, i);
-		if (font)
-		{
-			nvgFreeFont(CORE->nvg, font->filepath);
-			free(font);
-		}
-	}
-
-	vect_free_CP_Font(font_vector);
+	CP_Asset_ReleaseAll(CP_ASSET_FONT, CP_Font_Release);
+	_default_font = NULL;
 }
 
 //------------------------------------------------------------------------------
@@ -163,27 +149,18 @@ CP_API void CP_Font_Free(CP_Font* font)
 		return;
 	}
 
-	// find the font in the list
-	for (unsigned i = 0; i < font_vector->size; ++i)
+	if (*font == _default_font)
 	{
-		if (vect_at_CP_Font(font_vector, i) == *font)
-		{
-			if (i == 0)
-			{
-				// don't allow the unloading of the built-in default font Exo2-Regular.ttf
-				return;
-			}
-
-			// remove the font from the list and also ask NVG to remove and free
-			vect_rem_CP_Font(font_vector, i);
-			nvgFreeFont(CORE->nvg, (*font)->filepath);
-			free(*font);
-			*font = NULL;
-			return;
-		}
+		// don't allow the unloading of the built-in default font Exo2-Regular.ttf
+		return;
 	}
 
-	// TODO: handle error - we reached the end of the list without finding the image
+	// drop this reference and free the font once nobody holds it
+	if (CP_Asset_Release(CP_ASSET_FONT, (*font)->filepath, *font))
+	{
+		CP_Font_Release(*font);
+	}
+	*font = NULL;
 }
 
 CP_API void CP_Font_Set(CP_Font font)
@@ -198,6 +175,32 @@ CP_API void CP_Font_Set(CP_Font font)
 	nvgFontFaceId(CORE->nvg, font->handle);
 }
 
+// Rasterizes the characters of charset at the given text size ahead of time, all printable ASCII when charset is NULL
+CP_API int CP_Font_Prewarm(CP_Font font, float size, const char* charset)
+{
+	CP_CorePtr CORE = GetCPCore();
+
+	if (font == NULL || !CORE || !CORE->nvg)
+	{
+		return 0;
+	}
+
+	return nvgFontPrewarm(CORE->nvg, font->handle, size, charset);
+}
+
+// Renders the font from a signed distance field rasterized once, so any size, scale or rotation stays sharp
+CP_API void CP_Font_SetSDF(CP_Font font, CP_BOOL enabled)
+{
+	CP_CorePtr CORE = GetCPCore();
+
+	if (font == NULL || !CORE || !CORE->nvg)
+	{
+		return;
+	}
+
+	nvgFontSDF(CORE->nvg, font->handle, enabled ? 1 : 0);
+}
+
 CP_API void CP_Font_DrawText(const char* text, float x, float y)
 {
 	CP_CorePtr CORE = GetCPCore();
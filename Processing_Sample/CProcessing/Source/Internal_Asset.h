@@ -0,0 +1,43 @@
+//---------------------------------------------------------
+// file:	Internal_Asset.h
+// author:	CProcessing contributors
+// brief:	Header for the shared, reference counted asset registry
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#define CP_ASSET_INITIAL_CAPACITY 64	// must be a power of two
+
+typedef enum CP_ASSET_TYPE
+{
+	CP_ASSET_IMAGE,
+	CP_ASSET_FONT,
+	CP_ASSET_SOUND,
+	CP_ASSET_TYPE_MAX
+} CP_ASSET_TYPE;
+
+typedef void(*CP_AssetReleaseFunction)(void* asset);
+
+// Returns the asset loaded from the path with one more reference, or NULL if it isn't loaded.
+void* CP_Asset_Acquire(CP_ASSET_TYPE type, const char* filepath);
+// Adds a newly loaded asset with a single reference.
+bool CP_Asset_Register(CP_ASSET_TYPE type, const char* filepath, void* asset);
+// Drops a reference, returns true when it was the last one and the asset should be destroyed.
+bool CP_Asset_Release(CP_ASSET_TYPE type, const char* filepath, void* asset);
+// Removes every asset of the type, calling release on each of them.
+void CP_Asset_ReleaseAll(CP_ASSET_TYPE type, CP_AssetReleaseFunction release);
+void CP_Asset_Shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+//---------------------------------------------------------
+// file:	Internal_Atlas.h
+// author:	CProcessing contributors
+// brief:	Header for packing images into shared atlas textures
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#define CP_ATLAS_PAGE_SIZE 2048		// width and height of each atlas texture
+#define CP_ATLAS_MAX_IMAGE_SIZE 512	// larger images keep their own texture
+#define CP_ATLAS_PADDING 1			// border of repeated edge pixels so filtering never samples a neighbor
+
+// Packs the RGBA pixels of the image into an atlas page, returns false if it doesn't fit.
+bool CP_Atlas_Add(CP_Image img, const unsigned char* pixels);
+// Frees the space of the image, a page is reused once all of its images are removed.
+void CP_Atlas_Remove(CP_Image img);
+// Returns the nanoVG handle of the page holding the image.
+int CP_Atlas_GetPageHandle(CP_Image img);
+void CP_Atlas_ReadPixels(CP_Image img, unsigned char* pixels);
+void CP_Atlas_WritePixels(CP_Image img, const unsigned char* pixels);
+void CP_Atlas_Shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
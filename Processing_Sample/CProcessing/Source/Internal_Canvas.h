@@ -0,0 +1,23 @@
+//---------------------------------------------------------
+// file:	Internal_Canvas.h
+// author:	CProcessing contributors
+// brief:	Header for offscreen canvases drawn into like the window
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Releases the canvases freed during the last frame, once nothing can draw them anymore.
+void CP_Canvas_Update(void);
+void CP_Canvas_Shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
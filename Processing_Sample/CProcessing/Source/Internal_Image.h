@@ -37,6 +37,10 @@ typedef struct CP_Image_Struct
     int w;                   // width of the image
     int h;                   // height of the image
     int load_error;          // was there an error loading the image
+    int atlas_page;          // index of the atlas page holding the pixels, -1 when the image has its own texture
+    int atlas_x;             // position of the image on its atlas page
+    int atlas_y;
+    int render_target;       // drawn into by a canvas, its texture stays where it is
 } CP_Image_Struct;
 
 //------------------------------------------------------------------------------
@@ -54,6 +58,7 @@ typedef struct CP_Image_Struct
 void CP_Image_Init(void);
 void CP_Image_Update(void);
 void CP_Image_Shutdown(void);
+CP_Image CP_Image_CreateFromDecodedInternal(const char* filepath, int w, int h, unsigned char* pixels);
 
 #ifdef __cplusplus
 }
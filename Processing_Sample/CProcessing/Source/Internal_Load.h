@@ -0,0 +1,24 @@
+//---------------------------------------------------------
+// file:	Internal_Load.h
+// author:	CProcessing contributors
+// brief:	Header for the internal background asset loader
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CP_LOAD_MAX_WORKERS 4	// decoding is mostly disk bound, more threads rarely help
+
+void CP_Load_Update(void);
+void CP_Load_Shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+//---------------------------------------------------------
+// file:	Internal_Pacer.h
+// author:	CProcessing contributors
+// brief:	Header for the internal frame pacer
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CP_PACER_FRAMES 128			// number of frames kept for the pacing statistics
+#define CP_PACER_MAX_ACCUMULATED 0.25	// fixed steps owed are capped so a long stall can't snowball
+
+void CP_Pacer_Init(void);
+void CP_Pacer_Shutdown(void);
+double CP_Pacer_Now(void);
+double CP_Pacer_Wait(double frameTime);
+void CP_Pacer_Accumulate(double dt);
+void CP_Pacer_SetEngineTimestep(double seconds);
+bool CP_Pacer_EngineStep(void);
+
+#ifdef __cplusplus
+}
+#endif
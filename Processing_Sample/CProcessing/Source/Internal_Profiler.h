@@ -0,0 +1,29 @@
+//---------------------------------------------------------
+// file:	Internal_Profiler.h
+// author:	CProcessing contributors
+// brief:	Header for the internal frame phase profiler
+//
+// INTERNAL USE ONLY, DO NOT DISTRIBUTE
+//
+// Copyright  2026 DigiPen, All rights reserved.
+//---------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cprocessing_common.h"
+
+#define CP_PROFILER_FRAMES 256	// number of frames kept for the percentile queries
+
+void CP_Profiler_Init(void);
+void CP_Profiler_FrameStart(void);
+void CP_Profiler_FrameEnd(void);
+void CP_Profiler_PhaseStart(CP_FRAME_PHASE phase);
+void CP_Profiler_PhaseEnd(CP_FRAME_PHASE phase);
+
+#ifdef __cplusplus
+}
+#endif
@@ -70,6 +70,7 @@ typedef struct CP_VoiceGroup_Struct
 void CP_Sound_Init(void);
 void CP_Sound_Update(void);
 void CP_Sound_Shutdown(void);
+CP_Sound CP_Sound_AddLoadedInternal(const char* filepath, Wav* wav);
 
 #ifdef __cplusplus
 }
@@ -22,13 +22,19 @@ extern "C" {
 #define NANOVG_GL3_IMPLEMENTATION
 #include "nanovg.h"
 
+#include "Internal_Asset.h"
+#include "Internal_Atlas.h"
+#include "Internal_Canvas.h"
 #include "Internal_Color.h"
 #include "Internal_File.h"
 #include "Internal_Image.h"
 #include "Internal_Input.h"
+#include "Internal_Load.h"
 #include "Internal_Math.h"
 #include "Internal_Random.h"
 #include "Internal_Noise.h"
+#include "Internal_Pacer.h"
+#include "Internal_Profiler.h"
 #include "Internal_Sound.h"
 #include "Internal_Text.h"
 
@@ -68,6 +74,10 @@ typedef struct CP_Core
     float pixel_ratio;
     int window_posX;
     int window_posY;
+	bool isHeadless;
+	bool isSoftware;
+	bool isRetained;
+	struct NVGLUframebuffer* framebuffer;
 	CP_DrawInfo states[CP_MAX_STATES];
 	int nstates;
 } CP_Core;
@@ -76,11 +86,30 @@ typedef CP_Core* CP_CorePtr;
 
 CP_CorePtr GetCPCore(void);
 CP_DrawInfoPtr GetDrawInfo(void);
+void SetThreadCPCore(CP_CorePtr core);
+void CP_ApplyDefaultSettingsInternal(void);
 
 void CP_SetWindowSizeInternal(int new_width, int new_height, bool isFullscreen);
 void CP_DeferredSetWindowSizeInternal(int new_width, int new_height, bool isFullscreen);
+void CP_SetRetainedInternal(bool enabled);
+void CP_MarkDirtyInternal(float x, float y, float w, float h);
+void CP_ClearDirtyInternal(NVGcolor color);
+void CP_PrepareDirtyFlushInternal(void);
+void CP_FlushFrameInternal(void);
+void CP_SwitchRetained(bool enabled);
+int CP_CreateRenderTargetInternal(int w, int h, struct NVGLUframebuffer** framebuffer);
+void CP_DeleteRenderTargetInternal(int image, struct NVGLUframebuffer* framebuffer);
+void CP_BindRenderTargetInternal(int image, struct NVGLUframebuffer* framebuffer, int w, int h);
 
-void CP_Initialize(void);
+void CP_Engine_Frame(void);
+
+bool CP_Initialize(void);
+void CP_InitializeCommon(void);
+void CP_InitializeWindow(void);
+void CP_InitializeHeadless(void);
+void CP_InitializeRenderer(void);
+void CP_ReadCanvasPixels(int x, int y, int w, int h, unsigned char* pixels);
+void CP_PresentSoftwareFrame(void);
 void CP_Update(void);
 void CP_Shutdown(void);
 void CP_FrameStart(void);
@@ -90,6 +119,7 @@ void CP_FrameRate_Init(void);
 void CP_FrameRate_FrameStart(void);
 void CP_FrameRate_FrameEnd(void);
 void CP_UpdateFrameTime(void);
+double CP_GetTimeInternal(void);
 void CP_IncFrameCount(void);
 
 #ifdef __cplusplus
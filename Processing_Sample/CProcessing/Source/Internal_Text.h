@@ -53,6 +53,7 @@ typedef struct CP_Font_Struct
 // INTERNAL USE
 void CP_Text_Init(void);
 void CP_Text_Shutdown(void);
+CP_Font CP_Font_LoadFromMemoryInternal(const char* filepath, unsigned char* data, int ndata);
 ////////////////////////////////////////////////////////////////////////////////
 
 #ifdef __cplusplus
@@ -54,11 +54,16 @@ extern "C"
 // ENGINE:
 //		Functions managing code flow
 CP_API void				CP_Engine_Run						(void);
+CP_API CP_BOOL			CP_Engine_RunHeadless				(int width, int height, unsigned int frameCount, unsigned char* pixels);
+CP_API CP_BOOL			CP_Engine_IsHeadless				(void);
+CP_API void				CP_Engine_SetSoftwareRendering		(CP_BOOL enabled);
+CP_API CP_BOOL			CP_Engine_IsSoftwareRendering		(void);
 CP_API void				CP_Engine_Terminate					(void);
 CP_API void				CP_Engine_SetNextGameState			(FunctionPtr init, FunctionPtr update, FunctionPtr exit);
 CP_API void				CP_Engine_SetNextGameStateForced	(FunctionPtr init, FunctionPtr update, FunctionPtr exit);
 CP_API void				CP_Engine_SetPreUpdateFunction		(FunctionPtr preUpdateFunction);
 CP_API void				CP_Engine_SetPostUpdateFunction		(FunctionPtr postUpdateFunction);
+CP_API void				CP_Engine_SetFixedUpdateFunction	(FunctionPtr fixedUpdateFunction, float hz);
 
 
 //---------------------------------------------------------
@@ -83,6 +88,49 @@ CP_API void				CP_System_SetFrameRate				(float fps);
 CP_API float			CP_System_GetDt						(void);
 CP_API float			CP_System_GetMillis					(void);
 CP_API float			CP_System_GetSeconds				(void);
+CP_API float			CP_System_GetPhaseMillis			(CP_FRAME_PHASE phase);
+CP_API float			CP_System_GetPhasePercentileMillis	(CP_FRAME_PHASE phase, float percentile);
+CP_API unsigned			CP_System_GetProfiledFrameCount		(void);
+CP_API void				CP_System_ResetProfiler				(void);
+CP_API unsigned			CP_System_GetUploadBytes			(void);
+CP_API unsigned			CP_System_GetDrawCallCount			(void);
+CP_API unsigned			CP_System_GetMergedDrawCallCount	(void);
+CP_API float			CP_System_GetDirtyPercent			(void);
+CP_API unsigned			CP_System_GetCulledCount			(void);
+CP_API float			CP_System_GetGlyphHitPercent		(void);
+CP_API unsigned			CP_System_GetGlyphsRasterized		(void);
+CP_API float			CP_System_GetPacingErrorMillis		(void);
+CP_API float			CP_System_GetPacingJitterMillis		(void);
+CP_API float			CP_System_GetPacingSpinMillis		(void);
+CP_API unsigned			CP_System_GetMissedFrameCount		(void);
+CP_API void				CP_System_SetFixedTimestep			(float seconds);
+CP_API float			CP_System_GetFixedTimestep			(void);
+CP_API CP_BOOL			CP_System_FixedStep					(void);
+CP_API float			CP_System_GetFixedStepAlpha			(void);
+CP_API unsigned			CP_System_GetFixedStepCount			(void);
+
+
+//---------------------------------------------------------
+// ASSET:
+//		Loaded images, fonts and sounds are shared by path and reference counted
+CP_API unsigned			CP_Asset_GetCount					(void);
+CP_API unsigned			CP_Asset_GetHitCount				(void);
+CP_API unsigned			CP_Asset_GetMissCount				(void);
+CP_API void				CP_Asset_ResetStats					(void);
+
+
+//---------------------------------------------------------
+// LOAD:
+//		Load images, fonts and sounds in the background, poll the handle or get a callback when done
+CP_API CP_LoadHandle	CP_Image_LoadAsync					(const char* filepath, CP_LoadCallback callback, void* userData);
+CP_API CP_LoadHandle	CP_Font_LoadAsync					(const char* filepath, CP_LoadCallback callback, void* userData);
+CP_API CP_LoadHandle	CP_Sound_LoadAsync					(const char* filepath, CP_LoadCallback callback, void* userData);
+CP_API CP_LOAD_STATUS	CP_Load_GetStatus					(CP_LoadHandle handle);
+CP_API CP_Image			CP_Load_GetImage					(CP_LoadHandle handle);
+CP_API CP_Font			CP_Load_GetFont						(CP_LoadHandle handle);
+CP_API CP_Sound			CP_Load_GetSound					(CP_LoadHandle handle);
+CP_API unsigned			CP_Load_GetPendingCount				(void);
+CP_API void				CP_Load_Free						(CP_LoadHandle* handle);
 
 
 //---------------------------------------------------------
@@ -131,13 +179,23 @@ CP_API CP_ColorHSL		CP_ColorHSL_FromColor				(CP_Color rgb);
 //---------------------------------------------------------
 // GRAPHICS:
 //		Functions related to drawing primitive shapes
+//		DrawPoints, DrawLines, DrawRects and DrawCircles draw count shapes from arrays in one call (lines take a start and end point each)
+//		colors is optional, when given it holds one color per shape replacing the fill (stroke for points and lines)
+//		DrawPolyline strokes an open line through count points, DrawPolygon fills and strokes them as a closed shape, much faster than AddVertex for large point arrays
+//		SetDeferredTessellation records paths and tessellates them on all cores at the end of the frame (off by default)
+//		SetRetainedMode keeps the previous frame, ClearBackground and drawing then only touch the bounds of the regions passed to MarkDirty
+//		regions marked after ClearBackground are cleared too, the mode switches at the start of the next frame
 CP_API void				CP_Graphics_ClearBackground			(CP_Color c);
 CP_API void				CP_Graphics_DrawPoint				(float x, float y);
+CP_API void				CP_Graphics_DrawPoints				(const CP_Vector* positions, const CP_Color* colors, int count);
 CP_API void				CP_Graphics_DrawLine				(float x1, float y1, float x2, float y2);
 CP_API void				CP_Graphics_DrawLineAdvanced		(float x1, float y1, float x2, float y2, float degrees);
+CP_API void				CP_Graphics_DrawLines				(const CP_Vector* points, const CP_Color* colors, int count);
 CP_API void				CP_Graphics_DrawRect				(float x, float y, float w, float h);
 CP_API void				CP_Graphics_DrawRectAdvanced		(float x, float y, float w, float h, float degrees, float cornerRadius);
+CP_API void				CP_Graphics_DrawRects				(const CP_Vector* positions, const CP_Vector* sizes, const CP_Color* colors, int count);
 CP_API void				CP_Graphics_DrawCircle				(float x, float y, float d);
+CP_API void				CP_Graphics_DrawCircles				(const CP_Vector* positions, const float* diameters, const CP_Color* colors, int count);
 CP_API void				CP_Graphics_DrawEllipse				(float x, float y, float w, float h);
 CP_API void				CP_Graphics_DrawEllipseAdvanced		(float x, float y, float w, float h, float degrees);
 CP_API void				CP_Graphics_DrawTriangle			(float x1, float y1, float x2, float y2, float x3, float y3);
@@ -147,6 +205,37 @@ CP_API void				CP_Graphics_DrawQuadAdvanced		(float x1, float y1, float x2, floa
 CP_API void				CP_Graphics_BeginShape				(void);
 CP_API void				CP_Graphics_AddVertex				(float x, float y);
 CP_API void				CP_Graphics_EndShape				(void);
+CP_API void				CP_Graphics_DrawPolyline			(const CP_Vector* points, int count);
+CP_API void				CP_Graphics_DrawPolygon				(const CP_Vector* points, int count);
+CP_API void				CP_Graphics_SetDeferredTessellation	(CP_BOOL enabled);
+CP_API void				CP_Graphics_SetRetainedMode			(CP_BOOL enabled);
+CP_API void				CP_Graphics_MarkDirty				(float x, float y, float w, float h);
+
+
+//---------------------------------------------------------
+// SHAPE:
+//		Shapes recorded once and drawn many times without tessellating them again
+//		Record between Begin and End, drawing uses the current fill and stroke settings
+CP_API void				CP_Shape_Begin						(void);
+CP_API void				CP_Shape_AddVertex					(float x, float y);
+CP_API void				CP_Shape_AddRect					(float x, float y, float w, float h, float cornerRadius);
+CP_API void				CP_Shape_AddEllipse					(float x, float y, float w, float h);
+CP_API CP_Shape			CP_Shape_End						(CP_BOOL close);
+CP_API void				CP_Shape_Draw						(CP_Shape shape, float x, float y);
+CP_API void				CP_Shape_DrawAdvanced				(CP_Shape shape, float x, float y, float degrees, float scale);
+CP_API void				CP_Shape_Free						(CP_Shape* shape);
+
+
+//---------------------------------------------------------
+// DRAW LIST:
+//		Record drawing on worker threads and draw it on the main thread in the order the lists are submitted
+//		Between Begin and End, graphics, image and settings calls made on that thread go into the list
+//		Create, Submit and Free on the main thread; text is not recorded and images are loaded on the main thread
+CP_API CP_DrawList		CP_DrawList_Create					(void);
+CP_API void				CP_DrawList_Begin					(CP_DrawList list);
+CP_API void				CP_DrawList_End						(CP_DrawList list);
+CP_API void				CP_DrawList_Submit					(CP_DrawList list);
+CP_API void				CP_DrawList_Free					(CP_DrawList* list);
 
 
 //---------------------------------------------------------
@@ -164,6 +253,34 @@ CP_API CP_Image			CP_Image_CreateFromData				(int w, int h, unsigned char* pixel
 CP_API CP_Image			CP_Image_Screenshot					(int x, int y, int w, int h);
 CP_API void				CP_Image_GetPixelData				(CP_Image img, CP_Color* pixelDataOutput);
 CP_API void				CP_Image_UpdatePixelData			(CP_Image img, CP_Color* pixelDataInput);
+CP_API CP_BOOL			CP_Image_SetAtlased					(CP_Image img, CP_BOOL atlased);
+CP_API CP_BOOL			CP_Image_IsAtlased					(CP_Image img);
+
+
+//---------------------------------------------------------
+// ATLAS:
+//		Images packed into shared textures, draws from the same page are batched together
+CP_API unsigned			CP_Atlas_GetPageCount				(void);
+CP_API unsigned			CP_Atlas_GetImageCount				(void);
+CP_API float			CP_Atlas_GetOccupancy				(void);
+
+
+//---------------------------------------------------------
+// CANVAS:
+//		Offscreen images to draw into, for layers that change rarely like backgrounds, UI panels and trails
+//		Between Begin and End all drawing goes to the canvas, with its top left corner at 0,0 and the current settings
+//		CP_System_GetWindowWidth and Height report the canvas size meanwhile, and the frame counters include its draws
+//		Begin and End flush what was drawn so far, use them on the main thread and never while recording a draw list
+//		GetImage returns the canvas as an image, when the canvas is dirty it first redraws it with the render function
+//		Canvases start dirty, MarkDirty asks for a redraw the next time the image is needed
+CP_API CP_Canvas		CP_Canvas_Create					(int w, int h);
+CP_API void				CP_Canvas_Free						(CP_Canvas* canvas);
+CP_API void				CP_Canvas_Begin						(CP_Canvas canvas);
+CP_API void				CP_Canvas_End						(CP_Canvas canvas);
+CP_API void				CP_Canvas_SetRenderFunction			(CP_Canvas canvas, CP_CanvasCallback render, void* userData);
+CP_API void				CP_Canvas_MarkDirty					(CP_Canvas canvas);
+CP_API CP_BOOL			CP_Canvas_IsDirty					(CP_Canvas canvas);
+CP_API CP_Image			CP_Canvas_GetImage					(CP_Canvas canvas);
 
 
 //---------------------------------------------------------
@@ -193,6 +310,8 @@ CP_API CP_Font			CP_Font_GetDefault					(void);
 CP_API CP_Font			CP_Font_Load						(const char* filepath);
 CP_API void				CP_Font_Free						(CP_Font* font);
 CP_API void				CP_Font_Set							(CP_Font font);
+CP_API int				CP_Font_Prewarm						(CP_Font font, float size, const char* charset);
+CP_API void				CP_Font_SetSDF						(CP_Font font, CP_BOOL enabled);
 CP_API void				CP_Font_DrawText					(const char* text, float x, float y);
 CP_API void				CP_Font_DrawTextBox					(const char* text, float x, float y, float rowWidth);
 
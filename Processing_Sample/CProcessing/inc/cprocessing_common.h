@@ -48,11 +48,17 @@ typedef unsigned int	CP_BOOL;
 typedef struct			CP_Image_Struct* CP_Image;
 typedef struct			CP_Sound_Struct* CP_Sound;
 typedef struct			CP_Font_Struct* CP_Font;
+typedef struct			CP_LoadHandle_Struct* CP_LoadHandle;
+typedef struct			CP_Shape_Struct* CP_Shape;
+typedef struct			CP_DrawList_Struct* CP_DrawList;
+typedef struct			CP_Canvas_Struct* CP_Canvas;
 
 
 //---------------------------------------------------------
 // Function Pointer
 typedef					void(*FunctionPtr)(void);
+typedef					void(*CP_LoadCallback)(CP_LoadHandle handle, void* userData);
+typedef					void(*CP_CanvasCallback)(CP_Canvas canvas, void* userData);
 
 
 //---------------------------------------------------------
@@ -179,6 +185,35 @@ typedef enum CP_SOUND_GROUP
 } CP_SOUND_GROUP;
 
 
+//---------------------------------------------------------
+// LOAD STATUS:
+//		Progress of an asset loading in the background
+typedef enum CP_LOAD_STATUS
+{
+	CP_LOAD_PENDING,
+	CP_LOAD_COMPLETE,
+	CP_LOAD_FAILED
+} CP_LOAD_STATUS;
+
+
+//---------------------------------------------------------
+// FRAME PHASE:
+//		Parts of a frame timed by the built in profiler
+typedef enum CP_FRAME_PHASE
+{
+	CP_FRAME_PHASE_EVENTS,		// polling window events, input, sound and image updates
+	CP_FRAME_PHASE_PRE_UPDATE,	// the pre update function
+	CP_FRAME_PHASE_FIXED_UPDATE,	// the fixed rate simulation steps
+	CP_FRAME_PHASE_UPDATE,		// the game state update (and init/exit when states change)
+	CP_FRAME_PHASE_POST_UPDATE,	// the post update function
+	CP_FRAME_PHASE_RENDER,		// NanoVG path expansion and flushing draw calls
+	CP_FRAME_PHASE_SWAP,		// presenting the frame
+	CP_FRAME_PHASE_SLEEP,		// waiting for the target frame rate
+	CP_FRAME_PHASE_FRAME,		// the whole frame
+	CP_FRAME_PHASE_MAX
+} CP_FRAME_PHASE;
+
+
 //---------------------------------------------------------
 // MATH:
 //		2D vector (x, y) and 3x3 matrix useful for basic linear algebra
@@ -0,0 +1,201 @@
+//
+// Differential test of the path kernels in nanovg.c.
+//
+// The scalar, SSE2 and AVX kernels must produce bit identical vertices. This program tessellates
+// the same seeded random paths with whatever kernels the build picked and writes every vertex the
+// renderer receives to a file, or compares them against a file written by another build:
+//
+//   kernels_test out.bin            write the vertices
+//   kernels_test out.bin ref.bin    write the vertices and compare them with ref.bin
+//
+// Build it once per kernel set by defining NVG_NO_SIMD (scalar) or NVG_NO_AVX (SSE2), or neither
+// (AVX when the CPU has it). kernels_test.sh builds and runs all three, premake4.lua has a project
+// for each. The exit code is 0 when the files match.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/nanovg.h"
+
+#define PATHS 400
+#define SEED 0x2545f491u
+
+static FILE* out = NULL;
+static unsigned int rng = SEED;
+
+static float rnd(float lo, float hi)
+{
+	// xorshift32, the same sequence on every compiler.
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+	return lo + (hi - lo) * (float)(rng & 0xffffff) / (float)0x1000000;
+}
+
+static void writeVerts(const NVGvertex* verts, int count)
+{
+	if (count > 0)
+		fwrite(verts, sizeof(NVGvertex), (size_t)count, out);
+}
+
+static void writePaths(const NVGpath* paths, int npaths)
+{
+	int i;
+	for (i = 0; i < npaths; i++) {
+		fwrite(&paths[i].nfill, sizeof(int), 1, out);
+		fwrite(&paths[i].nstroke, sizeof(int), 1, out);
+		writeVerts(paths[i].fill, paths[i].nfill);
+		writeVerts(paths[i].stroke, paths[i].nstroke);
+	}
+}
+
+// Renderer which records the tessellated paths instead of drawing them.
+static int renderCreate(void* uptr) { NVG_NOTUSED(uptr); return 1; }
+static int renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(type); NVG_NOTUSED(w); NVG_NOTUSED(h); NVG_NOTUSED(imageFlags); NVG_NOTUSED(data);
+	return 1;
+}
+static int renderDeleteTexture(void* uptr, int image) { NVG_NOTUSED(uptr); NVG_NOTUSED(image); return 1; }
+static int renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(image); NVG_NOTUSED(x); NVG_NOTUSED(y); NVG_NOTUSED(w); NVG_NOTUSED(h); NVG_NOTUSED(data);
+	return 1;
+}
+static int renderGetTexturePixelData(void* uptr, int image, unsigned char* data) { NVG_NOTUSED(uptr); NVG_NOTUSED(image); NVG_NOTUSED(data); return 0; }
+static int renderGetTextureSize(void* uptr, int image, int* w, int* h) { NVG_NOTUSED(uptr); NVG_NOTUSED(image); *w = *h = 512; return 1; }
+static void renderViewport(void* uptr, int width, int height, float devicePixelRatio)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(width); NVG_NOTUSED(height); NVG_NOTUSED(devicePixelRatio);
+}
+static void renderCancel(void* uptr) { NVG_NOTUSED(uptr); }
+static void renderFlush(void* uptr) { NVG_NOTUSED(uptr); }
+static void renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+					   const float* bounds, const NVGpath* paths, int npaths)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(paint); NVG_NOTUSED(compositeOperation); NVG_NOTUSED(scissor); NVG_NOTUSED(fringe);
+	fwrite(bounds, sizeof(float), 4, out);
+	writePaths(paths, npaths);
+}
+static void renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+						 float strokeWidth, const NVGpath* paths, int npaths)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(paint); NVG_NOTUSED(compositeOperation); NVG_NOTUSED(scissor); NVG_NOTUSED(fringe); NVG_NOTUSED(strokeWidth);
+	writePaths(paths, npaths);
+}
+static void renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+							const NVGvertex* verts, int nverts)
+{
+	NVG_NOTUSED(uptr); NVG_NOTUSED(paint); NVG_NOTUSED(compositeOperation); NVG_NOTUSED(scissor);
+	writeVerts(verts, nverts);
+}
+static void renderDelete(void* uptr) { NVG_NOTUSED(uptr); }
+
+static void randomPath(NVGcontext* vg)
+{
+	int i, n = 2 + (int)rnd(0.0f, 40.0f);
+	nvgBeginPath(vg);
+	nvgMoveTo(vg, rnd(0.0f, 800.0f), rnd(0.0f, 600.0f));
+	for (i = 0; i < n; i++) {
+		switch ((int)rnd(0.0f, 4.0f)) {
+		case 0: nvgBezierTo(vg, rnd(0.0f, 800.0f), rnd(0.0f, 600.0f), rnd(0.0f, 800.0f), rnd(0.0f, 600.0f), rnd(0.0f, 800.0f), rnd(0.0f, 600.0f)); break;
+		case 1: nvgArcTo(vg, rnd(0.0f, 800.0f), rnd(0.0f, 600.0f), rnd(0.0f, 800.0f), rnd(0.0f, 600.0f), rnd(1.0f, 80.0f)); break;
+		default: nvgLineTo(vg, rnd(0.0f, 800.0f), rnd(0.0f, 600.0f)); break;
+		}
+	}
+	if (rnd(0.0f, 1.0f) < 0.5f)
+		nvgClosePath(vg);
+	if (rnd(0.0f, 1.0f) < 0.3f)
+		nvgCircle(vg, rnd(0.0f, 800.0f), rnd(0.0f, 600.0f), rnd(0.5f, 200.0f));
+}
+
+static int compareFiles(const char* a, const char* b)
+{
+	FILE* fa = fopen(a, "rb");
+	FILE* fb = fopen(b, "rb");
+	long offset = 0;
+	int ca, cb, ret = 0;
+	if (fa == NULL || fb == NULL) {
+		printf("Could not open %s\n", fa == NULL ? a : b);
+		ret = 1;
+	} else {
+		do {
+			ca = fgetc(fa);
+			cb = fgetc(fb);
+			if (ca != cb) {
+				printf("%s and %s differ at byte %ld\n", a, b, offset);
+				ret = 1;
+				break;
+			}
+			offset++;
+		} while (ca != EOF);
+		if (ret == 0)
+			printf("%s and %s match, %ld bytes\n", a, b, offset - 1);
+	}
+	if (fa != NULL) fclose(fa);
+	if (fb != NULL) fclose(fb);
+	return ret;
+}
+
+int main(int argc, char** argv)
+{
+	static const int caps[] = { NVG_BUTT, NVG_ROUND, NVG_SQUARE };
+	static const int joins[] = { NVG_MITER, NVG_ROUND, NVG_BEVEL };
+	NVGparams params;
+	NVGcontext* vg;
+	int i;
+
+	if (argc < 2) {
+		printf("usage: kernels_test out.bin [ref.bin]\n");
+		return 2;
+	}
+	out = fopen(argv[1], "wb");
+	if (out == NULL) {
+		printf("Could not create %s\n", argv[1]);
+		return 2;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.edgeAntiAlias = 1;
+	params.renderCreate = renderCreate;
+	params.renderCreateTexture = renderCreateTexture;
+	params.renderDeleteTexture = renderDeleteTexture;
+	params.renderUpdateTexture = renderUpdateTexture;
+	params.renderGetTexturePixelData = renderGetTexturePixelData;
+	params.renderGetTextureSize = renderGetTextureSize;
+	params.renderViewport = renderViewport;
+	params.renderCancel = renderCancel;
+	params.renderFlush = renderFlush;
+	params.renderFill = renderFill;
+	params.renderStroke = renderStroke;
+	params.renderTriangles = renderTriangles;
+	params.renderDelete = renderDelete;
+	vg = nvgCreateInternal(&params);
+	if (vg == NULL) {
+		printf("Could not create the context\n");
+		return 2;
+	}
+
+	nvgBeginFrame(vg, 800, 600, 1.0f);
+	for (i = 0; i < PATHS; i++) {
+		nvgSave(vg);
+		nvgTranslate(vg, rnd(-50.0f, 50.0f), rnd(-50.0f, 50.0f));
+		nvgRotate(vg, rnd(-3.2f, 3.2f));
+		nvgScale(vg, rnd(0.2f, 3.0f), rnd(0.2f, 3.0f));
+		nvgShapeAntiAlias(vg, rnd(0.0f, 1.0f) < 0.8f);
+		nvgLineCap(vg, caps[(int)rnd(0.0f, 3.0f)]);
+		nvgLineJoin(vg, joins[(int)rnd(0.0f, 3.0f)]);
+		nvgMiterLimit(vg, rnd(1.0f, 10.0f));
+		nvgStrokeWidth(vg, rnd(0.25f, 30.0f));
+		randomPath(vg);
+		nvgFill(vg);
+		nvgStroke(vg);
+		nvgRestore(vg);
+	}
+	nvgEndFrame(vg);
+	nvgDeleteInternal(vg);
+	fclose(out);
+
+	return argc > 2 ? compareFiles(argv[1], argv[2]) : 0;
+}
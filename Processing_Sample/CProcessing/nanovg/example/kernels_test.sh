@@ -0,0 +1,20 @@
+#!/bin/sh
+# Builds kernels_test.c with the scalar, SSE2 and AVX path kernels and checks that all three
+# tessellate the random paths into identical vertices. Run from any directory.
+set -e
+dir=$(cd "$(dirname "$0")" && pwd)
+src="$dir/../src"
+tmp=${TMPDIR:-/tmp}/nvgkernels
+mkdir -p "$tmp"
+
+build() {
+	${CC:-cc} -O2 $1 -I"$src" -I"$dir/../../Source" "$dir/kernels_test.c" "$src/nanovg.c" "$dir/../../Source/tinycthread.c" -lm -lpthread -o "$tmp/$2"
+}
+
+build "-DNVG_NO_SIMD" scalar
+build "-DNVG_NO_AVX" sse2
+build "" avx
+
+"$tmp/scalar" "$tmp/scalar.bin"
+"$tmp/sse2" "$tmp/sse2.bin" "$tmp/scalar.bin"
+"$tmp/avx" "$tmp/avx.bin" "$tmp/scalar.bin"
@@ -224,3 +224,26 @@ solution "nanovg"
 		configuration "Release"
 			defines { "NDEBUG" }
 			flags { "Optimize", "ExtraWarnings"}
+
+	-- Differential test of the path kernels, each project builds one kernel set. Compare their
+	-- output with "kernels_test_sse2 sse2.bin scalar.bin" after running kernels_test_scalar scalar.bin.
+	for _, variant in ipairs { { "scalar", "NVG_NO_SIMD" }, { "sse2", "NVG_NO_AVX" }, { "avx" } } do
+	project ("kernels_test_" .. variant[1])
+		kind "ConsoleApp"
+		language "C"
+		files { "example/kernels_test.c", "src/nanovg.c", "../Source/tinycthread.c" }
+		includedirs { "src", "../Source" }
+		targetdir("build")
+		defines { "_CRT_SECURE_NO_WARNINGS", variant[2] }
+
+		configuration { "linux" }
+			 links { "m", "pthread" }
+
+		configuration "Debug"
+			defines { "DEBUG" }
+			flags { "Symbols", "ExtraWarnings"}
+
+		configuration "Release"
+			defines { "NDEBUG" }
+			flags { "Optimize", "ExtraWarnings"}
+	end
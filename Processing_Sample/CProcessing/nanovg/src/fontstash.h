@@ -100,12 +100,30 @@ void fonsGetAtlasSize(FONScontext* s, int* width, int* height);
 int fonsExpandAtlas(FONScontext* s, int width, int height);
 // Resets the whole stash.
 int fonsResetAtlas(FONScontext* stash, int width, int height);
+// Repacks the atlas at the specified size, keeping the glyph bitmaps used since the last
+// fonsNextFrame() plus the most recently used older ones while they fit in keepArea pixels.
+// Other glyphs are evicted and rasterized again when next needed. Returns 0 on failure.
+int fonsCompactAtlas(FONScontext* stash, int width, int height, int keepArea);
+// Returns how far the atlas is filled, as the fraction of its height below the highest skyline.
+float fonsAtlasUsage(FONScontext* stash);
+// Returns the atlas area in pixels taken by the glyph bitmaps used since the last fonsNextFrame().
+int fonsFrameGlyphArea(FONScontext* stash);
+// Starts a new frame for glyph recency and resets the glyph counters.
+void fonsNextFrame(FONScontext* stash);
+// Returns the bitmap glyph lookups and the glyphs rasterized since fonsNextFrame().
+void fonsGlyphStats(FONScontext* stash, int* lookups, int* rasterized);
 
 // Add fonts
 int fonsAddFont(FONScontext* s, const char* name, const char* path);
 int fonsAddFontMem(FONScontext* s, const char* name, unsigned char* data, int ndata, int freeData);
 int fonsGetFontByName(FONScontext* s, const char* name);
 
+// Renders the glyphs of the font as signed distance fields. Distance field glyphs are rasterized
+// once at FONS_SDF_SIZE and have to be laid out at that size, the caller scales the quads.
+// Returns 0 if the font does not exist.
+int fonsSetFontSDF(FONScontext* s, int font, int enabled);
+int fonsGetFontSDF(FONScontext* s, int font);
+
 // State handling
 void fonsPushState(FONScontext* s);
 void fonsPopState(FONScontext* s);
@@ -134,6 +152,9 @@ int fonsTextIterNext(FONScontext* stash, FONStextIter* iter, struct FONSquad* qu
 // Pull texture changes
 const unsigned char* fonsGetTextureData(FONScontext* stash, int* width, int* height);
 int fonsValidateTexture(FONScontext* s, int* dirty);
+// Same as fonsValidateTexture() but returns up to maxRects separate dirty rectangles, 4 ints each,
+// so glyphs added far apart do not upload everything between them. Returns the number of rectangles.
+int fonsValidateTextureRects(FONScontext* s, int* rects, int maxRects);
 
 // Draws the stash texture for debugging
 void fonsDrawDebug(FONScontext* s, float x, float y);
@@ -335,6 +356,18 @@ int fons__tt_getGlyphKernAdvance(FONSttFontImpl *font, int glyph1, int glyph2)
 #ifndef FONS_MAX_FALLBACKS
 #	define FONS_MAX_FALLBACKS 20
 #endif
+#ifndef FONS_MAX_DIRTY_RECTS
+#	define FONS_MAX_DIRTY_RECTS 8
+#endif
+#ifndef FONS_SDF_SIZE
+#	define FONS_SDF_SIZE 48			// Pixel size distance field glyphs are rasterized at.
+#endif
+#ifndef FONS_SDF_PAD
+#	define FONS_SDF_PAD 6			// Distance in pixels at FONS_SDF_SIZE the field reaches out from the outline.
+#endif
+#ifndef FONS_SDF_SUPERSAMPLE
+#	define FONS_SDF_SUPERSAMPLE 4	// Outline resolution the distances are measured at.
+#endif
 
 static unsigned int fons__hashint(unsigned int a)
 {
@@ -365,6 +398,7 @@ struct FONSglyph
 	short size, blur;
 	short x0,y0,x1,y1;
 	short xadv,xoff,yoff;
+	int frame;			// Last frame the bitmap was used in, see fonsNextFrame().
 };
 typedef struct FONSglyph FONSglyph;
 
@@ -384,6 +418,7 @@ struct FONSfont
 	int lut[FONS_HASH_LUT_SIZE];
 	int fallbacks[FONS_MAX_FALLBACKS];
 	int nfallbacks;
+	int sdf;
 };
 typedef struct FONSfont FONSfont;
 
@@ -418,6 +453,8 @@ struct FONScontext
 	float itw,ith;
 	unsigned char* texData;
 	int dirtyRect[4];
+	int dirtyRects[FONS_MAX_DIRTY_RECTS][4];	// Parts of dirtyRect, uploaded separately.
+	int ndirtyRects;
 	FONSfont** fonts;
 	FONSatlas* atlas;
 	int cfonts;
@@ -432,6 +469,11 @@ struct FONScontext
 	int nstates;
 	void (*handleError)(void* uptr, int error, int val);
 	void* errorUptr;
+	int frame;
+	int glyphLookups;
+	int glyphsRasterized;
+	unsigned char* sdfData;		// Scratch space of the distance transform.
+	int nsdfData;
 };
 
 #ifdef STB_TRUETYPE_IMPLEMENTATION
@@ -684,6 +726,60 @@ static int fons__atlasAddRect(FONSatlas* atlas, int rw, int rh, int* rx, int* ry
 	return 1;
 }
 
+static void fons__clearDirty(FONScontext* stash)
+{
+	stash->dirtyRect[0] = stash->params.width;
+	stash->dirtyRect[1] = stash->params.height;
+	stash->dirtyRect[2] = 0;
+	stash->dirtyRect[3] = 0;
+	stash->ndirtyRects = 0;
+}
+
+static int fons__rectArea(const int* r)
+{
+	return (r[2] - r[0]) * (r[3] - r[1]);
+}
+
+static void fons__addDirty(FONScontext* stash, int x0, int y0, int x1, int y1)
+{
+	int i, best = -1, bestGrowth = 0;
+	int area = (x1 - x0) * (y1 - y0);
+
+	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], x0);
+	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], y0);
+	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], x1);
+	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], y1);
+
+	// Join the rectangle that grows the least, unless that would upload more than keeping them apart.
+	for (i = 0; i < stash->ndirtyRects; i++) {
+		int* r = stash->dirtyRects[i];
+		int u[4];
+		int growth;
+		u[0] = fons__mini(r[0], x0);
+		u[1] = fons__mini(r[1], y0);
+		u[2] = fons__maxi(r[2], x1);
+		u[3] = fons__maxi(r[3], y1);
+		growth = fons__rectArea(u) - fons__rectArea(r) - area;
+		if (best == -1 || growth < bestGrowth) {
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+	if (best != -1 && (bestGrowth <= area || stash->ndirtyRects == FONS_MAX_DIRTY_RECTS)) {
+		int* r = stash->dirtyRects[best];
+		r[0] = fons__mini(r[0], x0);
+		r[1] = fons__mini(r[1], y0);
+		r[2] = fons__maxi(r[2], x1);
+		r[3] = fons__maxi(r[3], y1);
+	} else {
+		int* r = stash->dirtyRects[stash->ndirtyRects++];
+		r[0] = x0;
+		r[1] = y0;
+		r[2] = x1;
+		r[3] = y1;
+	}
+}
+
 static void fons__addWhiteRect(FONScontext* stash, int w, int h)
 {
 	int x, y, gx, gy;
@@ -699,10 +795,7 @@ static void fons__addWhiteRect(FONScontext* stash, int w, int h)
 		dst += stash->params.width;
 	}
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], gx);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], gy);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], gx+w);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], gy+h);
+	fons__addDirty(stash, gx, gy, gx+w, gy+h);
 }
 
 FONScontext* fonsCreateInternal(FONSparams* params)
@@ -745,10 +838,7 @@ FONScontext* fonsCreateInternal(FONSparams* params)
 	if (stash->texData == NULL) goto error;
 	memset(stash->texData, 0, stash->params.width * stash->params.height);
 
-	stash->dirtyRect[0] = stash->params.width;
-	stash->dirtyRect[1] = stash->params.height;
-	stash->dirtyRect[2] = 0;
-	stash->dirtyRect[3] = 0;
+	fons__clearDirty(stash);
 
 	// Add white rect at 0,0 for debug drawing.
 	fons__addWhiteRect(stash, 2,2);
@@ -976,6 +1066,28 @@ int fonsGetFontByName(FONScontext* s, const char* name)
 	return FONS_INVALID;
 }
 
+int fonsSetFontSDF(FONScontext* stash, int font, int enabled)
+{
+	FONSfont* fnt;
+	int i;
+	if (stash == NULL || font < 0 || font >= stash->nfonts) return 0;
+	fnt = stash->fonts[font];
+	enabled = enabled ? 1 : 0;
+	if (fnt->sdf == enabled) return 1;
+	fnt->sdf = enabled;
+	// Forget the glyphs rendered the other way, their atlas space is reclaimed by fonsCompactAtlas().
+	fnt->nglyphs = 0;
+	for (i = 0; i < FONS_HASH_LUT_SIZE; ++i)
+		fnt->lut[i] = -1;
+	return 1;
+}
+
+int fonsGetFontSDF(FONScontext* stash, int font)
+{
+	if (stash == NULL || font < 0 || font >= stash->nfonts) return 0;
+	return stash->fonts[font]->sdf;
+}
+
 
 static FONSglyph* fons__allocGlyph(FONSfont* font)
 {
@@ -1054,6 +1166,122 @@ static void fons__blur(FONScontext* stash, unsigned char* dst, int w, int h, int
 //	fons__blurcols(dst, w, h, dstStride, alpha);
 }
 
+struct FONSsdfPoint {
+	short dx, dy;	// Offset to the nearest seed pixel.
+};
+typedef struct FONSsdfPoint FONSsdfPoint;
+
+#define FONS_SDF_FAR 4000
+
+static int fons__sdfDist2(FONSsdfPoint p)
+{
+	return (int)p.dx*p.dx + (int)p.dy*p.dy;
+}
+
+static void fons__sdfCompare(FONSsdfPoint* grid, int w, int x, int y, int ox, int oy)
+{
+	FONSsdfPoint* p = &grid[x + y*w];
+	FONSsdfPoint o = grid[(x+ox) + (y+oy)*w];
+	o.dx = (short)(o.dx + ox);
+	o.dy = (short)(o.dy + oy);
+	if (fons__sdfDist2(o) < fons__sdfDist2(*p))
+		*p = o;
+}
+
+// Two pass 8-point sequential Euclidean distance transform.
+static void fons__sdfTransform(FONSsdfPoint* grid, int w, int h)
+{
+	int x, y;
+	for (y = 0; y < h; y++) {
+		for (x = 0; x < w; x++) {
+			if (x > 0) fons__sdfCompare(grid, w, x, y, -1, 0);
+			if (y > 0) {
+				fons__sdfCompare(grid, w, x, y, 0, -1);
+				if (x > 0) fons__sdfCompare(grid, w, x, y, -1, -1);
+				if (x < w-1) fons__sdfCompare(grid, w, x, y, 1, -1);
+			}
+		}
+		for (x = w-2; x >= 0; x--)
+			fons__sdfCompare(grid, w, x, y, 1, 0);
+	}
+	for (y = h-1; y >= 0; y--) {
+		for (x = w-1; x >= 0; x--) {
+			if (x < w-1) fons__sdfCompare(grid, w, x, y, 1, 0);
+			if (y < h-1) {
+				fons__sdfCompare(grid, w, x, y, 0, 1);
+				if (x > 0) fons__sdfCompare(grid, w, x, y, -1, 1);
+				if (x < w-1) fons__sdfCompare(grid, w, x, y, 1, 1);
+			}
+		}
+		for (x = 1; x < w; x++)
+			fons__sdfCompare(grid, w, x, y, -1, 0);
+	}
+}
+
+// Renders the glyph box gw,gh as a signed distance field, 128 on the outline and falling off
+// over FONS_SDF_PAD pixels to either side. The outline is rasterized FONS_SDF_SUPERSAMPLE times
+// larger and the distances of each block of subpixels are averaged.
+static void fons__renderGlyphSDF(FONScontext* stash, FONSttFontImpl* font, unsigned char* dst, int gw, int gh, int dstStride,
+								 float size, float scale, int g, int x0, int y0)
+{
+	const int ss = FONS_SDF_SUPERSAMPLE;
+	int hw = gw*ss, hh = gh*ss, n = hw*hh;
+	int advance, lsb, hx0, hy0, hx1, hy1, ox, oy, x, y, i, j;
+	int needed = n + (int)sizeof(FONSsdfPoint)*n*2;
+	unsigned char* cov;
+	FONSsdfPoint* toInside;
+	FONSsdfPoint* toOutside;
+
+	if (stash->nsdfData < needed) {
+		unsigned char* data = (unsigned char*)realloc(stash->sdfData, needed);
+		if (data == NULL) return;
+		stash->sdfData = data;
+		stash->nsdfData = needed;
+	}
+	toInside = (FONSsdfPoint*)stash->sdfData;
+	toOutside = toInside + n;
+	cov = (unsigned char*)(toOutside + n);
+	memset(cov, 0, n);
+
+	// Place the large outline so that it lines up with the glyph box.
+	fons__tt_buildGlyphBitmap(font, g, size*ss, scale*ss, &advance, &lsb, &hx0, &hy0, &hx1, &hy1);
+	ox = hx0 - (x0 - FONS_SDF_PAD)*ss;
+	oy = hy0 - (y0 - FONS_SDF_PAD)*ss;
+	if (ox >= 0 && oy >= 0 && ox + (hx1-hx0) <= hw && oy + (hy1-hy0) <= hh && hx1 > hx0 && hy1 > hy0) {
+		fons__tt_renderGlyphBitmap(font, &cov[ox + oy*hw], hx1-hx0, hy1-hy0, hw, scale*ss, scale*ss, g);
+	}
+
+	for (i = 0; i < n; i++) {
+		FONSsdfPoint seed = { 0, 0 }, none = { FONS_SDF_FAR, FONS_SDF_FAR };
+		int inside = cov[i] >= 128;
+		toInside[i] = inside ? seed : none;
+		toOutside[i] = inside ? none : seed;
+	}
+	fons__sdfTransform(toInside, hw, hh);
+	fons__sdfTransform(toOutside, hw, hh);
+
+	for (y = 0; y < gh; y++) {
+		for (x = 0; x < gw; x++) {
+			float d = 0.0f, v;
+			for (j = 0; j < ss; j++) {
+				for (i = 0; i < ss; i++) {
+					int k = (x*ss + i) + (y*ss + j)*hw;
+					// Pixel centers are half a pixel away from the outline between them.
+					if (cov[k] >= 128)
+						d -= sqrtf((float)fons__sdfDist2(toOutside[k])) - 0.5f;
+					else
+						d += sqrtf((float)fons__sdfDist2(toInside[k])) - 0.5f;
+				}
+			}
+			d /= (float)(ss*ss*ss);
+			v = 0.5f - d / (2.0f*FONS_SDF_PAD);
+			if (v < 0.0f) v = 0.0f;
+			if (v > 1.0f) v = 1.0f;
+			dst[x + y*dstStride] = (unsigned char)(v*255.0f + 0.5f);
+		}
+	}
+}
+
 static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned int codepoint,
 								 short isize, short iblur, int bitmapOption)
 {
@@ -1069,7 +1297,10 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 
 	if (isize < 2) return NULL;
 	if (iblur > 20) iblur = 20;
-	pad = iblur+2;
+	if (font->sdf) iblur = 0;
+	pad = font->sdf ? FONS_SDF_PAD : iblur+2;
+	if (bitmapOption == FONS_GLYPH_BITMAP_REQUIRED)
+		stash->glyphLookups++;
 
 	// Reset allocator.
 	stash->nscratch = 0;
@@ -1080,7 +1311,11 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	while (i != -1) {
 		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur) {
 			glyph = &font->glyphs[i];
-			if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL || (glyph->x0 >= 0 && glyph->y0 >= 0)) {
+			if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL) {
+			  return glyph;
+			}
+			if (glyph->x0 >= 0 && glyph->y0 >= 0) {
+			  glyph->frame = stash->frame;
 			  return glyph;
 			}
 			// At this point, glyph exists but the bitmap data is not yet created.
@@ -1146,14 +1381,20 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	glyph->xadv = (short)(scale * advance * 10.0f);
 	glyph->xoff = (short)(x0 - pad);
 	glyph->yoff = (short)(y0 - pad);
+	glyph->frame = stash->frame;
 
 	if (bitmapOption == FONS_GLYPH_BITMAP_OPTIONAL) {
 		return glyph;
 	}
 
 	// Rasterize
-	dst = &stash->texData[(glyph->x0+pad) + (glyph->y0+pad) * stash->params.width];
-	fons__tt_renderGlyphBitmap(&renderFont->font, dst, gw-pad*2,gh-pad*2, stash->params.width, scale, scale, g);
+	if (font->sdf) {
+		dst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
+		fons__renderGlyphSDF(stash, &renderFont->font, dst, gw, gh, stash->params.width, size, scale, g, x0, y0);
+	} else {
+		dst = &stash->texData[(glyph->x0+pad) + (glyph->y0+pad) * stash->params.width];
+		fons__tt_renderGlyphBitmap(&renderFont->font, dst, gw-pad*2,gh-pad*2, stash->params.width, scale, scale, g);
+	}
 
 	// Make sure there is one pixel empty border.
 	dst = &stash->texData[glyph->x0 + glyph->y0 * stash->params.width];
@@ -1183,24 +1424,37 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 		fons__blur(stash, bdst, gw, gh, stash->params.width, iblur);
 	}
 
-	stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], glyph->x0);
-	stash->dirtyRect[1] = fons__mini(stash->dirtyRect[1], glyph->y0);
-	stash->dirtyRect[2] = fons__maxi(stash->dirtyRect[2], glyph->x1);
-	stash->dirtyRect[3] = fons__maxi(stash->dirtyRect[3], glyph->y1);
+	fons__addDirty(stash, glyph->x0, glyph->y0, glyph->x1, glyph->y1);
+	stash->glyphsRasterized++;
 
 	return glyph;
 }
 
+// Pen advance after a glyph, whole pixels unless the font is a distance field.
+static float fons__glyphAdvance(FONSfont* font, FONSglyph* glyph)
+{
+	if (font->sdf)
+		return glyph->xadv / 10.0f;
+	return (float)(int)(glyph->xadv / 10.0f + 0.5f);
+}
+
+// Pen advance between two glyphs, kerning plus letter spacing.
+static float fons__kernAdvance(FONSfont* font, int prevGlyphIndex, FONSglyph* glyph, float scale, float spacing)
+{
+	float adv = fons__tt_getGlyphKernAdvance(&font->font, prevGlyphIndex, glyph->index) * scale;
+	if (font->sdf)
+		return adv + spacing;
+	return (float)(int)(adv + spacing + 0.5f);
+}
+
 static void fons__getQuad(FONScontext* stash, FONSfont* font,
 						   int prevGlyphIndex, FONSglyph* glyph,
 						   float scale, float spacing, float* x, float* y, FONSquad* q)
 {
 	float rx,ry,xoff,yoff,x0,y0,x1,y1;
 
-	if (prevGlyphIndex != -1) {
-		float adv = fons__tt_getGlyphKernAdvance(&font->font, prevGlyphIndex, glyph->index) * scale;
-		*x += (int)(adv + spacing + 0.5f);
-	}
+	if (prevGlyphIndex != -1)
+		*x += fons__kernAdvance(font, prevGlyphIndex, glyph, scale, spacing);
 
 	// Each glyph has 2px border to allow good interpolation,
 	// one pixel to prevent leaking, and one to allow good interpolation for rendering.
@@ -1212,7 +1466,20 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 	x1 = (float)(glyph->x1-1);
 	y1 = (float)(glyph->y1-1);
 
-	if (stash->params.flags & FONS_ZERO_TOPLEFT) {
+	if (font->sdf) {
+		// Distance field glyphs are scaled afterwards, snapping to pixels here would show as uneven spacing.
+		rx = *x + xoff;
+		ry = (stash->params.flags & FONS_ZERO_TOPLEFT) ? *y + yoff : *y - yoff;
+		q->x0 = rx;
+		q->y0 = ry;
+		q->x1 = rx + x1 - x0;
+		q->y1 = (stash->params.flags & FONS_ZERO_TOPLEFT) ? ry + y1 - y0 : ry - y1 + y0;
+
+		q->s0 = x0 * stash->itw;
+		q->t0 = y0 * stash->ith;
+		q->s1 = x1 * stash->itw;
+		q->t1 = y1 * stash->ith;
+	} else if (stash->params.flags & FONS_ZERO_TOPLEFT) {
 		rx = (float)(int)(*x + xoff);
 		ry = (float)(int)(*y + yoff);
 
@@ -1240,7 +1507,7 @@ static void fons__getQuad(FONScontext* stash, FONSfont* font,
 		q->t1 = y1 * stash->ith;
 	}
 
-	*x += (int)(glyph->xadv / 10.0f + 0.5f);
+	*x += fons__glyphAdvance(font, glyph);
 }
 
 static void fons__flush(FONScontext* stash)
@@ -1250,10 +1517,7 @@ static void fons__flush(FONScontext* stash)
 		if (stash->params.renderUpdate != NULL)
 			stash->params.renderUpdate(stash->params.userPtr, stash->dirtyRect, stash->texData);
 		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+		fons__clearDirty(stash);
 	}
 
 	// Flush triangles
@@ -1624,15 +1888,29 @@ int fonsValidateTexture(FONScontext* stash, int* dirty)
 		dirty[2] = stash->dirtyRect[2];
 		dirty[3] = stash->dirtyRect[3];
 		// Reset dirty rect
-		stash->dirtyRect[0] = stash->params.width;
-		stash->dirtyRect[1] = stash->params.height;
-		stash->dirtyRect[2] = 0;
-		stash->dirtyRect[3] = 0;
+		fons__clearDirty(stash);
 		return 1;
 	}
 	return 0;
 }
 
+int fonsValidateTextureRects(FONScontext* stash, int* rects, int maxRects)
+{
+	int i, n = stash->ndirtyRects;
+
+	if (n == 0 || maxRects <= 0)
+		return fonsValidateTexture(stash, rects);
+	if (n > maxRects) {
+		// Not enough room, fall back to the bounding rectangle.
+		fonsValidateTexture(stash, rects);
+		return 1;
+	}
+	for (i = 0; i < n; i++)
+		memcpy(&rects[i*4], stash->dirtyRects[i], sizeof(int)*4);
+	fons__clearDirty(stash);
+	return n;
+}
+
 void fonsDeleteInternal(FONScontext* stash)
 {
 	int i;
@@ -1648,6 +1926,7 @@ void fonsDeleteInternal(FONScontext* stash)
 	if (stash->fonts) free(stash->fonts);
 	if (stash->texData) free(stash->texData);
 	if (stash->scratch) free(stash->scratch);
+	if (stash->sdfData) free(stash->sdfData);
 	free(stash);
 }
 
@@ -1712,6 +1991,8 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
 	stash->dirtyRect[1] = 0;
 	stash->dirtyRect[2] = stash->params.width;
 	stash->dirtyRect[3] = maxy;
+	memcpy(stash->dirtyRects[0], stash->dirtyRect, sizeof(stash->dirtyRect));
+	stash->ndirtyRects = 1;
 
 	stash->params.width = width;
 	stash->params.height = height;
@@ -1748,6 +2029,7 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 	stash->dirtyRect[1] = height;
 	stash->dirtyRect[2] = 0;
 	stash->dirtyRect[3] = 0;
+	stash->ndirtyRects = 0;
 
 	// Reset cached glyphs
 	for (i = 0; i < stash->nfonts; i++) {
@@ -1768,5 +2050,163 @@ int fonsResetAtlas(FONScontext* stash, int width, int height)
 	return 1;
 }
 
+struct FONSglyphRef {
+	FONSglyph* glyph;
+	int frame;
+	int height;
+};
+typedef struct FONSglyphRef FONSglyphRef;
+
+static int fons__cmpGlyphRef(const void* a, const void* b)
+{
+	const FONSglyphRef* ga = (const FONSglyphRef*)a;
+	const FONSglyphRef* gb = (const FONSglyphRef*)b;
+	// Most recently used first, taller first within a frame for tighter packing.
+	if (ga->frame != gb->frame) return ga->frame > gb->frame ? -1 : 1;
+	if (ga->height != gb->height) return ga->height > gb->height ? -1 : 1;
+	return 0;
+}
+
+int fonsCompactAtlas(FONScontext* stash, int width, int height, int keepArea)
+{
+	int i, j, n = 0, area = 0, maxy = 0;
+	int oldWidth;
+	unsigned char* oldData;
+	unsigned char* data;
+	FONSglyphRef* refs;
+
+	if (stash == NULL) return 0;
+
+	for (i = 0; i < stash->nfonts; i++)
+		n += stash->fonts[i]->nglyphs;
+	data = (unsigned char*)malloc(width * height);
+	refs = (FONSglyphRef*)malloc(sizeof(FONSglyphRef) * (n > 0 ? n : 1));
+	if (data == NULL || refs == NULL) {
+		free(data);
+		free(refs);
+		return 0;
+	}
+	memset(data, 0, width * height);
+
+	// Rank the glyphs that have a bitmap.
+	n = 0;
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			if (glyph->x0 < 0 || glyph->y0 < 0) continue;
+			refs[n].glyph = glyph;
+			refs[n].frame = glyph->frame;
+			refs[n].height = glyph->y1 - glyph->y0;
+			n++;
+		}
+	}
+	qsort(refs, n, sizeof(FONSglyphRef), fons__cmpGlyphRef);
+
+	if (stash->params.renderResize != NULL) {
+		if (stash->params.renderResize(stash->params.userPtr, width, height) == 0) {
+			free(data);
+			free(refs);
+			return 0;
+		}
+	}
+
+	oldData = stash->texData;
+	oldWidth = stash->params.width;
+	stash->texData = data;
+	stash->params.width = width;
+	stash->params.height = height;
+	stash->itw = 1.0f/stash->params.width;
+	stash->ith = 1.0f/stash->params.height;
+	fons__atlasReset(stash->atlas, width, height);
+	fons__clearDirty(stash);
+	fons__addWhiteRect(stash, 2,2);
+
+	// Copy the bitmaps over, glyphs of the current frame stay as long as they fit.
+	for (i = 0; i < n; i++) {
+		FONSglyph* glyph = refs[i].glyph;
+		int gw = glyph->x1 - glyph->x0;
+		int gh = glyph->y1 - glyph->y0;
+		int gx, gy, y;
+		if ((glyph->frame == stash->frame || area + gw*gh <= keepArea) && fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy)) {
+			for (y = 0; y < gh; y++)
+				memcpy(&data[gx + (gy+y)*width], &oldData[glyph->x0 + (glyph->y0+y)*oldWidth], gw);
+			glyph->x0 = (short)gx;
+			glyph->y0 = (short)gy;
+			glyph->x1 = (short)(gx+gw);
+			glyph->y1 = (short)(gy+gh);
+			area += gw*gh;
+			maxy = fons__maxi(maxy, gy+gh);
+		} else {
+			glyph->x0 = glyph->y0 = glyph->x1 = glyph->y1 = -1;
+		}
+	}
+	free(refs);
+	free(oldData);
+
+	// Drop evicted glyphs and rebuild the lookups.
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		int nglyphs = 0;
+		for (j = 0; j < FONS_HASH_LUT_SIZE; j++)
+			font->lut[j] = -1;
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			unsigned int h;
+			if (glyph->x0 < 0 || glyph->y0 < 0) continue;
+			h = fons__hashint(glyph->codepoint) & (FONS_HASH_LUT_SIZE-1);
+			font->glyphs[nglyphs] = *glyph;
+			font->glyphs[nglyphs].next = font->lut[h];
+			font->lut[h] = nglyphs;
+			nglyphs++;
+		}
+		font->nglyphs = nglyphs;
+	}
+
+	// Upload everything that was kept.
+	if (maxy > 0)
+		fons__addDirty(stash, 0, 0, width, maxy);
+
+	return 1;
+}
+
+float fonsAtlasUsage(FONScontext* stash)
+{
+	int i, maxy = 0;
+	if (stash == NULL || stash->params.height == 0) return 0;
+	for (i = 0; i < stash->atlas->nnodes; i++)
+		maxy = fons__maxi(maxy, stash->atlas->nodes[i].y);
+	return (float)maxy / (float)stash->params.height;
+}
+
+int fonsFrameGlyphArea(FONScontext* stash)
+{
+	int i, j, area = 0;
+	if (stash == NULL) return 0;
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph* glyph = &font->glyphs[j];
+			if (glyph->x0 < 0 || glyph->y0 < 0 || glyph->frame != stash->frame) continue;
+			area += (glyph->x1 - glyph->x0) * (glyph->y1 - glyph->y0);
+		}
+	}
+	return area;
+}
+
+void fonsNextFrame(FONScontext* stash)
+{
+	if (stash == NULL) return;
+	stash->frame++;
+	stash->glyphLookups = 0;
+	stash->glyphsRasterized = 0;
+}
+
+void fonsGlyphStats(FONScontext* stash, int* lookups, int* rasterized)
+{
+	if (lookups != NULL) *lookups = stash != NULL ? stash->glyphLookups : 0;
+	if (rasterized != NULL) *rasterized = stash != NULL ? stash->glyphsRasterized : 0;
+}
+
 
 #endif
@@ -22,6 +22,7 @@
 #include <memory.h>
 
 #include "nanovg.h"
+#include "tinycthread.h"
 #define FONTSTASH_IMPLEMENTATION
 #include "fontstash.h"
 #define STB_IMAGE_IMPLEMENTATION
@@ -43,11 +44,31 @@
 #define NVG_INIT_PATHS_SIZE 16
 #define NVG_INIT_VERTS_SIZE 256
 #define NVG_MAX_STATES 32
+#define NVG_MAX_QUADS 256
+#define NVG_ELLIPSE_LODS 15	// Ring sizes 8, 12, 16, 24, ... 768, 1024.
+#define NVG_DEFER_CHUNK 16	// Deferred draws a thread tessellates per job.
+#define NVG_TEXT_CACHE_BUCKETS 256
+#define NVG_TEXT_CACHE_BUDGET (1024*1024)	// Default byte budget of the text layout cache.
+#define NVG_ATLAS_COMPACT_USAGE 0.75f	// Font atlas fill at which nvgEndFrame() evicts old glyphs.
 
 #define NVG_KAPPA90 0.5522847493f	// Length proportional to radius of a cubic bezier handle for 90deg arcs.
 
 #define NVG_COUNTOF(arr) (sizeof(arr) / sizeof(0[arr]))
 
+// SSE2 is part of every x64 target and of MSVC's default x86 target. The AVX
+// kernels are compiled for AVX only and picked at runtime. Define NVG_NO_SIMD
+// to build with the scalar kernels only, or NVG_NO_AVX to never pick AVX.
+#if !defined(NVG_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define NVG_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define NVG_TARGET_AVX
+#else
+#define NVG_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
 
 enum NVGcommands {
 	NVG_MOVETO = 0,
@@ -55,6 +76,7 @@ enum NVGcommands {
 	NVG_BEZIERTO = 2,
 	NVG_CLOSE = 3,
 	NVG_WINDING = 4,
+	NVG_ELLIPSE = 5,	// center, then both semi-axes as vectors; flattened from a cached ring
 };
 
 enum NVGpointFlags
@@ -112,6 +134,157 @@ struct NVGpathCache {
 };
 typedef struct NVGpathCache NVGpathCache;
 
+// Per-point kernels of path expansion, see nvg__selectKernels().
+struct NVGkernels {
+	// Segment direction and length of points [first, count) of a path, growing bounds.
+	void (*segments)(NVGpoint* pts, int first, int count, float* bounds);
+	// Join extrusion and flags of points [first, count), returns the beveled point count.
+	int (*joins)(NVGpoint* pts, int first, int count, float iw, float miterLimit, int bevelCorners, int* nleft);
+	// Left and right vertex of each point, extruded along its miter.
+	NVGvertex* (*extrude)(NVGvertex* dst, const NVGpoint* pts, int count, float lw, float rw, float lu, float ru);
+};
+typedef struct NVGkernels NVGkernels;
+
+enum NVGdeferKind {
+	NVG_DEFER_FILL,
+	NVG_DEFER_STROKE,
+};
+
+// A fill or stroke recorded in deferred mode, with everything needed to tessellate and submit it later.
+struct NVGdeferredDraw {
+	int kind;
+	int firstCommand;
+	int ncommands;
+	NVGpaint paint;
+	NVGcompositeOperationState compositeOperation;
+	NVGscissor scissor;
+	float fringe;		// Anti-aliasing fringe to expand with, 0 when not anti-aliased.
+	float strokeWidth;
+	int lineCap;
+	int lineJoin;
+	float miterLimit;
+	// Result, written by the thread that tessellated the draw.
+	int worker;
+	int firstPath;
+	int npaths;
+	float bounds[4];
+};
+typedef struct NVGdeferredDraw NVGdeferredDraw;
+
+// Tessellated paths kept past the path cache. Vertices are addressed by offset
+// while the buffer grows, nvg__resolvePathBuffer() turns them into pointers.
+struct NVGpathBuffer {
+	NVGpath* paths;
+	int* offsets;			// Fill and stroke vertex offset of each path, -1 for none.
+	int npaths;
+	int cpaths;
+	NVGvertex* verts;
+	int nverts;
+	int cverts;
+};
+typedef struct NVGpathBuffer NVGpathBuffer;
+
+// A tessellating thread, worker 0 is the thread that flushes.
+struct NVGdeferWorker {
+	struct NVGdeferred* def;
+	NVGcontext* scratch;	// Private path cache and tolerances, commands point into the recorded list.
+	thrd_t thread;
+	NVGpathBuffer out;
+};
+typedef struct NVGdeferWorker NVGdeferWorker;
+
+struct NVGdeferred {
+	NVGdeferredDraw* draws;
+	int ndraws;
+	int cdraws;
+	float* commands;
+	int ncommands;
+	int ccommands;
+	int pathRecorded;		// The current path is already in commands, at pathCommand.
+	int pathCommand;
+	NVGdeferWorker* workers;
+	int nworkers;
+	mtx_t lock;
+	cnd_t wake;
+	cnd_t done;
+	int generation;
+	int nextDraw;
+	int busy;
+	int quit;
+};
+typedef struct NVGdeferred NVGdeferred;
+
+// Everything a text layout depends on besides the string itself.
+struct NVGtextKey {
+	int fontId;
+	int align;
+	float fontSize;
+	float letterSpacing;
+	float fontBlur;
+	float scale;			// Font scale times device pixel ratio.
+	int box;				// Laid out by nvgTextBox().
+	float breakRowWidth;	// Only used by nvgTextBox(), 0 otherwise.
+	float lineHeight;
+	int len;
+};
+typedef struct NVGtextKey NVGtextKey;
+
+// A glyph quad relative to the pen, replayed the same way fons__getQuad() places it.
+struct NVGtextGlyph {
+	float kern;			// Pen advance before the glyph, kerning plus letter spacing.
+	float xadv;			// Pen advance after the glyph.
+	float xoff, yoff;
+	float w, h;
+	float s0, t0, s1, t1;
+	int glyph;			// Index in the glyphs of the font, marked used when the layout is replayed.
+};
+typedef struct NVGtextGlyph NVGtextGlyph;
+
+struct NVGtextLine {
+	float width;		// Row width as returned by nvgTextBreakLines().
+	float originX;		// Aligned pen start of the line laid out at the origin, in font pixels.
+	float originY;
+	int firstGlyph;
+	int nglyphs;
+};
+typedef struct NVGtextLine NVGtextLine;
+
+// Positioned glyphs of one nvgText() or nvgTextBox() call. The key, lines, glyphs
+// and string copy share one allocation. Layouts reference the current font atlas
+// and are dropped whenever it is reset.
+struct NVGtextLayout {
+	NVGtextKey key;
+	unsigned int hash;
+	int bytes;
+	float lineh;
+	int sdf;				// Quads are not snapped to pixels, see fons__getQuad().
+	NVGtextLine* lines;
+	int nlines;
+	NVGtextGlyph* glyphs;
+	int nglyphs;
+	char* text;
+	struct NVGtextLayout* next;		// Hash bucket chain.
+	struct NVGtextLayout* lruPrev;	// Towards the most recently used layout.
+	struct NVGtextLayout* lruNext;
+};
+typedef struct NVGtextLayout NVGtextLayout;
+
+struct NVGtextCache {
+	NVGtextLayout* buckets[NVG_TEXT_CACHE_BUCKETS];
+	NVGtextLayout* lruHead;
+	NVGtextLayout* lruTail;
+	int bytes;
+	int budget;
+	// Scratch space the layout is built in before it is copied out.
+	NVGtextLine* lines;
+	int clines;
+	NVGtextGlyph* glyphs;
+	int cglyphs;
+	int nlines;
+	int nglyphs;
+};
+typedef struct NVGtextCache NVGtextCache;
+
 struct NVGcontext {
 	NVGparams params;
 	float* commands;
@@ -132,8 +305,24 @@ struct NVGcontext {
 	int fillTriCount;
 	int strokeTriCount;
 	int textTriCount;
+	int culledCount;
+	int textCacheHits;
+	int textCacheMisses;
+	float viewWidth;
+	float viewHeight;
+	NVGframeStats stats;
+	NVGquad quads[NVG_MAX_QUADS];
+	float* ellipseRings[NVG_ELLIPSE_LODS];
+	const NVGkernels* kernels;
+	NVGdeferred* deferred;
+	NVGtextCache textCache;
 };
 
+static const NVGkernels* nvg__selectKernels(void);
+static void nvg__flushDeferred(NVGcontext* ctx);
+static void nvg__deleteDeferred(NVGdeferred* def);
+static void nvg__clearTextCache(NVGcontext* ctx);
+
 static float nvg__sqrtf(float a) { return sqrtf(a); }
 static float nvg__modf(float a, float b) { return fmodf(a, b); }
 static float nvg__sinf(float a) { return sinf(a); }
@@ -331,6 +520,8 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 
 	ctx->cache = nvg__allocPathCache();
 	if (ctx->cache == NULL) goto error;
+	ctx->kernels = nvg__selectKernels();
+	ctx->textCache.budget = NVG_TEXT_CACHE_BUDGET;
 
 	nvgSave(ctx);
 	nvgReset(ctx);
@@ -373,8 +564,14 @@ void nvgDeleteInternal(NVGcontext* ctx)
 {
 	int i;
 	if (ctx == NULL) return;
+	if (ctx->deferred != NULL) nvg__deleteDeferred(ctx->deferred);
 	if (ctx->commands != NULL) free(ctx->commands);
 	if (ctx->cache != NULL) nvg__deletePathCache(ctx->cache);
+	for (i = 0; i < NVG_ELLIPSE_LODS; i++)
+		free(ctx->ellipseRings[i]);
+	nvg__clearTextCache(ctx);
+	free(ctx->textCache.lines);
+	free(ctx->textCache.glyphs);
 
 	if (ctx->fs)
 		fonsDeleteInternal(ctx->fs);
@@ -402,24 +599,64 @@ void nvgBeginFrame(NVGcontext* ctx, int windowWidth, int windowHeight, float dev
 	//nvgSave(ctx);
 	//nvgReset(ctx);	// TODO: remove these lines to maintain graphics state settings across frames (blend, stroke, fill, etc.)
 
+	nvg__flushDeferred(ctx);
+
 	nvg__setDevicePixelRatio(ctx, devicePixelRatio);
 
 	ctx->params.renderViewport(ctx->params.userPtr, windowWidth, windowHeight, devicePixelRatio);
+	ctx->viewWidth = (float)windowWidth;
+	ctx->viewHeight = (float)windowHeight;
 
 	ctx->drawCallCount = 0;
+	ctx->culledCount = 0;
 	ctx->fillTriCount = 0;
 	ctx->strokeTriCount = 0;
 	ctx->textTriCount = 0;
+	ctx->textCacheHits = 0;
+	ctx->textCacheMisses = 0;
+	fonsNextFrame(ctx->fs);
 }
 
 void nvgCancelFrame(NVGcontext* ctx)
 {
+	if (ctx->deferred != NULL) {
+		ctx->deferred->ndraws = 0;
+		ctx->deferred->ncommands = 0;
+		ctx->deferred->pathRecorded = 0;
+	}
 	ctx->params.renderCancel(ctx->params.userPtr);
 }
 
 void nvgEndFrame(NVGcontext* ctx)
 {
+	nvg__flushDeferred(ctx);
 	ctx->params.renderFlush(ctx->params.userPtr);
+
+	memset(&ctx->stats, 0, sizeof(ctx->stats));
+	ctx->stats.drawCalls = ctx->drawCallCount;
+	ctx->stats.fillTriangles = ctx->fillTriCount;
+	ctx->stats.strokeTriangles = ctx->strokeTriCount;
+	ctx->stats.textTriangles = ctx->textTriCount;
+	ctx->stats.culled = ctx->culledCount;
+	ctx->stats.textCacheHits = ctx->textCacheHits;
+	ctx->stats.textCacheMisses = ctx->textCacheMisses;
+	fonsGlyphStats(ctx->fs, &ctx->stats.glyphLookups, &ctx->stats.glyphsRasterized);
+	if (ctx->params.renderGetStats != NULL)
+		ctx->params.renderGetStats(ctx->params.userPtr, &ctx->stats);
+
+	// Evict glyphs that were not used lately once the atlas fills up, everything drawn
+	// with it is flushed so the kept glyphs can move. This keeps a frame from having
+	// to switch to a new atlas halfway through.
+	// Glyphs are kept up to half the area at the threshold, which packs below it. When the
+	// glyphs of this frame alone take more the atlas is left to grow instead.
+	if (ctx->stats.glyphsRasterized > 0 && fonsAtlasUsage(ctx->fs) > NVG_ATLAS_COMPACT_USAGE) {
+		int iw = 0, ih = 0, keepArea;
+		fonsGetAtlasSize(ctx->fs, &iw, &ih);
+		keepArea = (int)(iw*ih * NVG_ATLAS_COMPACT_USAGE * 0.5f);
+		if (fonsFrameGlyphArea(ctx->fs) <= keepArea && fonsCompactAtlas(ctx->fs, iw, ih, keepArea))
+			nvg__clearTextCache(ctx);
+	}
+
 	if (ctx->fontImageIdx != 0) {
 		int fontImage = ctx->fontImages[ctx->fontImageIdx];
 		int i, j, iw, ih;
@@ -447,6 +684,11 @@ void nvgEndFrame(NVGcontext* ctx)
 	}
 }
 
+void nvgFrameStats(NVGcontext* ctx, NVGframeStats* stats)
+{
+	*stats = ctx->stats;
+}
+
 NVGcolor nvgRGB(unsigned char r, unsigned char g, unsigned char b)
 {
 	return nvgRGBA(r,g,b,255);
@@ -878,10 +1120,17 @@ int nvgGetImagePixelsRGBA(NVGcontext* ctx, int image, unsigned char* data)
 void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data)
 {
 	int w, h;
+	nvg__flushDeferred(ctx);
 	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, &w, &h);
 	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, 0,0, w,h, data);
 }
 
+void nvgUpdateImageRect(NVGcontext* ctx, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	nvg__flushDeferred(ctx);
+	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, x,y, w,h, data);
+}
+
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h)
 {
 	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, w, h);
@@ -889,6 +1138,7 @@ void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h)
 
 void nvgDeleteImage(NVGcontext* ctx, int image)
 {
+	nvg__flushDeferred(ctx);
 	ctx->params.renderDeleteTexture(ctx->params.userPtr, image);
 }
 
@@ -1074,6 +1324,71 @@ void nvgResetScissor(NVGcontext* ctx)
 	state->scissor.extent[1] = -1.0f;
 }
 
+static float nvg__getAverageScale(float *t)
+{
+	float sx = sqrtf(t[0]*t[0] + t[2]*t[2]);
+	float sy = sqrtf(t[1]*t[1] + t[3]*t[3]);
+	return (sx + sy) * 0.5f;
+}
+
+int nvgCullRect(NVGcontext* ctx, float x, float y, float w, float h, int stroke)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float* t = state->xform;
+	float minx, miny, maxx, maxy, pad, px, py;
+	float vminx = 0.0f, vminy = 0.0f, vmaxx = ctx->viewWidth, vmaxy = ctx->viewHeight;
+	int i;
+
+	// Nothing to test against before the first frame.
+	if (ctx->viewWidth <= 0.0f || ctx->viewHeight <= 0.0f) return 0;
+
+	// Bounds of the transformed corners.
+	nvgTransformPoint(&minx, &miny, t, x, y);
+	maxx = minx;
+	maxy = miny;
+	for (i = 1; i < 4; i++) {
+		nvgTransformPoint(&px, &py, t, (i & 1) ? x + w : x, (i & 2) ? y + h : y);
+		minx = nvg__minf(minx, px);
+		miny = nvg__minf(miny, py);
+		maxx = nvg__maxf(maxx, px);
+		maxy = nvg__maxf(maxy, py);
+	}
+
+	// Grow by the anti-aliased fringe and the stroke, the stroke width is already in pixels once
+	// scaled, see nvgStroke(). Miter joins can reach miterLimit half widths out, the corners of
+	// square caps on a diagonal line sqrt(2) half widths.
+	pad = ctx->fringeWidth;
+	if (stroke) {
+		float strokeWidth = nvg__clampf(state->strokeWidth * nvg__getAverageScale(t), ctx->fringeWidth, 200.0f);
+		float reach = state->lineJoin == NVG_MITER ? nvg__maxf(state->miterLimit, 1.0f) : 1.0f;
+		if (state->lineCap == NVG_SQUARE)
+			reach = nvg__maxf(reach, 1.41421356f);
+		pad += strokeWidth * 0.5f * reach;
+	}
+	minx -= pad;
+	miny -= pad;
+	maxx += pad;
+	maxy += pad;
+
+	// Bounds of the scissor, it is a rotated rectangle in general.
+	if (state->scissor.extent[0] >= 0.0f && state->scissor.extent[1] >= 0.0f) {
+		float* s = state->scissor.xform;
+		float ex = state->scissor.extent[0], ey = state->scissor.extent[1];
+		float tex = ex*nvg__absf(s[0]) + ey*nvg__absf(s[2]);
+		float tey = ex*nvg__absf(s[1]) + ey*nvg__absf(s[3]);
+		vminx = nvg__maxf(vminx, s[4] - tex);
+		vminy = nvg__maxf(vminy, s[5] - tey);
+		vmaxx = nvg__minf(vmaxx, s[4] + tex);
+		vmaxy = nvg__minf(vmaxy, s[5] + tey);
+	}
+
+	if (maxx <= vminx || maxy <= vminy || minx >= vmaxx || miny >= vmaxy) {
+		ctx->culledCount++;
+		return 1;
+	}
+	return 0;
+}
+
 // Global composite operation.
 void nvgGlobalCompositeOperation(NVGcontext* ctx, int op)
 {
@@ -1123,42 +1438,31 @@ static float nvg__distPtSeg(float x, float y, float px, float py, float qx, floa
 	return dx*dx + dy*dy;
 }
 
-static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
+static void nvg__transformVector(float* x, float* y, const float* t)
 {
-	NVGstate* state = nvg__getState(ctx);
-	int i;
-
-	if (ctx->ncommands+nvals > ctx->ccommands) {
-		float* commands;
-		int ccommands = ctx->ncommands+nvals + ctx->ccommands/2;
-		commands = (float*)realloc(ctx->commands, sizeof(float)*ccommands);
-		if (commands == NULL) return;
-		ctx->commands = commands;
-		ctx->ccommands = ccommands;
-	}
-
-	if ((int)vals[0] != NVG_CLOSE && (int)vals[0] != NVG_WINDING) {
-		ctx->commandx = vals[nvals-2];
-		ctx->commandy = vals[nvals-1];
-	}
+	float vx = *x, vy = *y;
+	*x = vx*t[0] + vy*t[2];
+	*y = vx*t[1] + vy*t[3];
+}
 
-	// transform commands
-	i = 0;
+static void nvg__transformCommands(float* vals, int nvals, const float* t)
+{
+	int i = 0;
 	while (i < nvals) {
 		int cmd = (int)vals[i];
 		switch (cmd) {
 		case NVG_MOVETO:
-			nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
+			nvgTransformPoint(&vals[i+1],&vals[i+2], t, vals[i+1],vals[i+2]);
 			i += 3;
 			break;
 		case NVG_LINETO:
-			nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
+			nvgTransformPoint(&vals[i+1],&vals[i+2], t, vals[i+1],vals[i+2]);
 			i += 3;
 			break;
 		case NVG_BEZIERTO:
-			nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
-			nvgTransformPoint(&vals[i+3],&vals[i+4], state->xform, vals[i+3],vals[i+4]);
-			nvgTransformPoint(&vals[i+5],&vals[i+6], state->xform, vals[i+5],vals[i+6]);
+			nvgTransformPoint(&vals[i+1],&vals[i+2], t, vals[i+1],vals[i+2]);
+			nvgTransformPoint(&vals[i+3],&vals[i+4], t, vals[i+3],vals[i+4]);
+			nvgTransformPoint(&vals[i+5],&vals[i+6], t, vals[i+5],vals[i+6]);
 			i += 7;
 			break;
 		case NVG_CLOSE:
@@ -1167,10 +1471,47 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
 		case NVG_WINDING:
 			i += 2;
 			break;
+		case NVG_ELLIPSE:
+			nvgTransformPoint(&vals[i+1],&vals[i+2], t, vals[i+1],vals[i+2]);
+			nvg__transformVector(&vals[i+3],&vals[i+4], t);
+			nvg__transformVector(&vals[i+5],&vals[i+6], t);
+			i += 7;
+			break;
 		default:
 			i++;
 		}
 	}
+}
+
+static int nvg__reserveCommands(NVGcontext* ctx, int nvals)
+{
+	if (ctx->ncommands+nvals > ctx->ccommands) {
+		float* commands;
+		int ccommands = ctx->ncommands+nvals + ctx->ccommands/2;
+		commands = (float*)realloc(ctx->commands, sizeof(float)*ccommands);
+		if (commands == NULL) return 0;
+		ctx->commands = commands;
+		ctx->ccommands = ccommands;
+	}
+	return 1;
+}
+
+static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
+{
+	NVGstate* state = nvg__getState(ctx);
+
+	if (ctx->deferred != NULL)
+		ctx->deferred->pathRecorded = 0;
+
+	if (!nvg__reserveCommands(ctx, nvals)) return;
+
+	if ((int)vals[0] != NVG_CLOSE && (int)vals[0] != NVG_WINDING) {
+		ctx->commandx = vals[nvals-2];
+		ctx->commandy = vals[nvals-1];
+	}
+
+	// transform commands
+	nvg__transformCommands(vals, nvals, state->xform);
 
 	memcpy(&ctx->commands[ctx->ncommands], vals, nvals*sizeof(float));
 
@@ -1257,6 +1598,70 @@ static void nvg__closePath(NVGcontext* ctx)
 	path->closed = 1;
 }
 
+static int nvg__curveDivs(float r, float arc, float tol)
+{
+	float da = acosf(r / (r + tol)) * 2.0f;
+	return nvg__maxi(2, (int)ceilf(arc / da));
+}
+
+static int nvg__ellipseRingSize(int lod)
+{
+	return (lod & 1) ? 12 << (lod >> 1) : 8 << (lod >> 1);
+}
+
+// Returns the unit circle ring of a level, building it on first use. Rings
+// are kept for the lifetime of the context.
+static const float* nvg__ellipseRingLod(NVGcontext* ctx, int lod)
+{
+	if (ctx->ellipseRings[lod] == NULL) {
+		int i, n = nvg__ellipseRingSize(lod);
+		float* ring = (float*)malloc(sizeof(float)*2*n);
+		if (ring == NULL) return NULL;
+		// Same start point and direction as the bezier ellipse: from -x towards +y.
+		for (i = 0; i < n; i++) {
+			float a = NVG_PI - (float)i/(float)n * NVG_PI*2.0f;
+			ring[i*2+0] = nvg__cosf(a);
+			ring[i*2+1] = nvg__sinf(a);
+		}
+		ctx->ellipseRings[lod] = ring;
+	}
+	return ctx->ellipseRings[lod];
+}
+
+// Returns the unit circle ring with enough segments to stay within tessTol
+// for the given screen space radius.
+static const float* nvg__ellipseRing(NVGcontext* ctx, float r, int* count)
+{
+	int lod;
+	int needed = nvg__curveDivs(nvg__clampf(r, 0.0f, 1e5f), NVG_PI*2.0f, ctx->tessTol);
+	for (lod = 0; lod < NVG_ELLIPSE_LODS-1; lod++) {
+		if (nvg__ellipseRingSize(lod) >= needed) break;
+	}
+	*count = nvg__ellipseRingSize(lod);
+	return nvg__ellipseRingLod(ctx, lod);
+}
+
+static void nvg__flattenEllipse(NVGcontext* ctx, const float* e)
+{
+	float cx = e[0], cy = e[1], ax = e[2], ay = e[3], bx = e[4], by = e[5];
+	float r = nvg__maxf(nvg__sqrtf(ax*ax + ay*ay), nvg__sqrtf(bx*bx + by*by));
+	const float* ring;
+	int i, n = 0;
+
+	ring = nvg__ellipseRing(ctx, r, &n);
+	if (ring == NULL) return;
+
+	nvg__addPath(ctx);
+	for (i = 0; i < n; i++) {
+		float c = ring[i*2+0], s = ring[i*2+1];
+		nvg__addPoint(ctx, cx + ax*c + bx*s, cy + ay*c + by*s, 0);
+	}
+	// End on the start point like the bezier version did, so segments added
+	// after the ellipse continue from there. Flattening drops the duplicate.
+	nvg__addPoint(ctx, cx - ax, cy - ay, NVG_PT_CORNER);
+	nvg__closePath(ctx);
+}
+
 static void nvg__pathWinding(NVGcontext* ctx, int winding)
 {
 	NVGpath* path = nvg__lastPath(ctx);
@@ -1264,13 +1669,6 @@ static void nvg__pathWinding(NVGcontext* ctx, int winding)
 	path->winding = winding;
 }
 
-static float nvg__getAverageScale(float *t)
-{
-	float sx = sqrtf(t[0]*t[0] + t[2]*t[2]);
-	float sy = sqrtf(t[1]*t[1] + t[3]*t[3]);
-	return (sx + sy) * 0.5f;
-}
-
 static NVGvertex* nvg__allocTempVerts(NVGcontext* ctx, int nverts)
 {
 	if (nverts > ctx->cache->cverts) {
@@ -1372,6 +1770,318 @@ static void nvg__tesselateBezier(NVGcontext* ctx,
 	nvg__tesselateBezier(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, type);
 }
 
+//
+// Path expansion kernels
+//
+// The per-point work of flattening and stroking (segment directions, join
+// extrusions and the two vertices emitted for every non-beveled point) runs
+// through these kernels. The SSE2 and AVX versions use the same operations
+// in the same order as the scalar code and avoid approximate reciprocals, so
+// they produce bit identical points and vertices. The kernel set is picked
+// from the CPU when the context is created.
+
+static int nvg__joinFlags(NVGpoint* p0, NVGpoint* p1, float iw, float miterLimit, int bevelCorners)
+{
+	float dlx0, dly0, dlx1, dly1, dmr2, cross, limit;
+	dlx0 = p0->dy;
+	dly0 = -p0->dx;
+	dlx1 = p1->dy;
+	dly1 = -p1->dx;
+	// Calculate extrusions
+	p1->dmx = (dlx0 + dlx1) * 0.5f;
+	p1->dmy = (dly0 + dly1) * 0.5f;
+	dmr2 = p1->dmx*p1->dmx + p1->dmy*p1->dmy;
+	if (dmr2 > 0.000001f) {
+		float scale = 1.0f / dmr2;
+		if (scale > 600.0f) {
+			scale = 600.0f;
+		}
+		p1->dmx *= scale;
+		p1->dmy *= scale;
+	}
+
+	// Clear flags, but keep the corner.
+	p1->flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
+
+	// Keep track of left turns.
+	cross = p1->dx * p0->dy - p0->dx * p1->dy;
+	if (cross > 0.0f)
+		p1->flags |= NVG_PT_LEFT;
+
+	// Calculate if we should use bevel or miter for inner join.
+	limit = nvg__maxf(1.01f, nvg__minf(p0->len, p1->len) * iw);
+	if ((dmr2 * limit*limit) < 1.0f)
+		p1->flags |= NVG_PR_INNERBEVEL;
+
+	// Check to see if the corner needs to be beveled.
+	if (p1->flags & NVG_PT_CORNER) {
+		if ((dmr2 * miterLimit*miterLimit) < 1.0f || bevelCorners) {
+			p1->flags |= NVG_PT_BEVEL;
+		}
+	}
+
+	return p1->flags;
+}
+
+static void nvg__segmentsC(NVGpoint* pts, int first, int count, float* bounds)
+{
+	int i;
+	for (i = first; i < count; i++) {
+		NVGpoint* p0 = &pts[i];
+		NVGpoint* p1 = &pts[i+1 < count ? i+1 : 0];
+		// Calculate segment direction and length
+		p0->dx = p1->x - p0->x;
+		p0->dy = p1->y - p0->y;
+		p0->len = nvg__normalize(&p0->dx, &p0->dy);
+		// Update bounds
+		bounds[0] = nvg__minf(bounds[0], p0->x);
+		bounds[1] = nvg__minf(bounds[1], p0->y);
+		bounds[2] = nvg__maxf(bounds[2], p0->x);
+		bounds[3] = nvg__maxf(bounds[3], p0->y);
+	}
+}
+
+// Joins point j of a path with the previous one, returns 1 if it needs bevel vertices.
+static int nvg__joinPoint(NVGpoint* pts, int j, int count, float iw, float miterLimit, int bevelCorners, int* nleft)
+{
+	int flags = nvg__joinFlags(&pts[j > 0 ? j-1 : count-1], &pts[j], iw, miterLimit, bevelCorners);
+	if (flags & NVG_PT_LEFT)
+		(*nleft)++;
+	return (flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0;
+}
+
+static int nvg__joinsC(NVGpoint* pts, int first, int count, float iw, float miterLimit, int bevelCorners, int* nleft)
+{
+	int j, nbevel = 0;
+	for (j = first; j < count; j++)
+		nbevel += nvg__joinPoint(pts, j, count, iw, miterLimit, bevelCorners, nleft);
+	return nbevel;
+}
+
+#ifndef NVG_SIMD_X86
+static NVGvertex* nvg__extrudeC(NVGvertex* dst, const NVGpoint* p, int count, float lw, float rw, float lu, float ru)
+{
+	int i;
+	for (i = 0; i < count; i++, p++) {
+		nvg__vset(dst, p->x + (p->dmx * lw), p->y + (p->dmy * lw), lu,1); dst++;
+		nvg__vset(dst, p->x - (p->dmx * rw), p->y - (p->dmy * rw), ru,1); dst++;
+	}
+	return dst;
+}
+
+static const NVGkernels nvg__kernelsC = { nvg__segmentsC, nvg__joinsC, nvg__extrudeC };
+#endif
+
+#ifdef NVG_SIMD_X86
+
+// Applies the per-lane join results to the point flags, like nvg__joinFlags does.
+static int nvg__joinMasks(NVGpoint* p, int n, int left, int inner, int miter, int* nleft)
+{
+	int k, nbevel = 0;
+	for (k = 0; k < n; k++, p++) {
+		int flags = (p->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
+		if (left & (1 << k)) {
+			flags |= NVG_PT_LEFT;
+			(*nleft)++;
+		}
+		if (inner & (1 << k))
+			flags |= NVG_PR_INNERBEVEL;
+		if ((flags & NVG_PT_CORNER) && (miter & (1 << k)))
+			flags |= NVG_PT_BEVEL;
+		if ((flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+			nbevel++;
+		p->flags = (unsigned char)flags;
+	}
+	return nbevel;
+}
+
+static void nvg__segmentsSSE2(NVGpoint* pts, int first, int count, float* bounds)
+{
+	__m128 mnx = _mm_set1_ps(bounds[0]), mny = _mm_set1_ps(bounds[1]);
+	__m128 mxx = _mm_set1_ps(bounds[2]), mxy = _mm_set1_ps(bounds[3]);
+	const __m128 eps = _mm_set1_ps(1e-6f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	float b[4][4];
+	int i, k;
+
+	// Blocks of four, as long as the next point does not wrap around.
+	for (i = first; i + 4 < count; i += 4) {
+		__m128 x = _mm_loadu_ps(&pts[i].x), y = _mm_loadu_ps(&pts[i+1].x);
+		__m128 r2 = _mm_loadu_ps(&pts[i+2].x), r3 = _mm_loadu_ps(&pts[i+3].x);
+		__m128 nx = _mm_loadu_ps(&pts[i+1].x), ny = _mm_loadu_ps(&pts[i+2].x);
+		__m128 n2 = _mm_loadu_ps(&pts[i+3].x), n3 = _mm_loadu_ps(&pts[i+4].x);
+		__m128 dx, dy, d, id, m, len;
+		_MM_TRANSPOSE4_PS(x, y, r2, r3);
+		_MM_TRANSPOSE4_PS(nx, ny, n2, n3);
+
+		dx = _mm_sub_ps(nx, x);
+		dy = _mm_sub_ps(ny, y);
+		d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+		m = _mm_cmpgt_ps(d, eps);
+		id = _mm_div_ps(one, d);
+		dx = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(dx, id)), _mm_andnot_ps(m, dx));
+		dy = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(dy, id)), _mm_andnot_ps(m, dy));
+		len = d;
+
+		mnx = _mm_min_ps(mnx, x);
+		mny = _mm_min_ps(mny, y);
+		mxx = _mm_max_ps(mxx, x);
+		mxy = _mm_max_ps(mxy, y);
+
+		r2 = len;
+		r3 = zero;
+		_MM_TRANSPOSE4_PS(dx, dy, r2, r3);
+		_mm_storel_pi((__m64*)&pts[i+0].dx, dx); _mm_store_ss(&pts[i+0].len, _mm_movehl_ps(dx, dx));
+		_mm_storel_pi((__m64*)&pts[i+1].dx, dy); _mm_store_ss(&pts[i+1].len, _mm_movehl_ps(dy, dy));
+		_mm_storel_pi((__m64*)&pts[i+2].dx, r2); _mm_store_ss(&pts[i+2].len, _mm_movehl_ps(r2, r2));
+		_mm_storel_pi((__m64*)&pts[i+3].dx, r3); _mm_store_ss(&pts[i+3].len, _mm_movehl_ps(r3, r3));
+	}
+
+	_mm_storeu_ps(b[0], mnx);
+	_mm_storeu_ps(b[1], mny);
+	_mm_storeu_ps(b[2], mxx);
+	_mm_storeu_ps(b[3], mxy);
+	for (k = 0; k < 4; k++) {
+		bounds[0] = nvg__minf(bounds[0], b[0][k]);
+		bounds[1] = nvg__minf(bounds[1], b[1][k]);
+		bounds[2] = nvg__maxf(bounds[2], b[2][k]);
+		bounds[3] = nvg__maxf(bounds[3], b[3][k]);
+	}
+
+	nvg__segmentsC(pts, i, count, bounds);
+}
+
+static int nvg__joinsSSE2(NVGpoint* pts, int first, int count, float iw, float miterLimit, int bevelCorners, int* nleft)
+{
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 eps = _mm_set1_ps(0.000001f);
+	const __m128 maxScale = _mm_set1_ps(600.0f);
+	const __m128 minLimit = _mm_set1_ps(1.01f);
+	const __m128 viw = _mm_set1_ps(iw);
+	const __m128 vml = _mm_set1_ps(miterLimit);
+	int j, nbevel = 0;
+
+	// The first point joins with the last one, do it separately.
+	if (first == 0 && count > 0) {
+		nbevel += nvg__joinPoint(pts, 0, count, iw, miterLimit, bevelCorners, nleft);
+		first = 1;
+	}
+
+	for (j = first; j + 4 <= count; j += 4) {
+		// Rows start at y, so they do not overlap the extrusions stored for the previous block.
+		__m128 y1 = _mm_loadu_ps(&pts[j].y), dx1 = _mm_loadu_ps(&pts[j+1].y);
+		__m128 dy1 = _mm_loadu_ps(&pts[j+2].y), len1 = _mm_loadu_ps(&pts[j+3].y);
+		__m128 y0 = _mm_loadu_ps(&pts[j-1].y), dx0 = _mm_loadu_ps(&pts[j].y);
+		__m128 dy0 = _mm_loadu_ps(&pts[j+1].y), len0 = _mm_loadu_ps(&pts[j+2].y);
+		__m128 dmx, dmy, dmr2, scale, m, cross, limit;
+		_MM_TRANSPOSE4_PS(y1, dx1, dy1, len1);
+		_MM_TRANSPOSE4_PS(y0, dx0, dy0, len0);
+
+		// dl = (dy, -dx)
+		dmx = _mm_mul_ps(_mm_add_ps(dy0, dy1), half);
+		dmy = _mm_mul_ps(_mm_add_ps(_mm_xor_ps(dx0, sign), _mm_xor_ps(dx1, sign)), half);
+		dmr2 = _mm_add_ps(_mm_mul_ps(dmx, dmx), _mm_mul_ps(dmy, dmy));
+		m = _mm_cmpgt_ps(dmr2, eps);
+		scale = _mm_min_ps(_mm_div_ps(one, dmr2), maxScale);
+		dmx = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(dmx, scale)), _mm_andnot_ps(m, dmx));
+		dmy = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(dmy, scale)), _mm_andnot_ps(m, dmy));
+
+		_mm_storel_pi((__m64*)&pts[j+0].dmx, _mm_unpacklo_ps(dmx, dmy));
+		_mm_storeh_pi((__m64*)&pts[j+1].dmx, _mm_unpacklo_ps(dmx, dmy));
+		_mm_storel_pi((__m64*)&pts[j+2].dmx, _mm_unpackhi_ps(dmx, dmy));
+		_mm_storeh_pi((__m64*)&pts[j+3].dmx, _mm_unpackhi_ps(dmx, dmy));
+
+		cross = _mm_sub_ps(_mm_mul_ps(dx1, dy0), _mm_mul_ps(dx0, dy1));
+		limit = _mm_max_ps(minLimit, _mm_mul_ps(_mm_min_ps(len0, len1), viw));
+		nbevel += nvg__joinMasks(&pts[j], 4,
+			_mm_movemask_ps(_mm_cmpgt_ps(cross, _mm_setzero_ps())),
+			_mm_movemask_ps(_mm_cmplt_ps(_mm_mul_ps(_mm_mul_ps(dmr2, limit), limit), one)),
+			bevelCorners ? 0xf : _mm_movemask_ps(_mm_cmplt_ps(_mm_mul_ps(_mm_mul_ps(dmr2, vml), vml), one)),
+			nleft);
+	}
+
+	return nbevel + nvg__joinsC(pts, j, count, iw, miterLimit, bevelCorners, nleft);
+}
+
+static NVGvertex* nvg__extrudeSSE2(NVGvertex* dst, const NVGpoint* p, int count, float lw, float rw, float lu, float ru)
+{
+	// Left and right vertex of a point are p + dm*lw and p + dm*-rw.
+	const __m128 w = _mm_setr_ps(lw, lw, -rw, -rw);
+	const __m128 uv = _mm_setr_ps(lu, 1.0f, ru, 1.0f);
+	int i;
+	for (i = 0; i < count; i++, p++) {
+		__m128 xy = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&p->x);
+		__m128 dm = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&p->dmx);
+		__m128 v = _mm_add_ps(_mm_movelh_ps(xy, xy), _mm_mul_ps(_mm_movelh_ps(dm, dm), w));
+		_mm_storeu_ps(&dst[0].x, _mm_movelh_ps(v, uv));
+		_mm_storeu_ps(&dst[1].x, _mm_movehl_ps(uv, v));
+		dst += 2;
+	}
+	return dst;
+}
+
+static const NVGkernels nvg__kernelsSSE2 = { nvg__segmentsSSE2, nvg__joinsSSE2, nvg__extrudeSSE2 };
+
+#ifndef NVG_NO_AVX
+static NVG_TARGET_AVX NVGvertex* nvg__extrudeAVX(NVGvertex* dst, const NVGpoint* p, int count, float lw, float rw, float lu, float ru)
+{
+	// Both vertices of a point in one register: p + dm*lw and p + dm*-rw, then u and v.
+	const __m256 w = _mm256_setr_ps(lw, lw, lw, lw, -rw, -rw, -rw, -rw);
+	const __m256 uv = _mm256_setr_ps(0.0f, 0.0f, lu, 1.0f, 0.0f, 0.0f, ru, 1.0f);
+	int i;
+	for (i = 0; i < count; i++, p++) {
+		__m128 xy = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&p->x);
+		__m128 dm = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&p->dmx);
+		__m256 vxy, vdm;
+		xy = _mm_movelh_ps(xy, xy);
+		dm = _mm_movelh_ps(dm, dm);
+		vxy = _mm256_insertf128_ps(_mm256_castps128_ps256(xy), xy, 1);
+		vdm = _mm256_insertf128_ps(_mm256_castps128_ps256(dm), dm, 1);
+		_mm256_storeu_ps(&dst->x, _mm256_blend_ps(_mm256_add_ps(vxy, _mm256_mul_ps(vdm, w)), uv, 0xcc));
+		dst += 2;
+	}
+	_mm256_zeroupper();
+	return dst;
+}
+
+// Segments and joins gather fields from several points per lane, which
+// costs more at eight lanes than the wider math saves, so they stay SSE2.
+static const NVGkernels nvg__kernelsAVX = { nvg__segmentsSSE2, nvg__joinsSSE2, nvg__extrudeAVX };
+
+static int nvg__cpuHasAVX(void)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	// AVX and OSXSAVE, then check that the OS saves the YMM registers.
+	if ((info[2] & (1 << 28)) == 0 || (info[2] & (1 << 27)) == 0)
+		return 0;
+	return (_xgetbv(0) & 6) == 6;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx");
+#endif
+}
+#endif // NVG_NO_AVX
+
+#endif // NVG_SIMD_X86
+
+static const NVGkernels* nvg__selectKernels(void)
+{
+#ifdef NVG_SIMD_X86
+#ifndef NVG_NO_AVX
+	if (nvg__cpuHasAVX())
+		return &nvg__kernelsAVX;
+#endif
+	return &nvg__kernelsSSE2;
+#else
+	return &nvg__kernelsC;
+#endif
+}
+
 static void nvg__flattenPaths(NVGcontext* ctx)
 {
 	NVGpathCache* cache = ctx->cache;
@@ -1424,6 +2134,10 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 			nvg__pathWinding(ctx, (int)ctx->commands[i+1]);
 			i += 2;
 			break;
+		case NVG_ELLIPSE:
+			nvg__flattenEllipse(ctx, &ctx->commands[i+1]);
+			i += 7;
+			break;
 		default:
 			i++;
 		}
@@ -1455,28 +2169,11 @@ static void nvg__flattenPaths(NVGcontext* ctx)
 				nvg__polyReverse(pts, path->count);
 		}
 
-		for(i = 0; i < path->count; i++) {
-			// Calculate segment direction and length
-			p0->dx = p1->x - p0->x;
-			p0->dy = p1->y - p0->y;
-			p0->len = nvg__normalize(&p0->dx, &p0->dy);
-			// Update bounds
-			cache->bounds[0] = nvg__minf(cache->bounds[0], p0->x);
-			cache->bounds[1] = nvg__minf(cache->bounds[1], p0->y);
-			cache->bounds[2] = nvg__maxf(cache->bounds[2], p0->x);
-			cache->bounds[3] = nvg__maxf(cache->bounds[3], p0->y);
-			// Advance
-			p0 = p1++;
-		}
+		// Calculate segment direction and length, update bounds.
+		ctx->kernels->segments(pts, 0, path->count, cache->bounds);
 	}
 }
 
-static int nvg__curveDivs(float r, float arc, float tol)
-{
-	float da = acosf(r / (r + tol)) * 2.0f;
-	return nvg__maxi(2, (int)ceilf(arc / da));
-}
-
 static void nvg__chooseBevel(int bevel, NVGpoint* p0, NVGpoint* p1, float w,
 							float* x0, float* y0, float* x1, float* y1)
 {
@@ -1701,10 +2398,19 @@ static NVGvertex* nvg__roundCapEnd(NVGvertex* dst, NVGpoint* p,
 }
 
 
+// Number of points from p on, at most max, that need no bevel vertices.
+static int nvg__miterRun(const NVGpoint* p, int max)
+{
+	int n = 1;
+	while (n < max && (p[n].flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) == 0)
+		n++;
+	return n;
+}
+
 static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float miterLimit)
 {
 	NVGpathCache* cache = ctx->cache;
-	int i, j;
+	int i;
 	float iw = 0.0f;
 
 	if (w > 0.0f) iw = 1.0f / w;
@@ -1713,62 +2419,13 @@ static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float mi
 	for (i = 0; i < cache->npaths; i++) {
 		NVGpath* path = &cache->paths[i];
 		NVGpoint* pts = &cache->points[path->first];
-		NVGpoint* p0 = &pts[path->count-1];
-		NVGpoint* p1 = &pts[0];
 		int nleft = 0;
 
-		path->nbevel = 0;
-
-		for (j = 0; j < path->count; j++) {
-			float dlx0, dly0, dlx1, dly1, dmr2, cross, limit;
-			dlx0 = p0->dy;
-			dly0 = -p0->dx;
-			dlx1 = p1->dy;
-			dly1 = -p1->dx;
-			// Calculate extrusions
-			p1->dmx = (dlx0 + dlx1) * 0.5f;
-			p1->dmy = (dly0 + dly1) * 0.5f;
-			dmr2 = p1->dmx*p1->dmx + p1->dmy*p1->dmy;
-			if (dmr2 > 0.000001f) {
-				float scale = 1.0f / dmr2;
-				if (scale > 600.0f) {
-					scale = 600.0f;
-				}
-				p1->dmx *= scale;
-				p1->dmy *= scale;
-			}
-
-			// Clear flags, but keep the corner.
-			p1->flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
-
-			// Keep track of left turns.
-			cross = p1->dx * p0->dy - p0->dx * p1->dy;
-			if (cross > 0.0f) {
-				nleft++;
-				p1->flags |= NVG_PT_LEFT;
-			}
-
-			// Calculate if we should use bevel or miter for inner join.
-			limit = nvg__maxf(1.01f, nvg__minf(p0->len, p1->len) * iw);
-			if ((dmr2 * limit*limit) < 1.0f)
-				p1->flags |= NVG_PR_INNERBEVEL;
-
-			// Check to see if the corner needs to be beveled.
-			if (p1->flags & NVG_PT_CORNER) {
-				if ((dmr2 * miterLimit*miterLimit) < 1.0f || lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND) {
-					p1->flags |= NVG_PT_BEVEL;
-				}
-			}
-
-			if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
-				path->nbevel++;
-
-			p0 = p1++;
-		}
-
-		path->convex = (nleft == path->count) ? 1 : 0;
-	}
-}
+		path->nbevel = ctx->kernels->joins(pts, 0, path->count, iw, miterLimit,
+										   lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND, &nleft);
+		path->convex = (nleft == path->count) ? 1 : 0;
+	}
+}
 
 
 static int nvg__expandStroke(NVGcontext* ctx, float w, float fringe, int lineCap, int lineJoin, float miterLimit)
@@ -1856,18 +2513,23 @@ static int nvg__expandStroke(NVGcontext* ctx, float w, float fringe, int lineCap
 				dst = nvg__roundCapStart(dst, p0, dx, dy, w, ncap, aa, u0, u1);
 		}
 
-		for (j = s; j < e; ++j) {
+		for (j = s; j < e; ) {
 			if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0) {
 				if (lineJoin == NVG_ROUND) {
 					dst = nvg__roundJoin(dst, p0, p1, w, w, u0, u1, ncap, aa);
 				} else {
 					dst = nvg__bevelJoin(dst, p0, p1, w, w, u0, u1, aa);
 				}
+				p0 = p1++;
+				j++;
 			} else {
-				nvg__vset(dst, p1->x + (p1->dmx * w), p1->y + (p1->dmy * w), u0,1); dst++;
-				nvg__vset(dst, p1->x - (p1->dmx * w), p1->y - (p1->dmy * w), u1,1); dst++;
+				// Extrude the whole run of mitered points at once.
+				int n = nvg__miterRun(p1, e - j);
+				dst = ctx->kernels->extrude(dst, p1, n, w, w, u0, u1);
+				p1 += n;
+				p0 = p1 - 1;
+				j += n;
 			}
-			p0 = p1++;
 		}
 
 		if (loop) {
@@ -1990,14 +2652,18 @@ static int nvg__expandFill(NVGcontext* ctx, float w, int lineJoin, float miterLi
 			p0 = &pts[path->count-1];
 			p1 = &pts[0];
 
-			for (j = 0; j < path->count; ++j) {
+			for (j = 0; j < path->count; ) {
 				if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0) {
 					dst = nvg__bevelJoin(dst, p0, p1, lw, rw, lu, ru, ctx->fringeWidth);
+					p0 = p1++;
+					j++;
 				} else {
-					nvg__vset(dst, p1->x + (p1->dmx * lw), p1->y + (p1->dmy * lw), lu,1); dst++;
-					nvg__vset(dst, p1->x - (p1->dmx * rw), p1->y - (p1->dmy * rw), ru,1); dst++;
+					int n = nvg__miterRun(p1, path->count - j);
+					dst = ctx->kernels->extrude(dst, p1, n, lw, rw, lu, ru);
+					p1 += n;
+					p0 = p1 - 1;
+					j += n;
 				}
-				p0 = p1++;
 			}
 
 			// Loop it
@@ -2021,6 +2687,8 @@ void nvgBeginPath(NVGcontext* ctx)
 {
 	ctx->ncommands = 0;
 	nvg__clearPathCache(ctx);
+	if (ctx->deferred != NULL)
+		ctx->deferred->pathRecorded = 0;
 }
 
 void nvgMoveTo(NVGcontext* ctx, float x, float y)
@@ -2035,6 +2703,41 @@ void nvgLineTo(NVGcontext* ctx, float x, float y)
 	nvg__appendCommands(ctx, vals, NVG_COUNTOF(vals));
 }
 
+void nvgPolyline(NVGcontext* ctx, const float* xy, int count)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float* vals;
+	int i;
+
+	if (count < 1) return;
+
+	if (ctx->deferred != NULL)
+		ctx->deferred->pathRecorded = 0;
+
+	if (!nvg__reserveCommands(ctx, count*3)) return;
+
+	// The flattened path has at most one point per command, growing the cache up front avoids
+	// reallocating it point by point in nvg__flattenPaths().
+	if (ctx->cache->npoints + count > ctx->cache->cpoints) {
+		int cpoints = ctx->cache->npoints + count + ctx->cache->cpoints/2;
+		NVGpoint* points = (NVGpoint*)realloc(ctx->cache->points, sizeof(NVGpoint)*cpoints);
+		if (points != NULL) {
+			ctx->cache->points = points;
+			ctx->cache->cpoints = cpoints;
+		}
+	}
+
+	// Same commands as nvgMoveTo() followed by nvgLineTo() for each other point, written in place.
+	vals = &ctx->commands[ctx->ncommands];
+	for (i = 0; i < count; i++) {
+		vals[i*3] = i == 0 ? NVG_MOVETO : NVG_LINETO;
+		nvgTransformPoint(&vals[i*3+1], &vals[i*3+2], state->xform, xy[i*2+0], xy[i*2+1]);
+	}
+	ctx->commandx = xy[count*2-2];
+	ctx->commandy = xy[count*2-1];
+	ctx->ncommands += count*3;
+}
+
 void nvgBezierTo(NVGcontext* ctx, float c1x, float c1y, float c2x, float c2y, float x, float y)
 {
 	float vals[] = { NVG_BEZIERTO, c1x, c1y, c2x, c2y, x, y };
@@ -2232,15 +2935,12 @@ void nvgRoundedRectVarying(NVGcontext* ctx, float x, float y, float w, float h,
 
 void nvgEllipse(NVGcontext* ctx, float cx, float cy, float rx, float ry)
 {
-	float vals[] = {
-		NVG_MOVETO, cx-rx, cy,
-		NVG_BEZIERTO, cx-rx, cy+ry*NVG_KAPPA90, cx-rx*NVG_KAPPA90, cy+ry, cx, cy+ry,
-		NVG_BEZIERTO, cx+rx*NVG_KAPPA90, cy+ry, cx+rx, cy+ry*NVG_KAPPA90, cx+rx, cy,
-		NVG_BEZIERTO, cx+rx, cy-ry*NVG_KAPPA90, cx+rx*NVG_KAPPA90, cy-ry, cx, cy-ry,
-		NVG_BEZIERTO, cx-rx*NVG_KAPPA90, cy-ry, cx-rx, cy-ry*NVG_KAPPA90, cx-rx, cy,
-		NVG_CLOSE
-	};
+	// Recorded as center and axes so the ring resolution is picked from the
+	// final screen size when the path is flattened.
+	float vals[] = { NVG_ELLIPSE, cx, cy, rx, 0.0f, 0.0f, ry };
 	nvg__appendCommands(ctx, vals, NVG_COUNTOF(vals));
+	ctx->commandx = cx-rx;
+	ctx->commandy = cy;
 }
 
 void nvgCircle(NVGcontext* ctx, float cx, float cy, float r)
@@ -2284,12 +2984,406 @@ void nvgDebugDumpPathCache(NVGcontext* ctx)
 	}
 }
 
+// Applies the global tint and alpha to a paint.
+static void nvg__applyTintAndAlpha(NVGstate* state, NVGpaint* paint)
+{
+	paint->innerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
+	paint->innerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
+	paint->innerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
+	paint->outerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
+	paint->outerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
+	paint->outerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
+
+	paint->innerColor.a *= state->alpha;
+	paint->outerColor.a *= state->alpha;
+}
+
+//
+// Deferred tessellation
+//
+// Fills and strokes only copy the path commands and render state into a list.
+// The list is flattened and expanded by a pool of threads, each with its own
+// scratch path cache, then handed to the renderer in recorded order. Anything
+// else that reaches the renderer flushes the list first, so draw order is kept.
+
+static void nvg__countFill(NVGcontext* ctx, const NVGpath* paths, int npaths)
+{
+	int i;
+	for (i = 0; i < npaths; i++) {
+		ctx->fillTriCount += paths[i].nfill-2;
+		ctx->fillTriCount += paths[i].nstroke-2;
+		ctx->drawCallCount += 2;
+	}
+}
+
+static void nvg__countStroke(NVGcontext* ctx, const NVGpath* paths, int npaths)
+{
+	int i;
+	for (i = 0; i < npaths; i++) {
+		ctx->strokeTriCount += paths[i].nstroke-2;
+		ctx->drawCallCount++;
+	}
+}
+
+static int nvg__reservePathBuffer(NVGpathBuffer* buf, int npaths, int nverts)
+{
+	if (buf->npaths+npaths > buf->cpaths) {
+		int cpaths = buf->npaths+npaths + buf->cpaths/2;
+		NVGpath* paths = (NVGpath*)realloc(buf->paths, sizeof(NVGpath)*cpaths);
+		int* offsets;
+		if (paths == NULL) return 0;
+		buf->paths = paths;
+		offsets = (int*)realloc(buf->offsets, sizeof(int)*2*cpaths);
+		if (offsets == NULL) return 0;
+		buf->offsets = offsets;
+		buf->cpaths = cpaths;
+	}
+	if (buf->nverts+nverts > buf->cverts) {
+		int cverts = buf->nverts+nverts + buf->cverts/2;
+		NVGvertex* verts = (NVGvertex*)realloc(buf->verts, sizeof(NVGvertex)*cverts);
+		if (verts == NULL) return 0;
+		buf->verts = verts;
+		buf->cverts = cverts;
+	}
+	return 1;
+}
+
+// Appends vertices, the buffer must have room for them. Returns their offset, -1 for none.
+static int nvg__pathBufferVerts(NVGpathBuffer* buf, const NVGvertex* src, int n)
+{
+	int offset = buf->nverts;
+	if (src == NULL || n <= 0) return -1;
+	memcpy(&buf->verts[offset], src, sizeof(NVGvertex)*n);
+	buf->nverts += n;
+	return offset;
+}
+
+// Copies paths and their vertices. Returns the index of the first path, -1 on failure.
+static int nvg__pathBufferPaths(NVGpathBuffer* buf, const NVGpath* paths, int npaths)
+{
+	int i, first = buf->npaths, nverts = 0;
+
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nfill + paths[i].nstroke;
+	if (!nvg__reservePathBuffer(buf, npaths, nverts)) return -1;
+
+	for (i = 0; i < npaths; i++) {
+		buf->offsets[buf->npaths*2+0] = nvg__pathBufferVerts(buf, paths[i].fill, paths[i].nfill);
+		buf->offsets[buf->npaths*2+1] = nvg__pathBufferVerts(buf, paths[i].stroke, paths[i].nstroke);
+		buf->paths[buf->npaths++] = paths[i];
+	}
+	return first;
+}
+
+static void nvg__resolvePathBuffer(NVGpathBuffer* buf)
+{
+	int i;
+	for (i = 0; i < buf->npaths; i++) {
+		buf->paths[i].fill = buf->offsets[i*2+0] < 0 ? NULL : &buf->verts[buf->offsets[i*2+0]];
+		buf->paths[i].stroke = buf->offsets[i*2+1] < 0 ? NULL : &buf->verts[buf->offsets[i*2+1]];
+	}
+}
+
+static void nvg__clearPathBuffer(NVGpathBuffer* buf)
+{
+	buf->npaths = 0;
+	buf->nverts = 0;
+}
+
+static void nvg__freePathBuffer(NVGpathBuffer* buf)
+{
+	free(buf->paths);
+	free(buf->offsets);
+	free(buf->verts);
+}
+
+static void nvg__tessellateDeferred(NVGdeferWorker* w, int index, NVGdeferredDraw* d, int reusePoints)
+{
+	NVGcontext* ctx = w->scratch;
+	NVGpathCache* cache = ctx->cache;
+	int first;
+
+	// A fill and a stroke of the same path share the flattened points, like in immediate mode.
+	if (!reusePoints)
+		nvg__clearPathCache(ctx);
+	ctx->commands = w->def->commands + d->firstCommand;
+	ctx->ncommands = d->ncommands;
+
+	nvg__flattenPaths(ctx);
+	if (d->kind == NVG_DEFER_FILL)
+		nvg__expandFill(ctx, d->fringe, NVG_MITER, 2.4f);
+	else
+		nvg__expandStroke(ctx, d->strokeWidth*0.5f, d->fringe, d->lineCap, d->lineJoin, d->miterLimit);
+
+	d->worker = index;
+	d->firstPath = 0;
+	d->npaths = 0;
+	memcpy(d->bounds, cache->bounds, sizeof(d->bounds));
+
+	first = nvg__pathBufferPaths(&w->out, cache->paths, cache->npaths);
+	if (first < 0) return;
+	d->firstPath = first;
+	d->npaths = cache->npaths;
+}
+
+static void nvg__runDeferred(NVGdeferred* def, int index)
+{
+	NVGdeferWorker* w = &def->workers[index];
+	for (;;) {
+		int first, end, i;
+		mtx_lock(&def->lock);
+		first = def->nextDraw;
+		def->nextDraw += NVG_DEFER_CHUNK;
+		mtx_unlock(&def->lock);
+		if (first >= def->ndraws) break;
+		end = nvg__mini(first + NVG_DEFER_CHUNK, def->ndraws);
+		for (i = first; i < end; i++) {
+			int reuse = i > first && def->draws[i].firstCommand == def->draws[i-1].firstCommand;
+			nvg__tessellateDeferred(w, index, &def->draws[i], reuse);
+		}
+	}
+}
+
+static int nvg__deferThread(void* arg)
+{
+	NVGdeferWorker* w = (NVGdeferWorker*)arg;
+	NVGdeferred* def = w->def;
+	int index = (int)(w - def->workers);
+	int generation = 0;
+
+	mtx_lock(&def->lock);
+	for (;;) {
+		while (def->generation == generation && !def->quit)
+			cnd_wait(&def->wake, &def->lock);
+		if (def->quit) break;
+		generation = def->generation;
+		mtx_unlock(&def->lock);
+
+		nvg__runDeferred(def, index);
+
+		mtx_lock(&def->lock);
+		if (--def->busy == 0)
+			cnd_broadcast(&def->done);
+	}
+	mtx_unlock(&def->lock);
+	return 0;
+}
+
+static void nvg__freeDeferWorker(NVGdeferWorker* w)
+{
+	if (w->scratch != NULL) {
+		nvg__deletePathCache(w->scratch->cache);
+		free(w->scratch);
+		w->scratch = NULL;
+	}
+	nvg__freePathBuffer(&w->out);
+}
+
+static void nvg__deleteDeferred(NVGdeferred* def)
+{
+	int i;
+	if (def->nworkers > 1) {
+		mtx_lock(&def->lock);
+		def->quit = 1;
+		cnd_broadcast(&def->wake);
+		mtx_unlock(&def->lock);
+		for (i = 1; i < def->nworkers; i++)
+			thrd_join(def->workers[i].thread, NULL);
+	}
+	for (i = 0; i < def->nworkers; i++)
+		nvg__freeDeferWorker(&def->workers[i]);
+	cnd_destroy(&def->done);
+	cnd_destroy(&def->wake);
+	mtx_destroy(&def->lock);
+	free(def->workers);
+	free(def->draws);
+	free(def->commands);
+	free(def);
+}
+
+static void nvg__flushDeferred(NVGcontext* ctx)
+{
+	NVGdeferred* def = ctx->deferred;
+	int i;
+
+	if (def == NULL || def->ndraws == 0) return;
+
+	for (i = 0; i < def->nworkers; i++) {
+		NVGcontext* scratch = def->workers[i].scratch;
+		scratch->tessTol = ctx->tessTol;
+		scratch->distTol = ctx->distTol;
+		scratch->fringeWidth = ctx->fringeWidth;
+		scratch->kernels = ctx->kernels;
+		memcpy(scratch->ellipseRings, ctx->ellipseRings, sizeof(ctx->ellipseRings));
+		nvg__clearPathBuffer(&def->workers[i].out);
+	}
+	def->nextDraw = 0;
+
+	// Small lists are not worth waking the other threads for.
+	if (def->nworkers > 1 && def->ndraws > NVG_DEFER_CHUNK) {
+		mtx_lock(&def->lock);
+		def->busy = def->nworkers-1;
+		def->generation++;
+		cnd_broadcast(&def->wake);
+		mtx_unlock(&def->lock);
+
+		nvg__runDeferred(def, 0);
+
+		mtx_lock(&def->lock);
+		while (def->busy > 0)
+			cnd_wait(&def->done, &def->lock);
+		mtx_unlock(&def->lock);
+	} else {
+		nvg__runDeferred(def, 0);
+	}
+
+	for (i = 0; i < def->nworkers; i++)
+		nvg__resolvePathBuffer(&def->workers[i].out);
+
+	// Submit in recorded order.
+	for (i = 0; i < def->ndraws; i++) {
+		NVGdeferredDraw* d = &def->draws[i];
+		const NVGpath* paths = &def->workers[d->worker].out.paths[d->firstPath];
+		if (d->npaths == 0) continue;
+		if (d->kind == NVG_DEFER_FILL) {
+			ctx->params.renderFill(ctx->params.userPtr, &d->paint, d->compositeOperation, &d->scissor, ctx->fringeWidth,
+								   d->bounds, paths, d->npaths);
+			nvg__countFill(ctx, paths, d->npaths);
+		} else {
+			ctx->params.renderStroke(ctx->params.userPtr, &d->paint, d->compositeOperation, &d->scissor, ctx->fringeWidth,
+									 d->strokeWidth, paths, d->npaths);
+			nvg__countStroke(ctx, paths, d->npaths);
+		}
+	}
+
+	def->ndraws = 0;
+	def->ncommands = 0;
+	def->pathRecorded = 0;
+}
+
+static void nvg__deferDraw(NVGcontext* ctx, int kind, const NVGpaint* paint, float strokeWidth)
+{
+	NVGdeferred* def = ctx->deferred;
+	NVGstate* state = nvg__getState(ctx);
+	NVGdeferredDraw* d;
+
+	if (ctx->ncommands == 0) return;
+
+	if (def->ndraws+1 > def->cdraws) {
+		int cdraws = def->ndraws+1 + def->cdraws/2;
+		NVGdeferredDraw* draws = (NVGdeferredDraw*)realloc(def->draws, sizeof(NVGdeferredDraw)*cdraws);
+		if (draws == NULL) return;
+		def->draws = draws;
+		def->cdraws = cdraws;
+	}
+
+	// Filling and stroking the same path records its commands once.
+	if (!def->pathRecorded) {
+		if (def->ncommands+ctx->ncommands > def->ccommands) {
+			int ccommands = def->ncommands+ctx->ncommands + def->ccommands/2;
+			float* commands = (float*)realloc(def->commands, sizeof(float)*ccommands);
+			if (commands == NULL) return;
+			def->commands = commands;
+			def->ccommands = ccommands;
+		}
+		memcpy(&def->commands[def->ncommands], ctx->commands, sizeof(float)*ctx->ncommands);
+		def->pathCommand = def->ncommands;
+		def->ncommands += ctx->ncommands;
+		def->pathRecorded = 1;
+	}
+
+	d = &def->draws[def->ndraws++];
+	memset(d, 0, sizeof(*d));
+	d->kind = kind;
+	d->firstCommand = def->pathCommand;
+	d->ncommands = ctx->ncommands;
+	d->paint = *paint;
+	d->compositeOperation = state->compositeOperation;
+	d->scissor = state->scissor;
+	d->fringe = ctx->params.edgeAntiAlias && state->shapeAntiAlias ? ctx->fringeWidth : 0.0f;
+	d->strokeWidth = strokeWidth;
+	d->lineCap = state->lineCap;
+	d->lineJoin = state->lineJoin;
+	d->miterLimit = state->miterLimit;
+}
+
+int nvgDeferTessellation(NVGcontext* ctx, int threads)
+{
+	NVGdeferred* def;
+	int i;
+
+	if (ctx->deferred != NULL) {
+		nvg__flushDeferred(ctx);
+		nvg__deleteDeferred(ctx->deferred);
+		ctx->deferred = NULL;
+	}
+	if (threads <= 0) return 1;
+
+	// Threads only read the rings, so build them all up front.
+	for (i = 0; i < NVG_ELLIPSE_LODS; i++) {
+		if (nvg__ellipseRingLod(ctx, i) == NULL) return 0;
+	}
+
+	def = (NVGdeferred*)malloc(sizeof(NVGdeferred));
+	if (def == NULL) return 0;
+	memset(def, 0, sizeof(NVGdeferred));
+	mtx_init(&def->lock, mtx_plain);
+	cnd_init(&def->wake);
+	cnd_init(&def->done);
+
+	def->workers = (NVGdeferWorker*)malloc(sizeof(NVGdeferWorker)*threads);
+	if (def->workers == NULL) goto error;
+	memset(def->workers, 0, sizeof(NVGdeferWorker)*threads);
+	for (i = 0; i < threads; i++) {
+		NVGdeferWorker* w = &def->workers[i];
+		w->def = def;
+		w->scratch = (NVGcontext*)malloc(sizeof(NVGcontext));
+		if (w->scratch == NULL) goto error;
+		memset(w->scratch, 0, sizeof(NVGcontext));
+		w->scratch->cache = nvg__allocPathCache();
+		if (w->scratch->cache == NULL) {
+			free(w->scratch);
+			w->scratch = NULL;
+			goto error;
+		}
+	}
+	def->nworkers = threads;
+	for (i = 1; i < threads; i++) {
+		if (thrd_create(&def->workers[i].thread, nvg__deferThread, &def->workers[i]) != thrd_success) {
+			// Keep the threads that did start and free the scratch contexts of the rest.
+			def->nworkers = i;
+			for (; i < threads; i++)
+				nvg__freeDeferWorker(&def->workers[i]);
+			break;
+		}
+	}
+
+	ctx->deferred = def;
+	return 1;
+
+error:
+	// No thread was started yet, only the scratch contexts need freeing.
+	if (def->workers != NULL) {
+		for (i = 0; i < threads; i++)
+			nvg__freeDeferWorker(&def->workers[i]);
+	}
+	nvg__deleteDeferred(def);
+	return 0;
+}
+
 void nvgFillInternal(NVGcontext* ctx, int useStrokePaint)
 {
 	NVGstate* state = nvg__getState(ctx);
-	const NVGpath* path;
 	NVGpaint fillPaint = useStrokePaint ? state->stroke : state->fill;
-	int i;
+
+	nvg__applyTintAndAlpha(state, &fillPaint);
+	fillPaint.textureFilterMode = state->textureFilterMode;
+	fillPaint.textureWrapMode = state->textureWrapMode;
+
+	if (ctx->deferred != NULL) {
+		nvg__deferDraw(ctx, NVG_DEFER_FILL, &fillPaint, 0.0f);
+		return;
+	}
 
 	nvg__flattenPaths(ctx);
 	if (ctx->params.edgeAntiAlias && state->shapeAntiAlias)
@@ -2297,30 +3391,11 @@ void nvgFillInternal(NVGcontext* ctx, int useStrokePaint)
 	else
 		nvg__expandFill(ctx, 0.0f, NVG_MITER, 2.4f);
 
-	// Apply global tint
-	fillPaint.innerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	fillPaint.innerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	fillPaint.innerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
-	fillPaint.outerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	fillPaint.outerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	fillPaint.outerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
-
-	// Apply global alpha
-	fillPaint.innerColor.a *= state->alpha;
-	fillPaint.outerColor.a *= state->alpha;
-	fillPaint.textureFilterMode = state->textureFilterMode;
-	fillPaint.textureWrapMode = state->textureWrapMode;
-
 	ctx->params.renderFill(ctx->params.userPtr, &fillPaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
 						   ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
 
 	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->fillTriCount += path->nfill-2;
-		ctx->fillTriCount += path->nstroke-2;
-		ctx->drawCallCount += 2;
-	}
+	nvg__countFill(ctx, ctx->cache->paths, ctx->cache->npaths);
 }
 
 void nvgFill(NVGcontext* ctx)
@@ -2339,8 +3414,6 @@ void nvgStroke(NVGcontext* ctx)
 	float scale = nvg__getAverageScale(state->xform);
 	float strokeWidth = nvg__clampf(state->strokeWidth * scale, 0.0f, 200.0f);
 	NVGpaint strokePaint = state->stroke;
-	const NVGpath* path;
-	int i;
 	
 	if (strokeWidth < ctx->fringeWidth) {
 		// If the stroke width is less than pixel size, use alpha to emulate coverage.
@@ -2351,17 +3424,12 @@ void nvgStroke(NVGcontext* ctx)
 		strokeWidth = ctx->fringeWidth;
 	}
 
-	// Apply global tint
-	strokePaint.innerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	strokePaint.innerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	strokePaint.innerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
-	strokePaint.outerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	strokePaint.outerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	strokePaint.outerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
+	nvg__applyTintAndAlpha(state, &strokePaint);
 
-	// Apply global alpha
-	strokePaint.innerColor.a *= state->alpha;
-	strokePaint.outerColor.a *= state->alpha;
+	if (ctx->deferred != NULL) {
+		nvg__deferDraw(ctx, NVG_DEFER_STROKE, &strokePaint, strokeWidth);
+		return;
+	}
 
 	nvg__flattenPaths(ctx);
 
@@ -2374,118 +3442,1084 @@ void nvgStroke(NVGcontext* ctx)
 							 strokeWidth, ctx->cache->paths, ctx->cache->npaths);
 
 	// Count triangles
-	for (i = 0; i < ctx->cache->npaths; i++) {
-		path = &ctx->cache->paths[i];
-		ctx->strokeTriCount += path->nstroke-2;
-		ctx->drawCallCount++;
-	}
+	nvg__countStroke(ctx, ctx->cache->paths, ctx->cache->npaths);
 }
 
-// Add fonts
-int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
+static int nvg__isSolidPaint(const NVGpaint* paint)
 {
-	return fonsAddFont(ctx->fs, name, path);
+	return paint->image == 0 && memcmp(&paint->innerColor, &paint->outerColor, sizeof(NVGcolor)) == 0;
 }
 
-int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
+static NVGcolor nvg__quadColor(NVGstate* state, NVGcolor color)
 {
-	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData);
+	// Apply global tint and alpha
+	color.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
+	color.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
+	color.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
+	color.a *= state->alpha;
+	return color;
 }
 
-int nvgFindFont(NVGcontext* ctx, const char* name)
+static int nvg__quadsSupported(NVGcontext* ctx, NVGstate* state)
 {
-	if (name == NULL) return -1;
-	return fonsGetFontByName(ctx->fs, name);
+	return ctx->params.renderQuads != NULL && (!ctx->params.edgeAntiAlias || state->shapeAntiAlias);
 }
 
-void nvgFreeFont(NVGcontext* ctx, const char* name)
+static int nvg__quadStrokeSupported(NVGstate* state, int shape)
 {
-	FONSfont* font = fons__remFont(ctx->fs, name);
-	fons__freeFont(font);
+	// Quads produce mitered and beveled rect corners.
+	return shape != NVG_QUAD_RECT || state->lineJoin != NVG_ROUND;
 }
 
-int nvgAddFallbackFontId(NVGcontext* ctx, int baseFont, int fallbackFont)
+// Corner style of stroked rect quads. Right angles are beveled when they exceed the miter limit,
+// sqrt(2) is the miter length of a right angle.
+static int nvg__quadJoin(NVGstate* state)
 {
-	if(baseFont == -1 || fallbackFont == -1) return 0;
-	return fonsAddFallbackFont(ctx->fs, baseFont, fallbackFont);
+	return state->lineJoin == NVG_MITER && state->miterLimit >= 1.4143f ? NVG_MITER : NVG_BEVEL;
 }
 
-int nvgAddFallbackFont(NVGcontext* ctx, const char* baseFont, const char* fallbackFont)
+// Returns the stroke width in render space, sub-pixel strokes are widened and faded like in nvgStroke().
+static float nvg__quadStrokeWidth(NVGcontext* ctx, NVGstate* state, float* alpha)
 {
-	return nvgAddFallbackFontId(ctx, nvgFindFont(ctx, baseFont), nvgFindFont(ctx, fallbackFont));
+	float strokeWidth = nvg__clampf(state->strokeWidth * nvg__getAverageScale(state->xform), 0.0f, 200.0f);
+	*alpha = 1.0f;
+	if (strokeWidth < ctx->fringeWidth) {
+		float a = nvg__clampf(strokeWidth / ctx->fringeWidth, 0.0f, 1.0f);
+		*alpha = a*a;
+		strokeWidth = ctx->fringeWidth;
+	}
+	return strokeWidth;
 }
 
-// State setting
-void nvgFontSize(NVGcontext* ctx, float size)
+static void nvg__setQuad(NVGquad* quad, NVGstate* state, int shape, float cx, float cy, float rx, float ry, NVGcolor color, float strokeWidth)
 {
-	NVGstate* state = nvg__getState(ctx);
-	state->fontSize = size;
+	float* t = state->xform;
+	quad->xform[0] = t[0];
+	quad->xform[1] = t[1];
+	quad->xform[2] = t[2];
+	quad->xform[3] = t[3];
+	quad->xform[4] = cx*t[0] + cy*t[2] + t[4];
+	quad->xform[5] = cx*t[1] + cy*t[3] + t[5];
+	quad->extent[0] = rx;
+	quad->extent[1] = ry;
+	quad->color = color;
+	quad->strokeWidth = strokeWidth;
+	quad->shape = shape;
+	quad->lineJoin = strokeWidth > 0.0f ? nvg__quadJoin(state) : NVG_MITER;
 }
 
-void nvgFontBlur(NVGcontext* ctx, float blur)
+static int nvg__flushQuads(NVGcontext* ctx, NVGstate* state, int nquads)
 {
-	NVGstate* state = nvg__getState(ctx);
-	state->fontBlur = blur;
+	if (nquads == 0) return 1;
+	nvg__flushDeferred(ctx);
+	return ctx->params.renderQuads(ctx->params.userPtr, state->compositeOperation, &state->scissor, ctx->fringeWidth, ctx->quads, nquads);
 }
 
-void nvgTextLetterSpacing(NVGcontext* ctx, float spacing)
+int nvgQuad(NVGcontext* ctx, int shape, float cx, float cy, float rx, float ry, int fill, int stroke)
 {
 	NVGstate* state = nvg__getState(ctx);
-	state->letterSpacing = spacing;
-}
+	float strokeWidth, strokeAlpha;
+	int nquads = 0;
 
-void nvgTextLineHeight(NVGcontext* ctx, float lineHeight)
-{
-	NVGstate* state = nvg__getState(ctx);
-	state->lineHeight = lineHeight;
+	if (!nvg__quadsSupported(ctx, state)) return 0;
+
+	// Degenerate shapes are left to the path code, which strokes them as lines.
+	rx = nvg__absf(rx);
+	ry = nvg__absf(ry);
+	if (rx < 1e-6f || ry < 1e-6f) return 0;
+
+	if (fill && !nvg__isSolidPaint(&state->fill)) return 0;
+	if (stroke && (!nvg__isSolidPaint(&state->stroke) || !nvg__quadStrokeSupported(state, shape))) return 0;
+
+	if (fill) {
+		nvg__setQuad(&ctx->quads[nquads++], state, shape, cx, cy, rx, ry, nvg__quadColor(state, state->fill.innerColor), 0.0f);
+	}
+	if (stroke) {
+		NVGcolor color = nvg__quadColor(state, state->stroke.innerColor);
+		strokeWidth = nvg__quadStrokeWidth(ctx, state, &strokeAlpha);
+		color.a *= strokeAlpha;
+		nvg__setQuad(&ctx->quads[nquads++], state, shape, cx, cy, rx, ry, color, strokeWidth);
+	}
+
+	if (!nvg__flushQuads(ctx, state, nquads)) return 0;
+
+	// Count triangles
+	if (fill) ctx->fillTriCount += 2;
+	if (stroke) ctx->strokeTriCount += 2;
+
+	return 1;
 }
 
-void nvgTextAlign(NVGcontext* ctx, int align)
+int nvgQuads(NVGcontext* ctx, int shape, const float* xy, const float* wh, int sizeStride, float align,
+			 const unsigned char* colors, int count, int fill, int stroke)
 {
 	NVGstate* state = nvg__getState(ctx);
-	state->textAlign = align;
+	NVGcolor fillColor, strokeColor;
+	float strokeWidth = 0.0f, strokeAlpha = 1.0f;
+	int i, nquads = 0, done = 0;
+
+	if (!nvg__quadsSupported(ctx, state)) return 0;
+
+	// Per shape colors replace the fill paint, or the stroke paint of stroke only shapes.
+	if (fill && colors == NULL && !nvg__isSolidPaint(&state->fill)) return 0;
+	if (stroke && (!nvg__quadStrokeSupported(state, shape) ||
+		((fill || colors == NULL) && !nvg__isSolidPaint(&state->stroke)))) return 0;
+
+	fillColor = nvg__quadColor(state, state->fill.innerColor);
+	strokeColor = nvg__quadColor(state, state->stroke.innerColor);
+	if (stroke) {
+		strokeWidth = nvg__quadStrokeWidth(ctx, state, &strokeAlpha);
+		strokeColor.a *= strokeAlpha;
+	}
+
+	for (i = 0; i < count; i++) {
+		const float* size = &wh[i*sizeStride];
+		float w = size[0];
+		float h = sizeStride > 1 ? size[1] : size[0];
+		float rx = nvg__absf(w)*0.5f, ry = nvg__absf(h)*0.5f;
+		float cx = xy[i*2+0] + w*align, cy = xy[i*2+1] + h*align;
+
+		// Degenerate shapes are left to the path code, which strokes them as lines.
+		if (rx < 1e-6f || ry < 1e-6f) {
+			if (!nvg__flushQuads(ctx, state, nquads)) return done;
+			return i;
+		}
+
+		if (colors != NULL) {
+			const unsigned char* c = &colors[i*4];
+			NVGcolor color = nvg__quadColor(state, nvgRGBA(c[0], c[1], c[2], c[3]));
+			if (fill) {
+				fillColor = color;
+			} else {
+				strokeColor = color;
+				strokeColor.a *= strokeAlpha;
+			}
+		}
+
+		if (nquads + 2 > NVG_MAX_QUADS) {
+			if (!nvg__flushQuads(ctx, state, nquads)) return done;
+			done = i;
+			nquads = 0;
+		}
+		if (fill) nvg__setQuad(&ctx->quads[nquads++], state, shape, cx, cy, rx, ry, fillColor, 0.0f);
+		if (stroke) nvg__setQuad(&ctx->quads[nquads++], state, shape, cx, cy, rx, ry, strokeColor, strokeWidth);
+
+		// Count triangles
+		if (fill) ctx->fillTriCount += 2;
+		if (stroke) ctx->strokeTriCount += 2;
+	}
+
+	if (!nvg__flushQuads(ctx, state, nquads)) return done;
+
+	return count;
 }
 
-void nvgFontFaceId(NVGcontext* ctx, int font)
+int nvgLines(NVGcontext* ctx, const float* xy, const unsigned char* colors, int count)
 {
 	NVGstate* state = nvg__getState(ctx);
-	state->fontId = font;
+	NVGcolor color;
+	float* t = state->xform;
+	float strokeWidth, strokeAlpha, halfWidth, capLength;
+	int i, nquads = 0, done = 0;
+
+	if (!nvg__quadsSupported(ctx, state)) return 0;
+	if (colors == NULL && !nvg__isSolidPaint(&state->stroke)) return 0;
+	if (state->lineCap == NVG_ROUND) return 0;
+
+	// A butt or square capped segment is a filled rect aligned with the segment. Like nvgStroke()
+	// it is built in render space, so non-uniform scales stretch the segment but not its width.
+	strokeWidth = nvg__quadStrokeWidth(ctx, state, &strokeAlpha);
+	halfWidth = strokeWidth*0.5f;
+	capLength = state->lineCap == NVG_SQUARE ? halfWidth : 0.0f;
+	color = nvg__quadColor(state, state->stroke.innerColor);
+	color.a *= strokeAlpha;
+
+	for (i = 0; i < count; i++) {
+		const float* p = &xy[i*4];
+		float x0 = p[0]*t[0] + p[1]*t[2] + t[4], y0 = p[0]*t[1] + p[1]*t[3] + t[5];
+		float x1 = p[2]*t[0] + p[3]*t[2] + t[4], y1 = p[2]*t[1] + p[3]*t[3] + t[5];
+		float dx = x1 - x0, dy = y1 - y0;
+		float len = nvg__sqrtf(dx*dx + dy*dy);
+		NVGquad* quad;
+
+		if (len < 1e-6f) continue;
+		dx /= len;
+		dy /= len;
+
+		if (colors != NULL) {
+			const unsigned char* c = &colors[i*4];
+			color = nvg__quadColor(state, nvgRGBA(c[0], c[1], c[2], c[3]));
+			color.a *= strokeAlpha;
+		}
+
+		if (nquads + 1 > NVG_MAX_QUADS) {
+			if (!nvg__flushQuads(ctx, state, nquads)) return done;
+			done = i;
+			nquads = 0;
+		}
+
+		// Rotate the shape space onto the segment direction.
+		quad = &ctx->quads[nquads++];
+		quad->xform[0] = dx; quad->xform[1] = dy;
+		quad->xform[2] = -dy; quad->xform[3] = dx;
+		quad->xform[4] = (x0 + x1)*0.5f; quad->xform[5] = (y0 + y1)*0.5f;
+		quad->extent[0] = len*0.5f + capLength;
+		quad->extent[1] = halfWidth;
+		quad->color = color;
+		quad->strokeWidth = 0.0f;
+		quad->shape = NVG_QUAD_RECT;
+		quad->lineJoin = NVG_MITER;
+
+		// Count triangles
+		ctx->strokeTriCount += 2;
+	}
+
+	if (!nvg__flushQuads(ctx, state, nquads)) return done;
+
+	return count;
 }
 
-void nvgFontFace(NVGcontext* ctx, const char* font)
+int nvgPoints(NVGcontext* ctx, const float* xy, const unsigned char* colors, int count)
 {
 	NVGstate* state = nvg__getState(ctx);
-	state->fontId = fonsGetFontByName(ctx->fs, font);
-}
+	NVGcolor color;
+	float halfWidth = state->strokeWidth * 0.5f;
+	int i, shape, nquads = 0, done = 0;
 
-static float nvg__quantize(float a, float d)
-{
-	return ((int)(a / d + 0.5f)) * d;
-}
+	if (!nvg__quadsSupported(ctx, state)) return 0;
+	if (colors == NULL && !nvg__isSolidPaint(&state->stroke)) return 0;
+	if (halfWidth < 1e-6f) return 0;
 
-static float nvg__getFontScale(NVGstate* state)
-{
-	return nvg__minf(nvg__quantize(nvg__getAverageScale(state->xform), 0.01f), 4.0f);
-}
+	// Same shape and placement as nvgPoint(), filled with the stroke paint like nvgFillPoint().
+	shape = state->lineCap == NVG_ROUND ? NVG_QUAD_ELLIPSE : NVG_QUAD_RECT;
+	color = nvg__quadColor(state, state->stroke.innerColor);
 
-static void nvg__flushTextTexture(NVGcontext* ctx)
-{
-	int dirty[4];
+	for (i = 0; i < count; i++) {
+		if (colors != NULL) {
+			const unsigned char* c = &colors[i*4];
+			color = nvg__quadColor(state, nvgRGBA(c[0], c[1], c[2], c[3]));
+		}
 
-	if (fonsValidateTexture(ctx->fs, dirty)) {
-		int fontImage = ctx->fontImages[ctx->fontImageIdx];
-		// Update texture
-		if (fontImage != 0) {
-			int iw, ih;
-			const unsigned char* data = fonsGetTextureData(ctx->fs, &iw, &ih);
-			int x = dirty[0];
-			int y = dirty[1];
-			int w = dirty[2] - dirty[0];
-			int h = dirty[3] - dirty[1];
-			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+		if (nquads + 1 > NVG_MAX_QUADS) {
+			if (!nvg__flushQuads(ctx, state, nquads)) return done;
+			done = i;
+			nquads = 0;
 		}
+		nvg__setQuad(&ctx->quads[nquads++], state, shape, xy[i*2+0] + 0.5f, xy[i*2+1] + 0.5f, halfWidth, halfWidth, color, 0.0f);
+
+		// Count triangles
+		ctx->fillTriCount += 2;
 	}
-}
+
+	if (!nvg__flushQuads(ctx, state, nquads)) return done;
+
+	return count;
+}
+
+void nvgImageRect(NVGcontext* ctx, int image, float x, float y, float w, float h,
+				  float u0, float v0, float u1, float v1, float alpha)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float* t = state->xform;
+	NVGvertex* verts;
+	NVGpaint paint;
+	float c[8];
+
+	if (image == 0 || w == 0.0f || h == 0.0f) return;
+
+	verts = nvg__allocTempVerts(ctx, 6);
+	if (verts == NULL) return;
+
+	nvgTransformPoint(&c[0], &c[1], t, x, y);
+	nvgTransformPoint(&c[2], &c[3], t, x + w, y);
+	nvgTransformPoint(&c[4], &c[5], t, x + w, y + h);
+	nvgTransformPoint(&c[6], &c[7], t, x, y + h);
+
+	// Same winding as glyph quads, flipped when the transform or the rect mirrors so the
+	// triangles are not culled by the back-end.
+	if ((t[0]*t[3] - t[1]*t[2]) * w * h > 0.0f) {
+		nvg__vset(&verts[0], c[0], c[1], u0, v0);
+		nvg__vset(&verts[1], c[4], c[5], u1, v1);
+		nvg__vset(&verts[2], c[2], c[3], u1, v0);
+		nvg__vset(&verts[3], c[0], c[1], u0, v0);
+		nvg__vset(&verts[4], c[6], c[7], u0, v1);
+		nvg__vset(&verts[5], c[4], c[5], u1, v1);
+	} else {
+		nvg__vset(&verts[0], c[0], c[1], u0, v0);
+		nvg__vset(&verts[1], c[2], c[3], u1, v0);
+		nvg__vset(&verts[2], c[4], c[5], u1, v1);
+		nvg__vset(&verts[3], c[0], c[1], u0, v0);
+		nvg__vset(&verts[4], c[4], c[5], u1, v1);
+		nvg__vset(&verts[5], c[6], c[7], u0, v1);
+	}
+
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	paint.image = image;
+	paint.innerColor = paint.outerColor = nvgRGBAf(1, 1, 1, alpha);
+	paint.textureFilterMode = state->textureFilterMode;
+	paint.textureWrapMode = NVG_TEXTURE_WRAP_CLAMP_EDGE;
+
+	nvg__applyTintAndAlpha(state, &paint);
+
+	nvg__flushDeferred(ctx);
+	ctx->params.renderTriangles(ctx->params.userPtr, &paint, state->compositeOperation, &state->scissor, verts, 6);
+
+	ctx->drawCallCount++;
+	ctx->fillTriCount += 2;
+}
+
+// Retained shapes
+struct NVGshapeGeometry {
+	NVGpath* paths;		// fill and stroke point into verts.
+	int npaths;
+	NVGvertex* verts;	// In the frame of the shape, see nvg__shapeFrame().
+	int nverts;
+	float bounds[4];
+	float key[11];		// Frame, fringe, stroke style and tolerances the geometry was built with.
+	int valid;
+};
+typedef struct NVGshapeGeometry NVGshapeGeometry;
+
+struct NVGshape {
+	float* commands;	// In local space.
+	int ncommands;
+	NVGshapeGeometry fill;
+	NVGshapeGeometry stroke;
+	NVGpath* drawPaths;	// Paths handed to the back-end, pointing into the transformed vertices.
+	int cdrawPaths;
+};
+
+NVGshape* nvgCreateShape(NVGcontext* ctx)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGshape* shape;
+	float inv[6];
+
+	if (ctx->ncommands == 0 || !nvgTransformInverse(inv, state->xform)) return NULL;
+
+	shape = (NVGshape*)malloc(sizeof(NVGshape));
+	if (shape == NULL) return NULL;
+	memset(shape, 0, sizeof(NVGshape));
+
+	shape->commands = (float*)malloc(sizeof(float) * ctx->ncommands);
+	if (shape->commands == NULL) {
+		free(shape);
+		return NULL;
+	}
+	memcpy(shape->commands, ctx->commands, sizeof(float) * ctx->ncommands);
+	shape->ncommands = ctx->ncommands;
+
+	// The path is stored transformed, bring it back to local space.
+	nvg__transformCommands(shape->commands, shape->ncommands, inv);
+
+	return shape;
+}
+
+void nvgDeleteShape(NVGshape* shape)
+{
+	if (shape == NULL) return;
+	free(shape->commands);
+	free(shape->fill.paths);
+	free(shape->fill.verts);
+	free(shape->stroke.paths);
+	free(shape->stroke.verts);
+	free(shape->drawPaths);
+	free(shape);
+}
+
+// Geometry is built in a frame scaled like the current transform, so tolerances and fringes come out in
+// pixels, and mirrored like it, so the winding survives. What remains of the transform is a rotation and
+// translation for similarity transforms, which moves the cached vertices without changing their meaning.
+// Any other transform would stretch the expanded stroke and fringe, so the geometry is built in device
+// space instead and only the translation remains.
+static int nvg__shapeFrame(NVGstate* state, float* frame, float* remain)
+{
+	const float* t = state->xform;
+	float scale = nvg__getAverageScale(state->xform);
+	float flip = t[0]*t[3] - t[1]*t[2] < 0.0f ? -1.0f : 1.0f;
+	float sx = t[0]*t[0] + t[1]*t[1], sy = t[2]*t[2] + t[3]*t[3];
+
+	if (scale < 1e-6f) return 0;
+
+	if (nvg__absf(sx - sy) > 1e-4f * (sx + sy) || nvg__absf(t[0]*t[2] + t[1]*t[3]) > 1e-4f * (sx + sy)) {
+		nvgTransformIdentity(remain);
+		memcpy(frame, t, sizeof(float) * 4);
+		frame[4] = frame[5] = 0.0f;
+		remain[4] = t[4];
+		remain[5] = t[5];
+		return 1;
+	}
+
+	nvgTransformScale(frame, scale, flip*scale);
+	remain[0] = t[0] / scale;
+	remain[1] = t[1] / scale;
+	remain[2] = t[2] * flip / scale;
+	remain[3] = t[3] * flip / scale;
+	remain[4] = t[4];
+	remain[5] = t[5];
+	return 1;
+}
+
+// Rebuilds the geometry when the state it depends on changed, by running the regular flatten and
+// expand on the shape's commands in place of the current path.
+static int nvg__shapeGeometry(NVGcontext* ctx, NVGshape* shape, NVGshapeGeometry* geom, const float* frame,
+							  const float* key, int stroke)
+{
+	NVGpathCache* cache = ctx->cache;
+	float* commands = ctx->commands;
+	int ncommands = ctx->ncommands, ccommands = ctx->ccommands;
+	NVGpath* paths;
+	NVGvertex* verts;
+	float* vals;
+	int i, nverts = 0, offset = 0;
+
+	if (geom->valid && memcmp(geom->key, key, sizeof(geom->key)) == 0) return 1;
+	geom->valid = 0;
+
+	vals = (float*)malloc(sizeof(float) * shape->ncommands);
+	if (vals == NULL) return 0;
+	memcpy(vals, shape->commands, sizeof(float) * shape->ncommands);
+	nvg__transformCommands(vals, shape->ncommands, frame);
+
+	// The path cache is cleared before and after, so the current path is flattened again when it is used.
+	ctx->commands = vals;
+	ctx->ncommands = ctx->ccommands = shape->ncommands;
+	nvg__clearPathCache(ctx);
+	nvg__flattenPaths(ctx);
+	if (stroke)
+		nvg__expandStroke(ctx, key[5]*0.5f, key[4], (int)key[6], (int)key[7], key[8]);
+	else
+		nvg__expandFill(ctx, key[4], NVG_MITER, 2.4f);
+	ctx->commands = commands;
+	ctx->ncommands = ncommands;
+	ctx->ccommands = ccommands;
+	free(vals);
+
+	for (i = 0; i < cache->npaths; i++)
+		nverts += cache->paths[i].nfill + cache->paths[i].nstroke;
+
+	paths = (NVGpath*)realloc(geom->paths, sizeof(NVGpath) * nvg__maxi(cache->npaths, 1));
+	if (paths == NULL) goto error;
+	geom->paths = paths;
+	verts = (NVGvertex*)realloc(geom->verts, sizeof(NVGvertex) * nvg__maxi(nverts, 1));
+	if (verts == NULL) goto error;
+	geom->verts = verts;
+
+	for (i = 0; i < cache->npaths; i++) {
+		NVGpath* path = &geom->paths[i];
+		*path = cache->paths[i];
+		if (path->nfill > 0) {
+			memcpy(&verts[offset], path->fill, sizeof(NVGvertex) * path->nfill);
+			path->fill = &verts[offset];
+			offset += path->nfill;
+		}
+		if (path->nstroke > 0) {
+			memcpy(&verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			path->stroke = &verts[offset];
+			offset += path->nstroke;
+		}
+	}
+	geom->npaths = cache->npaths;
+	geom->nverts = nverts;
+	memcpy(geom->bounds, cache->bounds, sizeof(geom->bounds));
+	memcpy(geom->key, key, sizeof(geom->key));
+	geom->valid = 1;
+
+	nvg__clearPathCache(ctx);
+	return 1;
+
+error:
+	nvg__clearPathCache(ctx);
+	return 0;
+}
+
+// Moves the cached vertices to render space, returns the paths to hand to the back-end.
+static NVGpath* nvg__shapeTransform(NVGcontext* ctx, NVGshape* shape, NVGshapeGeometry* geom, const float* t, float* bounds)
+{
+	NVGvertex* verts;
+	int i;
+
+	if (geom->npaths > shape->cdrawPaths) {
+		NVGpath* paths = (NVGpath*)realloc(shape->drawPaths, sizeof(NVGpath) * geom->npaths);
+		if (paths == NULL) return NULL;
+		shape->drawPaths = paths;
+		shape->cdrawPaths = geom->npaths;
+	}
+	verts = nvg__allocTempVerts(ctx, geom->nverts);
+	if (verts == NULL) return NULL;
+
+	for (i = 0; i < geom->nverts; i++) {
+		const NVGvertex* src = &geom->verts[i];
+		nvg__vset(&verts[i], src->x*t[0] + src->y*t[2] + t[4], src->x*t[1] + src->y*t[3] + t[5], src->u, src->v);
+	}
+	for (i = 0; i < geom->npaths; i++) {
+		NVGpath* path = &shape->drawPaths[i];
+		*path = geom->paths[i];
+		if (path->fill != NULL) path->fill = verts + (path->fill - geom->verts);
+		if (path->stroke != NULL) path->stroke = verts + (path->stroke - geom->verts);
+	}
+
+	bounds[0] = bounds[1] = 1e6f;
+	bounds[2] = bounds[3] = -1e6f;
+	for (i = 0; i < 4; i++) {
+		float x, y;
+		nvgTransformPoint(&x, &y, t, geom->bounds[(i & 1) ? 2 : 0], geom->bounds[(i & 2) ? 3 : 1]);
+		bounds[0] = nvg__minf(bounds[0], x);
+		bounds[1] = nvg__minf(bounds[1], y);
+		bounds[2] = nvg__maxf(bounds[2], x);
+		bounds[3] = nvg__maxf(bounds[3], y);
+	}
+
+	return shape->drawPaths;
+}
+
+void nvgFillShape(NVGcontext* ctx, NVGshape* shape)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGpaint fillPaint = state->fill;
+	float frame[6], t[6], bounds[4];
+	float key[11] = { 0 };
+	const NVGpath* paths;
+	int i;
+
+	if (shape == NULL || !nvg__shapeFrame(state, frame, t)) return;
+	nvg__flushDeferred(ctx);
+
+	memcpy(key, frame, sizeof(float) * 4);
+	key[4] = ctx->params.edgeAntiAlias && state->shapeAntiAlias ? ctx->fringeWidth : 0.0f;
+	key[9] = ctx->tessTol;
+	key[10] = ctx->devicePxRatio;
+	if (!nvg__shapeGeometry(ctx, shape, &shape->fill, frame, key, 0)) return;
+	paths = nvg__shapeTransform(ctx, shape, &shape->fill, t, bounds);
+	if (paths == NULL) return;
+
+	nvg__applyTintAndAlpha(state, &fillPaint);
+	fillPaint.textureFilterMode = state->textureFilterMode;
+	fillPaint.textureWrapMode = state->textureWrapMode;
+
+	ctx->params.renderFill(ctx->params.userPtr, &fillPaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
+						   bounds, paths, shape->fill.npaths);
+
+	// Count triangles
+	for (i = 0; i < shape->fill.npaths; i++) {
+		ctx->fillTriCount += paths[i].nfill-2;
+		ctx->fillTriCount += paths[i].nstroke-2;
+		ctx->drawCallCount += 2;
+	}
+}
+
+void nvgStrokeShape(NVGcontext* ctx, NVGshape* shape)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGpaint strokePaint = state->stroke;
+	float frame[6], t[6], bounds[4];
+	float key[11] = { 0 };
+	float strokeWidth;
+	const NVGpath* paths;
+	int i;
+
+	if (shape == NULL || !nvg__shapeFrame(state, frame, t)) return;
+	nvg__flushDeferred(ctx);
+
+	// Same width and coverage as nvgStroke().
+	strokeWidth = nvg__clampf(state->strokeWidth * nvg__getAverageScale(state->xform), 0.0f, 200.0f);
+	if (strokeWidth < ctx->fringeWidth) {
+		float alpha = nvg__clampf(strokeWidth / ctx->fringeWidth, 0.0f, 1.0f);
+		strokePaint.innerColor.a *= alpha*alpha;
+		strokePaint.outerColor.a *= alpha*alpha;
+		strokeWidth = ctx->fringeWidth;
+	}
+
+	memcpy(key, frame, sizeof(float) * 4);
+	key[4] = ctx->params.edgeAntiAlias && state->shapeAntiAlias ? ctx->fringeWidth : 0.0f;
+	key[5] = strokeWidth;
+	key[6] = (float)state->lineCap;
+	key[7] = (float)state->lineJoin;
+	key[8] = state->miterLimit;
+	key[9] = ctx->tessTol;
+	key[10] = ctx->devicePxRatio;
+	if (!nvg__shapeGeometry(ctx, shape, &shape->stroke, frame, key, 1)) return;
+	paths = nvg__shapeTransform(ctx, shape, &shape->stroke, t, bounds);
+	if (paths == NULL) return;
+
+	nvg__applyTintAndAlpha(state, &strokePaint);
+
+	ctx->params.renderStroke(ctx->params.userPtr, &strokePaint, state->compositeOperation, &state->scissor, ctx->fringeWidth,
+							 strokeWidth, paths, shape->stroke.npaths);
+
+	// Count triangles
+	for (i = 0; i < shape->stroke.npaths; i++) {
+		ctx->strokeTriCount += paths[i].nstroke-2;
+		ctx->drawCallCount++;
+	}
+}
+
+//
+// Command lists
+//
+// A command list is a context whose back-end keeps the render calls it gets instead of
+// drawing them. Paths are flattened and expanded on the thread that records, and the kept
+// calls are handed to the back-end of the target context when the list is submitted.
+
+// Texture handle given to the font atlas of a list, text is not recorded.
+#define NVG_LIST_FONT_IMAGE -1
+
+enum NVGrecordKind {
+	NVG_RECORD_FILL,
+	NVG_RECORD_STROKE,
+	NVG_RECORD_TRIANGLES,
+	NVG_RECORD_QUADS,
+};
+
+struct NVGrecordedCall {
+	int kind;
+	NVGpaint paint;
+	NVGcompositeOperationState compositeOperation;
+	NVGscissor scissor;
+	float fringe;
+	float strokeWidth;
+	float bounds[4];
+	int first;		// First path, vertex or quad of the call.
+	int count;
+};
+typedef struct NVGrecordedCall NVGrecordedCall;
+
+struct NVGcommandList {
+	NVGparams* target;
+	NVGrecordedCall* calls;
+	int ncalls;
+	int ccalls;
+	NVGpathBuffer geometry;		// Paths of fills and strokes, and the vertices of triangles.
+	NVGquad* quads;
+	int nquads;
+	int cquads;
+};
+typedef struct NVGcommandList NVGcommandList;
+
+static NVGrecordedCall* nvg__listCall(NVGcommandList* list, int kind, NVGcompositeOperationState compositeOperation,
+									  NVGscissor* scissor, float fringe)
+{
+	NVGrecordedCall* call;
+	if (list->ncalls+1 > list->ccalls) {
+		int ccalls = nvg__maxi(list->ncalls+1, 128) + list->ccalls/2;
+		NVGrecordedCall* calls = (NVGrecordedCall*)realloc(list->calls, sizeof(NVGrecordedCall)*ccalls);
+		if (calls == NULL) return NULL;
+		list->calls = calls;
+		list->ccalls = ccalls;
+	}
+	call = &list->calls[list->ncalls++];
+	memset(call, 0, sizeof(*call));
+	call->kind = kind;
+	call->compositeOperation = compositeOperation;
+	call->scissor = *scissor;
+	call->fringe = fringe;
+	return call;
+}
+
+static int nvg__listRenderCreate(void* uptr)
+{
+	NVG_NOTUSED(uptr);
+	return 1;
+}
+
+static int nvg__listCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(w);
+	NVG_NOTUSED(h);
+	NVG_NOTUSED(imageFlags);
+	// Only the font atlas is created here, images belong to the target context.
+	return type == NVG_TEXTURE_ALPHA && data == NULL ? NVG_LIST_FONT_IMAGE : 0;
+}
+
+static int nvg__listDeleteTexture(void* uptr, int image)
+{
+	NVG_NOTUSED(uptr);
+	return image == NVG_LIST_FONT_IMAGE;
+}
+
+static int nvg__listUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(x);
+	NVG_NOTUSED(y);
+	NVG_NOTUSED(w);
+	NVG_NOTUSED(h);
+	NVG_NOTUSED(data);
+	return image == NVG_LIST_FONT_IMAGE;
+}
+
+static int nvg__listGetTexturePixelData(void* uptr, int image, unsigned char* data)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(image);
+	NVG_NOTUSED(data);
+	return 0;
+}
+
+static int nvg__listGetTextureSize(void* uptr, int image, int* w, int* h)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	if (image == NVG_LIST_FONT_IMAGE) return 0;
+	return list->target->renderGetTextureSize(list->target->userPtr, image, w, h);
+}
+
+static void nvg__listClear(NVGcommandList* list)
+{
+	list->ncalls = 0;
+	list->nquads = 0;
+	nvg__clearPathBuffer(&list->geometry);
+}
+
+static void nvg__listViewport(void* uptr, int width, int height, float devicePixelRatio)
+{
+	NVG_NOTUSED(width);
+	NVG_NOTUSED(height);
+	NVG_NOTUSED(devicePixelRatio);
+	nvg__listClear((NVGcommandList*)uptr);
+}
+
+static void nvg__listCancel(void* uptr)
+{
+	nvg__listClear((NVGcommandList*)uptr);
+}
+
+static void nvg__listFlush(void* uptr)
+{
+	// The calls are kept until the list is submitted.
+	NVG_NOTUSED(uptr);
+}
+
+static void nvg__listFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+						  const float* bounds, const NVGpath* paths, int npaths)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	NVGrecordedCall* call;
+	int first = nvg__pathBufferPaths(&list->geometry, paths, npaths);
+	if (first < 0) return;
+	call = nvg__listCall(list, NVG_RECORD_FILL, compositeOperation, scissor, fringe);
+	if (call == NULL) return;
+	call->paint = *paint;
+	memcpy(call->bounds, bounds, sizeof(call->bounds));
+	call->first = first;
+	call->count = npaths;
+}
+
+static void nvg__listStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+							float strokeWidth, const NVGpath* paths, int npaths)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	NVGrecordedCall* call;
+	int first = nvg__pathBufferPaths(&list->geometry, paths, npaths);
+	if (first < 0) return;
+	call = nvg__listCall(list, NVG_RECORD_STROKE, compositeOperation, scissor, fringe);
+	if (call == NULL) return;
+	call->paint = *paint;
+	call->strokeWidth = strokeWidth;
+	call->first = first;
+	call->count = npaths;
+}
+
+static void nvg__listTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+							   const NVGvertex* verts, int nverts)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	NVGrecordedCall* call;
+	int first;
+	if (paint->image == NVG_LIST_FONT_IMAGE || nverts <= 0) return;
+	if (!nvg__reservePathBuffer(&list->geometry, 0, nverts)) return;
+	call = nvg__listCall(list, NVG_RECORD_TRIANGLES, compositeOperation, scissor, 0.0f);
+	if (call == NULL) return;
+	first = nvg__pathBufferVerts(&list->geometry, verts, nverts);
+	call->paint = *paint;
+	call->first = first;
+	call->count = nverts;
+}
+
+static int nvg__listQuads(void* uptr, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+						  const NVGquad* quads, int nquads)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	NVGrecordedCall* call;
+	if (list->nquads+nquads > list->cquads) {
+		int cquads = list->nquads+nquads + list->cquads/2;
+		NVGquad* q = (NVGquad*)realloc(list->quads, sizeof(NVGquad)*cquads);
+		if (q == NULL) return 0;
+		list->quads = q;
+		list->cquads = cquads;
+	}
+	call = nvg__listCall(list, NVG_RECORD_QUADS, compositeOperation, scissor, fringe);
+	if (call == NULL) return 0;
+	memcpy(&list->quads[list->nquads], quads, sizeof(NVGquad)*nquads);
+	call->first = list->nquads;
+	call->count = nquads;
+	list->nquads += nquads;
+	return 1;
+}
+
+static void nvg__listDelete(void* uptr)
+{
+	NVGcommandList* list = (NVGcommandList*)uptr;
+	if (list == NULL) return;
+	nvg__freePathBuffer(&list->geometry);
+	free(list->calls);
+	free(list->quads);
+	free(list);
+}
+
+NVGcontext* nvgCreateCommandList(NVGcontext* ctx)
+{
+	NVGparams params;
+	NVGcontext* list = NULL;
+	NVGcommandList* cl = (NVGcommandList*)malloc(sizeof(NVGcommandList));
+	if (cl == NULL) goto error;
+	memset(cl, 0, sizeof(NVGcommandList));
+	cl->target = &ctx->params;
+
+	memset(&params, 0, sizeof(params));
+	params.renderCreate = nvg__listRenderCreate;
+	params.renderCreateTexture = nvg__listCreateTexture;
+	params.renderDeleteTexture = nvg__listDeleteTexture;
+	params.renderUpdateTexture = nvg__listUpdateTexture;
+	params.renderGetTexturePixelData = nvg__listGetTexturePixelData;
+	params.renderGetTextureSize = nvg__listGetTextureSize;
+	params.renderViewport = nvg__listViewport;
+	params.renderCancel = nvg__listCancel;
+	params.renderFlush = nvg__listFlush;
+	params.renderFill = nvg__listFill;
+	params.renderStroke = nvg__listStroke;
+	params.renderTriangles = nvg__listTriangles;
+	// Quads are only batched when the target can draw them.
+	params.renderQuads = ctx->params.renderQuads != NULL ? nvg__listQuads : NULL;
+	params.renderDelete = nvg__listDelete;
+	params.userPtr = cl;
+	params.edgeAntiAlias = ctx->params.edgeAntiAlias;
+
+	list = nvgCreateInternal(&params);
+	if (list == NULL) goto error;
+	return list;
+
+error:
+	// 'cl' is freed by nvgDeleteInternal.
+	if (list != NULL) nvgDeleteInternal(list);
+	return NULL;
+}
+
+void nvgDeleteCommandList(NVGcontext* list)
+{
+	nvgDeleteInternal(list);
+}
+
+void nvgSubmitCommandList(NVGcontext* ctx, NVGcontext* list)
+{
+	NVGcommandList* cl = (NVGcommandList*)list->params.userPtr;
+	int i;
+
+	if (cl->target != &ctx->params) return;
+
+	nvg__flushDeferred(ctx);
+	nvg__resolvePathBuffer(&cl->geometry);
+
+	for (i = 0; i < cl->ncalls; i++) {
+		NVGrecordedCall* call = &cl->calls[i];
+		switch (call->kind) {
+		case NVG_RECORD_FILL:
+			ctx->params.renderFill(ctx->params.userPtr, &call->paint, call->compositeOperation, &call->scissor, call->fringe,
+								   call->bounds, &cl->geometry.paths[call->first], call->count);
+			break;
+		case NVG_RECORD_STROKE:
+			ctx->params.renderStroke(ctx->params.userPtr, &call->paint, call->compositeOperation, &call->scissor, call->fringe,
+									 call->strokeWidth, &cl->geometry.paths[call->first], call->count);
+			break;
+		case NVG_RECORD_TRIANGLES:
+			ctx->params.renderTriangles(ctx->params.userPtr, &call->paint, call->compositeOperation, &call->scissor,
+										&cl->geometry.verts[call->first], call->count);
+			break;
+		case NVG_RECORD_QUADS:
+			ctx->params.renderQuads(ctx->params.userPtr, call->compositeOperation, &call->scissor, call->fringe,
+									&cl->quads[call->first], call->count);
+			break;
+		}
+	}
+
+	ctx->drawCallCount += list->drawCallCount;
+	ctx->fillTriCount += list->fillTriCount;
+	ctx->strokeTriCount += list->strokeTriCount;
+	ctx->textTriCount += list->textTriCount;
+}
+
+// Add fonts
+int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
+{
+	return fonsAddFont(ctx->fs, name, path);
+}
+
+int nvgCreateFontMem(NVGcontext* ctx, const char* name, unsigned char* data, int ndata, int freeData)
+{
+	return fonsAddFontMem(ctx->fs, name, data, ndata, freeData);
+}
+
+int nvgFindFont(NVGcontext* ctx, const char* name)
+{
+	if (name == NULL) return -1;
+	return fonsGetFontByName(ctx->fs, name);
+}
+
+void nvgFreeFont(NVGcontext* ctx, const char* name)
+{
+	FONSfont* font = fons__remFont(ctx->fs, name);
+	fons__freeFont(font);
+	// Removing a font shifts the ids of the fonts after it.
+	nvg__clearTextCache(ctx);
+}
+
+int nvgAddFallbackFontId(NVGcontext* ctx, int baseFont, int fallbackFont)
+{
+	if(baseFont == -1 || fallbackFont == -1) return 0;
+	nvg__clearTextCache(ctx);
+	return fonsAddFallbackFont(ctx->fs, baseFont, fallbackFont);
+}
+
+int nvgAddFallbackFont(NVGcontext* ctx, const char* baseFont, const char* fallbackFont)
+{
+	return nvgAddFallbackFontId(ctx, nvgFindFont(ctx, baseFont), nvgFindFont(ctx, fallbackFont));
+}
+
+int nvgFontSDF(NVGcontext* ctx, int font, int enabled)
+{
+	if (!fonsSetFontSDF(ctx->fs, font, enabled)) return 0;
+	nvg__clearTextCache(ctx);
+	return 1;
+}
+
+static int nvg__allocTextAtlas(NVGcontext* ctx);
+static void nvg__flushTextTexture(NVGcontext* ctx);
+
+int nvgFontPrewarm(NVGcontext* ctx, int font, float size, const char* charset)
+{
+	static const char ascii[] = " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+	FONSfont* fnt;
+	unsigned int utf8state = 0;
+	unsigned int codepoint = 0;
+	short isize;
+	int n = 0;
+
+	if (font < 0 || font >= ctx->fs->nfonts || ctx->fs->fonts[font]->data == NULL) return 0;
+	if (charset == NULL) charset = ascii;
+
+	// Same glyph size nvgText() asks for at this font size without scaling.
+	fnt = ctx->fs->fonts[font];
+	isize = (short)((fnt->sdf ? FONS_SDF_SIZE : size * ctx->devicePxRatio) * 10.0f);
+
+	for (; *charset; charset++) {
+		FONSglyph* glyph;
+		if (fons__decutf8(&utf8state, &codepoint, *(const unsigned char*)charset))
+			continue;
+		glyph = fons__getGlyph(ctx->fs, fnt, codepoint, isize, 0, FONS_GLYPH_BITMAP_REQUIRED);
+		if (glyph == NULL) {
+			if (!nvg__allocTextAtlas(ctx))
+				break;
+			glyph = fons__getGlyph(ctx->fs, fnt, codepoint, isize, 0, FONS_GLYPH_BITMAP_REQUIRED);
+			if (glyph == NULL)
+				break;
+		}
+		n++;
+	}
+
+	nvg__flushTextTexture(ctx);
+	return n;
+}
+
+// State setting
+void nvgFontSize(NVGcontext* ctx, float size)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->fontSize = size;
+}
+
+void nvgFontBlur(NVGcontext* ctx, float blur)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->fontBlur = blur;
+}
+
+void nvgTextLetterSpacing(NVGcontext* ctx, float spacing)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->letterSpacing = spacing;
+}
+
+void nvgTextLineHeight(NVGcontext* ctx, float lineHeight)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->lineHeight = lineHeight;
+}
+
+void nvgTextAlign(NVGcontext* ctx, int align)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->textAlign = align;
+}
+
+void nvgFontFaceId(NVGcontext* ctx, int font)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->fontId = font;
+}
+
+void nvgFontFace(NVGcontext* ctx, const char* font)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->fontId = fonsGetFontByName(ctx->fs, font);
+}
+
+static float nvg__quantize(float a, float d)
+{
+	return ((int)(a / d + 0.5f)) * d;
+}
+
+static float nvg__getFontScale(NVGstate* state)
+{
+	return nvg__minf(nvg__quantize(nvg__getAverageScale(state->xform), 0.01f), 4.0f);
+}
+
+// Scale from local units to the font pixels text is laid out in. Distance field fonts
+// are always laid out at the size their glyphs are rasterized at and scaled from there.
+static float nvg__getTextScale(NVGcontext* ctx, NVGstate* state)
+{
+	if (state->fontSize > 0.0f && fonsGetFontSDF(ctx->fs, state->fontId))
+		return FONS_SDF_SIZE / state->fontSize;
+	return nvg__getFontScale(state) * ctx->devicePxRatio;
+}
+
+// Font pixel size text is laid out at, exactly FONS_SDF_SIZE for distance field fonts so all sizes share their glyphs.
+static float nvg__getTextSize(NVGcontext* ctx, NVGstate* state, float scale)
+{
+	if (state->fontSize > 0.0f && fonsGetFontSDF(ctx->fs, state->fontId))
+		return FONS_SDF_SIZE;
+	return state->fontSize*scale;
+}
+
+static void nvg__flushTextTexture(NVGcontext* ctx)
+{
+	int dirty[FONS_MAX_DIRTY_RECTS*4];
+	int i, n = fonsValidateTextureRects(ctx->fs, dirty, FONS_MAX_DIRTY_RECTS);
+	int fontImage = ctx->fontImages[ctx->fontImageIdx];
+
+	// Update texture, only the parts new glyphs went into.
+	if (n > 0 && fontImage != 0) {
+		int iw, ih;
+		const unsigned char* data = fonsGetTextureData(ctx->fs, &iw, &ih);
+		for (i = 0; i < n; i++) {
+			int x = dirty[i*4+0];
+			int y = dirty[i*4+1];
+			int w = dirty[i*4+2] - dirty[i*4+0];
+			int h = dirty[i*4+3] - dirty[i*4+1];
+			ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+		}
+	}
+}
 
 static int nvg__allocTextAtlas(NVGcontext* ctx)
 {
@@ -2507,7 +4541,10 @@ static int nvg__allocTextAtlas(NVGcontext* ctx)
 		ctx->fontImages[ctx->fontImageIdx+1] = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_ALPHA, iw, ih, 0, NULL);
 	}
 	++ctx->fontImageIdx;
-	fonsResetAtlas(ctx->fs, iw, ih);
+	// Carry the recently used glyphs over to the new atlas instead of rasterizing them again.
+	if (!fonsCompactAtlas(ctx->fs, iw, ih, iw*ih/2))
+		fonsResetAtlas(ctx->fs, iw, ih);
+	nvg__clearTextCache(ctx);
 	return 1;
 }
 
@@ -2518,32 +4555,371 @@ static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
 
 	// Render triangles.
 	paint.image = ctx->fontImages[ctx->fontImageIdx];
+	paint.textureFilterMode = NVG_TEXTURE_FILTER_LINEAR;
+	paint.textureWrapMode = NVG_TEXTURE_WRAP_CLAMP_EDGE;
+	if (fonsGetFontSDF(ctx->fs, state->fontId)) {
+		// The field drops by 0.5 over FONS_SDF_PAD font pixels, scale that to device pixels.
+		float pixels = state->fontSize / FONS_SDF_SIZE * nvg__getAverageScale(state->xform) * ctx->devicePxRatio;
+		paint.sdfScale = 2.0f * FONS_SDF_PAD * pixels;
+	}
 
-	// Apply global tint
-	paint.innerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	paint.innerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	paint.innerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
-	paint.outerColor.r *= nvg__lerpf(1.0f, state->tint.r, state->tint.a);
-	paint.outerColor.g *= nvg__lerpf(1.0f, state->tint.g, state->tint.a);
-	paint.outerColor.b *= nvg__lerpf(1.0f, state->tint.b, state->tint.a);
-
-	// Apply global alpha
-	paint.innerColor.a *= state->alpha;
-	paint.outerColor.a *= state->alpha;
+	nvg__applyTintAndAlpha(state, &paint);
 
+	nvg__flushDeferred(ctx);
 	ctx->params.renderTriangles(ctx->params.userPtr, &paint, state->compositeOperation, &state->scissor, verts, nverts);
 
 	ctx->drawCallCount++;
 	ctx->textTriCount += nverts/3;
 }
 
+//
+// Text layout cache
+//
+// nvgText() and nvgTextBox() spend most of their time decoding UTF-8, looking
+// up glyphs and kerning pairs, and breaking lines. The resulting glyph quads
+// only depend on the string and the text style, so they are kept per layout
+// and replayed straight into triangles. Layouts are built at the origin; the
+// pen is moved to the target position on replay and rounded exactly like
+// fons__getQuad() does, so cached and uncached text are pixel identical.
+
+static unsigned int nvg__hashBytes(unsigned int h, const void* data, int len)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	int i;
+	for (i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= 16777619u;	// FNV-1a
+	}
+	return h;
+}
+
+static void nvg__textCacheUnlink(NVGtextCache* tc, NVGtextLayout* layout)
+{
+	if (layout->lruPrev != NULL) layout->lruPrev->lruNext = layout->lruNext;
+	else tc->lruHead = layout->lruNext;
+	if (layout->lruNext != NULL) layout->lruNext->lruPrev = layout->lruPrev;
+	else tc->lruTail = layout->lruPrev;
+	layout->lruPrev = layout->lruNext = NULL;
+}
+
+static void nvg__textCachePushFront(NVGtextCache* tc, NVGtextLayout* layout)
+{
+	layout->lruPrev = NULL;
+	layout->lruNext = tc->lruHead;
+	if (tc->lruHead != NULL) tc->lruHead->lruPrev = layout;
+	else tc->lruTail = layout;
+	tc->lruHead = layout;
+}
+
+static void nvg__textCacheRemove(NVGtextCache* tc, NVGtextLayout* layout)
+{
+	NVGtextLayout** link = &tc->buckets[layout->hash % NVG_TEXT_CACHE_BUCKETS];
+	while (*link != layout)
+		link = &(*link)->next;
+	*link = layout->next;
+	nvg__textCacheUnlink(tc, layout);
+	tc->bytes -= layout->bytes;
+	free(layout);
+}
+
+static void nvg__clearTextCache(NVGcontext* ctx)
+{
+	NVGtextCache* tc = &ctx->textCache;
+	while (tc->lruTail != NULL)
+		nvg__textCacheRemove(tc, tc->lruTail);
+}
+
+static void nvg__textCacheTrim(NVGtextCache* tc, int budget)
+{
+	while (tc->bytes > budget && tc->lruTail != NULL)
+		nvg__textCacheRemove(tc, tc->lruTail);
+}
+
+void nvgTextCacheBudget(NVGcontext* ctx, int bytes)
+{
+	ctx->textCache.budget = nvg__maxi(bytes, 0);
+	nvg__textCacheTrim(&ctx->textCache, ctx->textCache.budget);
+}
+
+static void nvg__textKey(NVGcontext* ctx, NVGtextKey* key, float scale, int box, float breakRowWidth, const char* string, const char* end)
+{
+	NVGstate* state = nvg__getState(ctx);
+	memset(key, 0, sizeof(*key));
+	key->fontId = state->fontId;
+	key->align = state->textAlign;
+	key->fontSize = state->fontSize;
+	key->letterSpacing = state->letterSpacing;
+	key->fontBlur = state->fontBlur;
+	key->scale = scale;
+	if (box) {
+		key->box = 1;
+		key->breakRowWidth = breakRowWidth;
+		key->lineHeight = state->lineHeight;
+	}
+	key->len = (int)(end - string);
+}
+
+static NVGtextLayout* nvg__findTextLayout(NVGcontext* ctx, const NVGtextKey* key, unsigned int hash, const char* string)
+{
+	NVGtextCache* tc = &ctx->textCache;
+	NVGtextLayout* layout;
+	for (layout = tc->buckets[hash % NVG_TEXT_CACHE_BUCKETS]; layout != NULL; layout = layout->next) {
+		if (layout->hash == hash && memcmp(&layout->key, key, sizeof(*key)) == 0 && memcmp(layout->text, string, key->len) == 0) {
+			nvg__textCacheUnlink(tc, layout);
+			nvg__textCachePushFront(tc, layout);
+			return layout;
+		}
+	}
+	return NULL;
+}
+
+// Appends the glyphs of one line laid out at the origin to the scratch space,
+// fontstash must already be set up for the text style. Returns 0 when a glyph
+// is not in the atlas, the caller then takes the uncached path which knows how
+// to grow the atlas.
+static int nvg__layoutTextLine(NVGcontext* ctx, const char* string, const char* end, float width)
+{
+	NVGtextCache* tc = &ctx->textCache;
+	FONStextIter iter;
+	FONSglyph* glyph;
+	FONSquad q;
+	NVGtextLine* line;
+	unsigned int utf8state = 0;
+	unsigned int codepoint = 0;
+	int prevGlyphIndex = -1;
+
+	if (tc->nlines+1 > tc->clines) {
+		int clines = (tc->nlines+1) + tc->clines/2 + 8;
+		NVGtextLine* lines = (NVGtextLine*)realloc(tc->lines, sizeof(NVGtextLine)*clines);
+		if (lines == NULL) return 0;
+		tc->lines = lines;
+		tc->clines = clines;
+	}
+
+	if (!fonsTextIterInit(ctx->fs, &iter, 0, 0, string, end, FONS_GLYPH_BITMAP_REQUIRED))
+		return 0;
+
+	line = &tc->lines[tc->nlines];
+	line->width = width;
+	line->originX = iter.x;
+	line->originY = iter.y;
+	line->firstGlyph = tc->nglyphs;
+
+	for (; string != end; string++) {
+		NVGtextGlyph* g;
+		float px = 0, py = 0;
+		if (fons__decutf8(&utf8state, &codepoint, *(const unsigned char*)string))
+			continue;
+		glyph = fons__getGlyph(ctx->fs, iter.font, codepoint, iter.isize, iter.iblur, FONS_GLYPH_BITMAP_REQUIRED);
+		if (glyph == NULL)
+			return 0;
+		if (tc->nglyphs+1 > tc->cglyphs) {
+			int cglyphs = (tc->nglyphs+1) + tc->cglyphs/2 + 64;
+			NVGtextGlyph* glyphs = (NVGtextGlyph*)realloc(tc->glyphs, sizeof(NVGtextGlyph)*cglyphs);
+			if (glyphs == NULL) return 0;
+			tc->glyphs = glyphs;
+			tc->cglyphs = cglyphs;
+		}
+		// Place the glyph with the pen at 0, the integer pen advances make the
+		// quad relative to the pen exact.
+		fons__getQuad(ctx->fs, iter.font, prevGlyphIndex, glyph, iter.scale, iter.spacing, &px, &py, &q);
+		g = &tc->glyphs[tc->nglyphs++];
+		g->xadv = fons__glyphAdvance(iter.font, glyph);
+		g->kern = px - g->xadv;
+		g->xoff = (float)(short)(glyph->xoff+1);
+		g->yoff = (float)(short)(glyph->yoff+1);
+		g->w = q.x1 - q.x0;
+		g->h = q.y1 - q.y0;
+		g->s0 = q.s0;
+		g->t0 = q.t0;
+		g->s1 = q.s1;
+		g->t1 = q.t1;
+		g->glyph = (int)(glyph - iter.font->glyphs);
+		prevGlyphIndex = glyph->index;
+	}
+
+	line->nglyphs = tc->nglyphs - line->firstGlyph;
+	tc->nlines++;
+	return 1;
+}
+
+// Lays out the string for the key and adds it to the cache. Returns NULL when
+// the layout can not be cached.
+static NVGtextLayout* nvg__addTextLayout(NVGcontext* ctx, const NVGtextKey* key, unsigned int hash, const char* string, const char* end)
+{
+	NVGtextCache* tc = &ctx->textCache;
+	NVGstate* state = nvg__getState(ctx);
+	NVGtextLayout* layout;
+	NVGtextLayout** bucket;
+	const char* text = string;
+	float lineh = 0;
+	int ok = 1, bytes;
+
+	tc->nlines = 0;
+	tc->nglyphs = 0;
+
+	if (!key->box) {
+		ok = nvg__layoutTextLine(ctx, string, end, 0);
+	} else {
+		NVGtextRow rows[2];
+		int nrows, i;
+		int oldAlign = state->textAlign;
+		int valign = state->textAlign & (NVG_ALIGN_TOP | NVG_ALIGN_MIDDLE | NVG_ALIGN_BOTTOM | NVG_ALIGN_BASELINE);
+
+		nvgTextMetrics(ctx, NULL, NULL, &lineh);
+
+		// Same row breaking as nvgTextBox(), nvgTextBreakLines() leaves fontstash set up for the rows.
+		state->textAlign = NVG_ALIGN_LEFT | valign;
+		while (ok && (nrows = nvgTextBreakLines(ctx, string, end, key->breakRowWidth, rows, 2))) {
+			for (i = 0; i < nrows && ok; i++)
+				ok = nvg__layoutTextLine(ctx, rows[i].start, rows[i].end, rows[i].width);
+			string = rows[nrows-1].next;
+		}
+		state->textAlign = oldAlign;
+	}
+	if (!ok) return NULL;
+
+	bytes = (int)(sizeof(NVGtextLayout) + sizeof(NVGtextLine)*tc->nlines + sizeof(NVGtextGlyph)*tc->nglyphs) + key->len;
+	if (bytes > tc->budget) return NULL;
+
+	layout = (NVGtextLayout*)malloc(bytes);
+	if (layout == NULL) return NULL;
+	memset(layout, 0, sizeof(NVGtextLayout));
+	layout->key = *key;
+	layout->hash = hash;
+	layout->bytes = bytes;
+	layout->lineh = lineh;
+	layout->sdf = fonsGetFontSDF(ctx->fs, key->fontId);
+	layout->lines = (NVGtextLine*)(layout + 1);
+	layout->nlines = tc->nlines;
+	layout->glyphs = (NVGtextGlyph*)(layout->lines + tc->nlines);
+	layout->nglyphs = tc->nglyphs;
+	layout->text = (char*)(layout->glyphs + tc->nglyphs);
+	memcpy(layout->lines, tc->lines, sizeof(NVGtextLine)*tc->nlines);
+	memcpy(layout->glyphs, tc->glyphs, sizeof(NVGtextGlyph)*tc->nglyphs);
+	memcpy(layout->text, text, key->len);
+
+	bucket = &tc->buckets[hash % NVG_TEXT_CACHE_BUCKETS];
+	layout->next = *bucket;
+	*bucket = layout;
+	nvg__textCachePushFront(tc, layout);
+	tc->bytes += bytes;
+	nvg__textCacheTrim(tc, tc->budget);
+
+	return layout;
+}
+
+// Looks up or builds the layout of the string in the current text style.
+static NVGtextLayout* nvg__getTextLayout(NVGcontext* ctx, float scale, int box, float breakRowWidth, const char* string, const char* end)
+{
+	NVGtextLayout* layout;
+	NVGtextKey key;
+	unsigned int hash;
+
+	if (ctx->textCache.budget == 0) return NULL;
+
+	nvg__textKey(ctx, &key, scale, box, breakRowWidth, string, end);
+	hash = nvg__hashBytes(nvg__hashBytes(2166136261u, &key, sizeof(key)), string, key.len);
+
+	layout = nvg__findTextLayout(ctx, &key, hash, string);
+	if (layout != NULL) {
+		ctx->textCacheHits++;
+		return layout;
+	}
+	ctx->textCacheMisses++;
+	return nvg__addTextLayout(ctx, &key, hash, string, end);
+}
+
+// Submits the glyphs of a cached layout at x,y in a single draw. Returns the
+// pen position after the last line like nvgText() does.
+static float nvg__renderTextLayout(NVGcontext* ctx, const NVGtextLayout* layout, float x, float y)
+{
+	NVGstate* state = nvg__getState(ctx);
+	FONSglyph* fontGlyphs = ctx->fs->fonts[layout->key.fontId]->glyphs;
+	int frame = ctx->fs->frame;
+	float scale = layout->key.scale;
+	float invscale = 1.0f / scale;
+	float breakRowWidth = layout->key.breakRowWidth;
+	int haling = layout->key.align & (NVG_ALIGN_LEFT | NVG_ALIGN_CENTER | NVG_ALIGN_RIGHT);
+	float pen = x*scale;
+	NVGvertex* verts;
+	int nverts = 0;
+	int i, j;
+
+	verts = nvg__allocTempVerts(ctx, nvg__maxi(2, layout->nglyphs) * 6);
+	if (verts == NULL) return x;
+
+	for (i = 0; i < layout->nlines; i++) {
+		const NVGtextLine* line = &layout->lines[i];
+		const NVGtextGlyph* g = &layout->glyphs[line->firstGlyph];
+		float lx = x, ay;
+
+		if (layout->key.box) {
+			// Row placement of nvgTextBox(), rows without horizontal alignment are skipped.
+			if (haling & NVG_ALIGN_LEFT)
+				lx = x;
+			else if (haling & NVG_ALIGN_CENTER)
+				lx = x + breakRowWidth*0.5f - line->width*0.5f;
+			else if (haling & NVG_ALIGN_RIGHT)
+				lx = x + breakRowWidth - line->width;
+			else {
+				y += layout->lineh * layout->key.lineHeight;
+				continue;
+			}
+		}
+
+		pen = lx*scale + line->originX;
+		ay = y*scale + line->originY;
+		for (j = 0; j < line->nglyphs; j++, g++) {
+			float c[4*2];
+			float x0, y0, x1, y1;
+			// The glyphs stay valid as long as the layout does, keep them from being evicted.
+			fontGlyphs[g->glyph].frame = frame;
+			pen += g->kern;
+			if (layout->sdf) {
+				x0 = pen + g->xoff;
+				y0 = ay + g->yoff;
+			} else {
+				x0 = (float)(int)(pen + g->xoff);
+				y0 = (float)(int)(ay + g->yoff);
+			}
+			x1 = x0 + g->w;
+			y1 = y0 + g->h;
+			pen += g->xadv;
+			// Transform corners.
+			nvgTransformPoint(&c[0],&c[1], state->xform, x0*invscale, y0*invscale);
+			nvgTransformPoint(&c[2],&c[3], state->xform, x1*invscale, y0*invscale);
+			nvgTransformPoint(&c[4],&c[5], state->xform, x1*invscale, y1*invscale);
+			nvgTransformPoint(&c[6],&c[7], state->xform, x0*invscale, y1*invscale);
+			// Create triangles
+			nvg__vset(&verts[nverts], c[0], c[1], g->s0, g->t0); nverts++;
+			nvg__vset(&verts[nverts], c[4], c[5], g->s1, g->t1); nverts++;
+			nvg__vset(&verts[nverts], c[2], c[3], g->s1, g->t0); nverts++;
+			nvg__vset(&verts[nverts], c[0], c[1], g->s0, g->t0); nverts++;
+			nvg__vset(&verts[nverts], c[6], c[7], g->s0, g->t1); nverts++;
+			nvg__vset(&verts[nverts], c[4], c[5], g->s1, g->t1); nverts++;
+		}
+
+		if (layout->key.box)
+			y += layout->lineh * layout->key.lineHeight;
+	}
+
+	nvg__flushTextTexture(ctx);
+
+	if (nverts > 0)
+		nvg__renderText(ctx, verts, nverts);
+
+	return pen / scale;
+}
+
 float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char* end)
 {
 	NVGstate* state = nvg__getState(ctx);
 	FONStextIter iter, prevIter;
 	FONSquad q;
 	NVGvertex* verts;
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	NVGtextLayout* layout;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 	int cverts = 0;
 	int nverts = 0;
@@ -2553,12 +4929,16 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 
 	if (state->fontId == FONS_INVALID) return x;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
 	fonsSetFont(ctx->fs, state->fontId);
 
+	layout = nvg__getTextLayout(ctx, scale, 0, 0, string, end);
+	if (layout != NULL)
+		return nvg__renderTextLayout(ctx, layout, x, y);
+
 	cverts = nvg__maxi(2, (int)(end - string)) * 6; // conservative estimate.
 	verts = nvg__allocTempVerts(ctx, cverts);
 	if (verts == NULL) return x;
@@ -2568,12 +4948,14 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 	while (fonsTextIterNext(ctx->fs, &iter, &q)) {
 		float c[4*2];
 		if (iter.prevGlyphIndex == -1) { // can not retrieve glyph?
-			if (!nvg__allocTextAtlas(ctx))
-				break; // no memory :(
+			// Submit the glyphs so far with the atlas they are in before switching.
 			if (nverts != 0) {
+				nvg__flushTextTexture(ctx);
 				nvg__renderText(ctx, verts, nverts);
 				nverts = 0;
 			}
+			if (!nvg__allocTextAtlas(ctx))
+				break; // no memory :(
 			iter = prevIter;
 			fonsTextIterNext(ctx->fs, &iter, &q); // try again
 			if (iter.prevGlyphIndex == -1) // still can not find glyph?
@@ -2608,6 +4990,7 @@ void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const ch
 {
 	NVGstate* state = nvg__getState(ctx);
 	NVGtextRow rows[2];
+	NVGtextLayout* layout;
 	int nrows = 0, i;
 	int oldAlign = state->textAlign;
 	int haling = state->textAlign & (NVG_ALIGN_LEFT | NVG_ALIGN_CENTER | NVG_ALIGN_RIGHT);
@@ -2616,6 +4999,15 @@ void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const ch
 
 	if (state->fontId == FONS_INVALID) return;
 
+	if (end == NULL)
+		end = string + strlen(string);
+
+	layout = nvg__getTextLayout(ctx, nvg__getTextScale(ctx, state), 1, breakRowWidth, string, end);
+	if (layout != NULL) {
+		nvg__renderTextLayout(ctx, layout, x, y);
+		return;
+	}
+
 	nvgTextMetrics(ctx, NULL, NULL, &lineh);
 
 	state->textAlign = NVG_ALIGN_LEFT | valign;
@@ -2640,7 +5032,7 @@ void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const ch
 int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string, const char* end, NVGglyphPosition* positions, int maxPositions)
 {
 	NVGstate* state = nvg__getState(ctx);
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 	FONStextIter iter, prevIter;
 	FONSquad q;
@@ -2654,7 +5046,7 @@ int nvgTextGlyphPositions(NVGcontext* ctx, float x, float y, const char* string,
 	if (string == end)
 		return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
@@ -2690,7 +5082,7 @@ enum NVGcodepointType {
 int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, float breakRowWidth, NVGtextRow* rows, int maxRows)
 {
 	NVGstate* state = nvg__getState(ctx);
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 	FONStextIter iter, prevIter;
 	FONSquad q;
@@ -2718,7 +5110,7 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 
 	if (string == end) return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
@@ -2896,13 +5288,13 @@ int nvgTextBreakLines(NVGcontext* ctx, const char* string, const char* end, floa
 float nvgTextBounds(NVGcontext* ctx, float x, float y, const char* string, const char* end, float* bounds)
 {
 	NVGstate* state = nvg__getState(ctx);
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 	float width;
 
 	if (state->fontId == FONS_INVALID) return 0;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
@@ -2924,7 +5316,7 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 {
 	NVGstate* state = nvg__getState(ctx);
 	NVGtextRow rows[2];
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 	int nrows = 0, i;
 	int oldAlign = state->textAlign;
@@ -2946,7 +5338,7 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 	minx = maxx = x;
 	miny = maxy = y;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
@@ -2992,12 +5384,12 @@ void nvgTextBoxBounds(NVGcontext* ctx, float x, float y, float breakRowWidth, co
 void nvgTextMetrics(NVGcontext* ctx, float* ascender, float* descender, float* lineh)
 {
 	NVGstate* state = nvg__getState(ctx);
-	float scale = nvg__getFontScale(state) * ctx->devicePxRatio;
+	float scale = nvg__getTextScale(ctx, state);
 	float invscale = 1.0f / scale;
 
 	if (state->fontId == FONS_INVALID) return;
 
-	fonsSetSize(ctx->fs, state->fontSize*scale);
+	fonsSetSize(ctx->fs, nvg__getTextSize(ctx, state, scale));
 	fonsSetSpacing(ctx->fs, state->letterSpacing*scale);
 	fonsSetBlur(ctx->fs, state->fontBlur*scale);
 	fonsSetAlign(ctx->fs, state->textAlign);
@@ -52,6 +52,7 @@ struct NVGpaint {
 	int image;
 	int textureFilterMode;
 	int textureWrapMode;
+	float sdfScale;		// Non-zero when image is a signed distance field, coverage change per unit of the field.
 };
 typedef struct NVGpaint NVGpaint;
 
@@ -73,6 +74,11 @@ enum NVGlineCap {
 	NVG_MITER,
 };
 
+enum NVGquadShape {
+	NVG_QUAD_RECT,
+	NVG_QUAD_ELLIPSE,
+};
+
 enum NVGalign {
 	// Horizontal align
 	NVG_ALIGN_LEFT 		= 1<<0,	// Default, align text horizontally to left.
@@ -188,6 +194,26 @@ void nvgCancelFrame(NVGcontext* ctx);
 // Ends drawing flushing remaining render state.
 void nvgEndFrame(NVGcontext* ctx);
 
+// Counters of a frame, see nvgFrameStats().
+struct NVGframeStats {
+	int drawCalls;
+	int fillTriangles;
+	int strokeTriangles;
+	int textTriangles;
+	int uploadBytes;		// Vertex, uniform and instance data sent to the GPU, 0 when the back-end has none.
+	int callsBeforeMerge;	// Back-end draw calls recorded, 0 when the back-end does not report them.
+	int callsAfterMerge;	// Back-end draw calls issued after joining adjacent calls with the same state.
+	int culled;				// Shapes skipped by nvgCullRect().
+	int textCacheHits;		// nvgText() and nvgTextBox() calls replayed from the text layout cache.
+	int textCacheMisses;
+	int glyphLookups;		// Glyph bitmaps looked up in the font atlas.
+	int glyphsRasterized;	// Glyph bitmaps that were not in the atlas and had to be rasterized.
+};
+typedef struct NVGframeStats NVGframeStats;
+
+// Returns the counters of the last frame ended with nvgEndFrame().
+void nvgFrameStats(NVGcontext* ctx, NVGframeStats* stats);
+
 //
 // Composite operation
 //
@@ -422,6 +448,10 @@ int nvgGetImagePixelsRGBA(NVGcontext* ctx, int image, unsigned char* data);
 // Updates image data specified by image handle.
 void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data);
 
+// Updates only the rectangle x,y,w,h of the image. Like nvgUpdateImage() data holds the whole image,
+// rows outside the rectangle are not read.
+void nvgUpdateImageRect(NVGcontext* ctx, int image, int x, int y, int w, int h, const unsigned char* data);
+
 // Returns the dimensions of a created image.
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h);
 
@@ -481,6 +511,12 @@ void nvgIntersectScissor(NVGcontext* ctx, float x, float y, float w, float h);
 // Reset and disables scissoring.
 void nvgResetScissor(NVGcontext* ctx);
 
+// Returns 1 when the rectangle x,y,w,h in the current transform, grown by the current stroke if
+// stroke is set, is certainly outside of the frame or the scissor, so drawing it can be skipped.
+// The test is conservative, a shape which could touch a pixel is never culled. Culled rectangles
+// are counted in the frame stats.
+int nvgCullRect(NVGcontext* ctx, float x, float y, float w, float h, int stroke);
+
 //
 // Paths
 //
@@ -507,6 +543,10 @@ void nvgMoveTo(NVGcontext* ctx, float x, float y);
 // Adds line segment from the last point in the path to the specified point.
 void nvgLineTo(NVGcontext* ctx, float x, float y);
 
+// Starts new sub-path at the first of count points and adds line segments through the others, like
+// nvgMoveTo() followed by nvgLineTo() for each point, in one call. xy holds the points as float pairs.
+void nvgPolyline(NVGcontext* ctx, const float* xy, int count);
+
 // Adds cubic bezier segment from last point in the path via two control points to the specified point.
 void nvgBezierTo(NVGcontext* ctx, float c1x, float c1y, float c2x, float c2y, float x, float y);
 
@@ -554,6 +594,113 @@ void nvgStroke(NVGcontext* ctx);
 // Fills the current path with stroke style override.
 void nvgFillPoint(NVGcontext* ctx);
 
+//
+// Quads
+//
+// Rectangles and ellipses filled and stroked with solid colors can be drawn as batched quads
+// instead of paths. Consecutive quads sharing the same composite operation and scissor are
+// merged by the render back-end into a single instanced draw, so scenes with thousands of
+// simple shapes do not pay for one draw call per shape. Draw order with paths, images and text
+// is preserved.
+
+// Draws a rectangle (NVG_QUAD_RECT) or ellipse (NVG_QUAD_ELLIPSE) centered at cx,cy with half
+// extents rx,ry in the current transform, filled and/or stroked with the current style.
+// The current path is left untouched. Returns 0 and draws nothing when the shape can not be
+// batched (gradient or image paint, round rect joins, or no back-end support), in which
+// case it should be drawn through the path API instead.
+int nvgQuad(NVGcontext* ctx, int shape, float cx, float cy, float rx, float ry, int fill, int stroke);
+
+// Draws count rects or ellipses as quads in one call. xy holds the position of each shape as float
+// pairs and wh its width and height, or a single float used for both when sizeStride is 1.
+// Each shape is centered at its position offset by align times its size, so align is 0 for center
+// and 0.5 for top-left corner positions. When colors is not NULL it holds RGBA bytes for each shape
+// which replace the fill color, or the stroke color if fill is 0.
+// Returns how many shapes were drawn, starting with the first: 0 when the shapes can not be batched,
+// see nvgQuad(), and less than count at a zero width or height shape, which the path API strokes as
+// a line, or when the back-end ran out of memory. The rest is left to the caller.
+int nvgQuads(NVGcontext* ctx, int shape, const float* xy, const float* wh, int sizeStride, float align,
+			 const unsigned char* colors, int count, int fill, int stroke);
+
+// Draws count independent line segments with the current stroke style as quads in one call.
+// xy holds x1,y1,x2,y2 for each segment and colors, when not NULL, RGBA bytes for each segment
+// which replace the stroke color. Returns how many segments were drawn like nvgQuads(), 0 when they
+// can not be batched (round caps, gradient or image paint, or no back-end support).
+int nvgLines(NVGcontext* ctx, const float* xy, const unsigned char* colors, int count);
+
+// Draws count points like nvgPoint() and nvgFillPoint() as quads in one call: squares, or circles
+// with round line caps, as wide as the stroke width and filled with the stroke paint. xy holds the
+// position of each point as float pairs and colors, when not NULL, RGBA bytes for each point which
+// replace the stroke color. Returns how many points were drawn like nvgQuads(), 0 when they can not
+// be batched (gradient or image paint, zero stroke width, or no back-end support).
+int nvgPoints(NVGcontext* ctx, const float* xy, const unsigned char* colors, int count);
+
+// Draws the rectangle x,y,w,h in the current transform textured with the part of the image between
+// the normalized coordinates u0,v0 and u1,v1, faded by alpha and the global alpha and tint.
+// It is drawn as two textured triangles, so consecutive rects from the same image with the same
+// state are merged by the render back-end into a single draw, which makes it the way to draw sprites
+// packed into a shared texture. Unlike an image pattern fill nothing outside the given part of the
+// image is sampled and the edges are not anti-aliased.
+void nvgImageRect(NVGcontext* ctx, int image, float x, float y, float w, float h,
+				  float u0, float v0, float u1, float v1, float alpha);
+
+//
+// Retained shapes
+//
+// A shape keeps a copy of a path together with the fill and stroke geometry made from it, so drawing
+// static geometry again only moves the cached vertices instead of flattening and expanding the path.
+// Translating and rotating a shape never rebuilds its geometry. The stroke is rebuilt when the stroke
+// width, line cap, line join or miter limit changes, and both are rebuilt when the scale or mirroring
+// of the transform changes, since tolerances and the anti-aliasing fringe are in pixels.
+
+typedef struct NVGshape NVGshape;
+
+// Creates a shape from the current path, kept in the local space of the current transform.
+// Returns NULL if the path is empty.
+NVGshape* nvgCreateShape(NVGcontext* ctx);
+
+// Fills the shape with the current fill style and transform.
+void nvgFillShape(NVGcontext* ctx, NVGshape* shape);
+
+// Strokes the shape with the current stroke style and transform.
+void nvgStrokeShape(NVGcontext* ctx, NVGshape* shape);
+
+// Deletes the shape, it does not need the context it was drawn with.
+void nvgDeleteShape(NVGshape* shape);
+
+//
+// Deferred tessellation
+//
+// When enabled, nvgFill() and nvgStroke() only record the path and render state. The recorded
+// draws are flattened and expanded on several threads when the frame ends, or earlier when
+// something else has to reach the renderer in order, such as quads, text, images or shapes.
+
+// Enables deferred tessellation on the given number of threads, counting the calling thread.
+// Passing 0 draws the pending list and goes back to tessellating at each call.
+// Returns 0 if the threads or buffers could not be created.
+int nvgDeferTessellation(NVGcontext* ctx, int threads);
+
+//
+// Command lists
+//
+// A command list is a context that records what is drawn on it instead of rendering it, so a
+// frame can be built on several threads, each drawing into its own list. Lists are replayed into
+// the context they were created for with nvgSubmitCommandList(), in the order they are submitted.
+// Recording starts with nvgBeginFrame() on the list, which drops what was recorded before, and
+// ends with nvgEndFrame(). The list keeps its own render state between recordings and tessellates
+// on the thread that draws into it. Images are shared with the target context but have to be
+// created and deleted on it while no list is recording. Text is not recorded, fonts belong to
+// the target context.
+
+// Creates a command list for the given context.
+NVGcontext* nvgCreateCommandList(NVGcontext* ctx);
+
+// Deletes a command list.
+void nvgDeleteCommandList(NVGcontext* list);
+
+// Draws the recorded calls on the context the list was created for, after what was drawn on it
+// so far. A list can be submitted any number of times until it is recorded again.
+void nvgSubmitCommandList(NVGcontext* ctx, NVGcontext* list);
+
 
 //
 // Text
@@ -608,6 +755,15 @@ int nvgAddFallbackFontId(NVGcontext* ctx, int baseFont, int fallbackFont);
 // Adds a fallback font by name.
 int nvgAddFallbackFont(NVGcontext* ctx, const char* baseFont, const char* fallbackFont);
 
+// Renders the font from signed distance field glyphs. Each glyph is rasterized once and drawn at any
+// size, scale or rotation from the same atlas entry, instead of once per pixel size. Returns 0 if the font does not exist.
+int nvgFontSDF(NVGcontext* ctx, int font, int enabled);
+
+// Rasterizes the glyphs of the UTF-8 charset into the font atlas at the specified font size, so the
+// first frames drawing them do not have to. All printable ASCII characters are used when charset is NULL.
+// Returns the number of glyphs in the atlas.
+int nvgFontPrewarm(NVGcontext* ctx, int font, float size, const char* charset);
+
 // Sets the font size of current text style.
 void nvgFontSize(NVGcontext* ctx, float size);
 
@@ -637,6 +793,11 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
 // Words longer than the max width are slit at nearest character (i.e. no hyphenation).
 void nvgTextBox(NVGcontext* ctx, float x, float y, float breakRowWidth, const char* string, const char* end);
 
+// Sets the memory budget in bytes of the text layout cache. nvgText() and nvgTextBox() keep the
+// positioned glyphs of each string and text style and replay them while the font atlas is unchanged,
+// least recently used layouts are dropped to stay within the budget. The default is 1MB, 0 disables the cache.
+void nvgTextCacheBudget(NVGcontext* ctx, int bytes);
+
 // Measures the specified text string. Parameter bounds should be a pointer to float[4],
 // if the bounding box of the text should be returned. The bounds value are [xmin,ymin, xmax,ymax]
 // Returns the horizontal advance of the measured text (i.e. where the next character should drawn).
@@ -694,6 +855,16 @@ struct NVGpath {
 };
 typedef struct NVGpath NVGpath;
 
+struct NVGquad {
+	float xform[6];		// Shape space to render space, shape space is centered on the quad.
+	float extent[2];	// Half size of the shape in shape space.
+	NVGcolor color;
+	float strokeWidth;	// Stroke width in render space, 0 for fills.
+	int shape;
+	int lineJoin;		// NVG_MITER or NVG_BEVEL corners of stroked rects.
+};
+typedef struct NVGquad NVGquad;
+
 struct NVGparams {
 	void* userPtr;
 	int edgeAntiAlias;
@@ -709,6 +880,8 @@ struct NVGparams {
 	void (*renderFill)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, const float* bounds, const NVGpath* paths, int npaths);
 	void (*renderStroke)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, float strokeWidth, const NVGpath* paths, int npaths);
 	void (*renderTriangles)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, const NVGvertex* verts, int nverts);
+	int (*renderQuads)(void* uptr, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe, const NVGquad* quads, int nquads);
+	void (*renderGetStats)(void* uptr, NVGframeStats* stats);	// Optional, fills in the back-end counters since the last call.
 	void (*renderDelete)(void* uptr);
 };
 typedef struct NVGparams NVGparams;
@@ -54,6 +54,10 @@ enum NVGcreateFlags {
 // Creates NanoVG contexts for different OpenGL (ES) versions.
 // Flags should be combination of the create flags above.
 
+// nvglClip*() limits everything the context renders to a rectangle of the render target in pixels, x, y
+// being its bottom left corner like glScissor. A negative width removes the limit. Unlike nvgScissor()
+// it is not part of the state, so nvgSave() and nvgRestore() do not change it.
+
 #if defined NANOVG_GL2
 
 NVGcontext* nvgCreateGL2(int flags);
@@ -61,6 +65,7 @@ void nvgDeleteGL2(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGL2(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGL2(NVGcontext* ctx, int image);
+void nvglClipGL2(NVGcontext* ctx, int x, int y, int w, int h);
 
 #endif
 
@@ -71,6 +76,7 @@ void nvgDeleteGL3(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGL3(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGL3(NVGcontext* ctx, int image);
+void nvglClipGL3(NVGcontext* ctx, int x, int y, int w, int h);
 
 #endif
 
@@ -81,6 +87,7 @@ void nvgDeleteGLES2(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGLES2(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGLES2(NVGcontext* ctx, int image);
+void nvglClipGLES2(NVGcontext* ctx, int x, int y, int w, int h);
 
 #endif
 
@@ -91,6 +98,7 @@ void nvgDeleteGLES3(NVGcontext* ctx);
 
 int nvglCreateImageFromHandleGLES3(NVGcontext* ctx, GLuint textureId, int w, int h, int flags);
 GLuint nvglImageHandleGLES3(NVGcontext* ctx, int image);
+void nvglClipGLES3(NVGcontext* ctx, int x, int y, int w, int h);
 
 #endif
 
@@ -178,6 +186,8 @@ enum GLNVGcallType {
 	GLNVG_CONVEXFILL,
 	GLNVG_STROKE,
 	GLNVG_TRIANGLES,
+	GLNVG_QUADS,
+	GLNVG_INDEXED,		// Adjacent fills and strokes joined by glnvg__mergeCalls().
 };
 
 struct GLNVGcall {
@@ -188,9 +198,12 @@ struct GLNVGcall {
 	int triangleOffset;
 	int triangleCount;
 	int uniformOffset;
+	int instanceOffset;
+	int instanceCount;
 	int textureFilterMode;
 	int textureWrapMode;
 	GLNVGblend blendFunc;
+	NVGcolor color;		// Premultiplied solid paint carried by the vertices, see glnvg__liftSolidPaint().
 };
 typedef struct GLNVGcall GLNVGcall;
 
@@ -243,6 +256,41 @@ struct GLNVGfragUniforms {
 };
 typedef struct GLNVGfragUniforms GLNVGfragUniforms;
 
+// Per instance data of a batched quad, see glnvg__renderQuads().
+struct GLNVGquadInstance {
+	float xform[6];
+	float extent[2];
+	float color[4];		// Premultiplied.
+	float pad[2];		// Quad padding in shape space, covers the stroke and the AA fringe.
+	float strokeWidth;	// In pixels, 0 for fills.
+	float shape;		// NVGquadShape, 2 for a rect stroke with beveled corners.
+};
+typedef struct GLNVGquadInstance GLNVGquadInstance;
+
+#if defined NANOVG_GL3
+#define GLNVG_STREAM_SEGMENTS 3		// Flushes the GPU may still be reading when the next one is written.
+
+// Uniforms, quad instances and vertices of a flush are streamed through one buffer. With buffer
+// storage the buffer is mapped once and split in segments, each guarded by a fence, so a flush
+// writes to memory the GPU is done with and the driver never allocates. Without it the buffer
+// is orphaned before each flush.
+struct GLNVGstream {
+	GLuint buf;
+	int persistent;
+	unsigned char* mapped;
+	int segmentSize;
+	int segment;				// Segment written by the next flush.
+	GLsync fences[GLNVG_STREAM_SEGMENTS];
+	// Where the current flush placed its data in the buffer.
+	int uniformBase;
+	int instanceBase;
+	int vertexBase;
+	int colorBase;
+	int indexBase;
+};
+typedef struct GLNVGstream GLNVGstream;
+#endif
+
 struct GLNVGcontext {
 	GLNVGshader shader;
 	GLNVGtexture* textures;
@@ -250,15 +298,23 @@ struct GLNVGcontext {
 	int ntextures;
 	int ctextures;
 	int textureId;
-	GLuint vertBuf;
 #if defined NANOVG_GL3
 	GLuint vertArr;
-#endif
-#if NANOVG_GL_USE_UNIFORMBUFFER
-	GLuint fragBuf;
+	GLNVGstream stream;
+	int streamAlign;
+#else
+	GLuint vertBuf;
 #endif
 	int fragSize;
 	int flags;
+	int uploadBytes;		// Since the last frame stats.
+	int callsBeforeMerge;
+	int callsAfterMerge;
+	int clip[4];			// See nvglClip*(), off when clip[2] < 0.
+#if defined NANOVG_GL3
+	GLNVGshader quadShader;
+	GLuint quadArr;
+#endif
 
 	// Per frame buffers
 	GLNVGcall* calls;
@@ -273,6 +329,16 @@ struct GLNVGcontext {
 	unsigned char* uniforms;
 	int cuniforms;
 	int nuniforms;
+	GLNVGquadInstance* instances;
+	int cinstances;
+	int ninstances;
+#if defined NANOVG_GL3
+	NVGcolor* vertColors;	// One per vertex.
+	int cvertColors;
+	GLuint* indices;		// Triangle lists of merged calls.
+	int cindices;
+	int nindices;
+#endif
 
 	// cached state
 	#if NANOVG_GL_USE_STATE_FILTER
@@ -514,6 +580,11 @@ static int glnvg__createShader(GLNVGshader* shader, const char* name, const char
 
 	glBindAttribLocation(prog, 0, "vertex");
 	glBindAttribLocation(prog, 1, "tcoord");
+	glBindAttribLocation(prog, 2, "xformA");
+	glBindAttribLocation(prog, 3, "xformB");
+	glBindAttribLocation(prog, 4, "color");
+	glBindAttribLocation(prog, 5, "params");
+	glBindAttribLocation(prog, 6, "vcolor");
 
 	glLinkProgram(prog);
 	glGetProgramiv(prog, GL_LINK_STATUS, &status);
@@ -551,6 +622,144 @@ static void glnvg__getUniforms(GLNVGshader* shader)
 #endif
 }
 
+#if defined NANOVG_GL3
+static int glnvg__hasBufferStorage(void)
+{
+#if defined GL_MAP_PERSISTENT_BIT
+	// Only core 4.4 is used, loaders do not always fetch glBufferStorage for the extension.
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	return major > 4 || (major == 4 && minor >= 4);
+#else
+	return 0;
+#endif
+}
+
+static int glnvg__alignUp(int n, int align)
+{
+	return (n + align - 1) / align * align;
+}
+
+static void glnvg__waitFence(GLsync* fence)
+{
+	GLenum status;
+	if (*fence == NULL) return;
+	do {
+		status = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+	} while (status == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(*fence);
+	*fence = NULL;
+}
+
+static void glnvg__deleteStream(GLNVGstream* stream)
+{
+	int i;
+	for (i = 0; i < GLNVG_STREAM_SEGMENTS; i++) {
+		if (stream->fences[i] != NULL)
+			glDeleteSync(stream->fences[i]);
+		stream->fences[i] = NULL;
+	}
+	// Deleting the buffer also unmaps it.
+	if (stream->buf != 0)
+		glDeleteBuffers(1, &stream->buf);
+	stream->buf = 0;
+	stream->mapped = NULL;
+	stream->segmentSize = 0;
+	stream->segment = 0;
+}
+
+static int glnvg__allocStream(GLNVGcontext* gl, int segmentSize)
+{
+	GLNVGstream* stream = &gl->stream;
+	int i;
+
+	// The GPU may still read from any segment of the old buffer.
+	for (i = 0; i < GLNVG_STREAM_SEGMENTS; i++)
+		glnvg__waitFence(&stream->fences[i]);
+	glnvg__deleteStream(stream);
+
+	glGenBuffers(1, &stream->buf);
+	glBindBuffer(GL_ARRAY_BUFFER, stream->buf);
+#if defined GL_MAP_PERSISTENT_BIT
+	if (stream->persistent) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr size = (GLsizeiptr)segmentSize * GLNVG_STREAM_SEGMENTS;
+		glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+		stream->mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		if (stream->mapped == NULL) {
+			// Keep going with orphaning.
+			glnvg__deleteStream(stream);
+			stream->persistent = 0;
+			return glnvg__allocStream(gl, segmentSize);
+		}
+		stream->segmentSize = segmentSize;
+		return 1;
+	}
+#endif
+	glBufferData(GL_ARRAY_BUFFER, segmentSize, NULL, GL_STREAM_DRAW);
+	stream->segmentSize = segmentSize;
+	return glGetError() == GL_NO_ERROR;
+}
+
+static int glnvg__streamUpload(GLNVGcontext* gl)
+{
+	GLNVGstream* stream = &gl->stream;
+	int uniformBytes = gl->nuniforms * gl->fragSize;
+	int instanceBytes = gl->ninstances * (int)sizeof(GLNVGquadInstance);
+	int vertexBytes = gl->nverts * (int)sizeof(NVGvertex);
+	int colorBytes = gl->nverts * (int)sizeof(NVGcolor);
+	int indexBytes = gl->nindices * (int)sizeof(GLuint);
+	int instanceStart = glnvg__alignUp(uniformBytes, gl->streamAlign);
+	int vertexStart = instanceStart + glnvg__alignUp(instanceBytes, gl->streamAlign);
+	int colorStart = vertexStart + glnvg__alignUp(vertexBytes, gl->streamAlign);
+	int indexStart = colorStart + glnvg__alignUp(colorBytes, gl->streamAlign);
+	int total = indexStart + indexBytes;
+	int base = 0;
+
+	if (total > stream->segmentSize) {
+		// Grow with some slack so a growing scene does not reallocate every frame.
+		int size = glnvg__alignUp(glnvg__maxi(total + total/2, 64*1024), gl->streamAlign);
+		if (!glnvg__allocStream(gl, size)) return 0;
+	}
+
+	if (stream->persistent) {
+		glnvg__waitFence(&stream->fences[stream->segment]);
+		base = stream->segment * stream->segmentSize;
+		if (uniformBytes > 0) memcpy(stream->mapped + base, gl->uniforms, uniformBytes);
+		if (instanceBytes > 0) memcpy(stream->mapped + base + instanceStart, gl->instances, instanceBytes);
+		if (vertexBytes > 0) memcpy(stream->mapped + base + vertexStart, gl->verts, vertexBytes);
+		if (colorBytes > 0) memcpy(stream->mapped + base + colorStart, gl->vertColors, colorBytes);
+		if (indexBytes > 0) memcpy(stream->mapped + base + indexStart, gl->indices, indexBytes);
+	} else {
+		glBindBuffer(GL_ARRAY_BUFFER, stream->buf);
+		// Orphan the storage earlier flushes draw from, the driver hands out a new block.
+		glBufferData(GL_ARRAY_BUFFER, stream->segmentSize, NULL, GL_STREAM_DRAW);
+		if (uniformBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, uniformBytes, gl->uniforms);
+		if (instanceBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, instanceStart, instanceBytes, gl->instances);
+		if (vertexBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, vertexStart, vertexBytes, gl->verts);
+		if (colorBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, colorStart, colorBytes, gl->vertColors);
+		if (indexBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, indexStart, indexBytes, gl->indices);
+	}
+
+	stream->uniformBase = base;
+	stream->instanceBase = base + instanceStart;
+	stream->vertexBase = base + vertexStart;
+	stream->colorBase = base + colorStart;
+	stream->indexBase = base + indexStart;
+	gl->uploadBytes += uniformBytes + instanceBytes + vertexBytes + colorBytes + indexBytes;
+	return 1;
+}
+
+static void glnvg__streamFence(GLNVGcontext* gl)
+{
+	GLNVGstream* stream = &gl->stream;
+	if (!stream->persistent) return;
+	stream->fences[stream->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	stream->segment = (stream->segment + 1) % GLNVG_STREAM_SEGMENTS;
+}
+#endif
+
 static int glnvg__renderCreate(void* uptr)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
@@ -576,6 +785,9 @@ static int glnvg__renderCreate(void* uptr)
 	"#define USE_UNIFORMBUFFER 1\n"
 #else
 	"#define UNIFORMARRAY_SIZE 11\n"
+#endif
+#if defined NANOVG_GL3
+	"#define VERTEX_COLOR 1\n"
 #endif
 	"\n";
 
@@ -586,6 +798,10 @@ static int glnvg__renderCreate(void* uptr)
 		"	in vec2 tcoord;\n"
 		"	out vec2 ftcoord;\n"
 		"	out vec2 fpos;\n"
+		"#ifdef VERTEX_COLOR\n"
+		"	in vec4 vcolor;\n"
+		"	flat out vec4 fcolor;\n"
+		"#endif\n"
 		"#else\n"
 		"	uniform vec2 viewSize;\n"
 		"	attribute vec2 vertex;\n"
@@ -596,6 +812,9 @@ static int glnvg__renderCreate(void* uptr)
 		"void main(void) {\n"
 		"	ftcoord = tcoord;\n"
 		"	fpos = vertex;\n"
+		"#ifdef VERTEX_COLOR\n"
+		"	fcolor = vcolor;\n"
+		"#endif\n"
 		"	gl_Position = vec4(2.0*vertex.x/viewSize.x - 1.0, 1.0 - 2.0*vertex.y/viewSize.y, 0, 1);\n"
 		"}\n";
 
@@ -630,6 +849,9 @@ static int glnvg__renderCreate(void* uptr)
 		"	uniform sampler2D tex;\n"
 		"	in vec2 ftcoord;\n"
 		"	in vec2 fpos;\n"
+		"#ifdef VERTEX_COLOR\n"
+		"	flat in vec4 fcolor;\n"
+		"#endif\n"
 		"	out vec4 outColor;\n"
 		"#else\n" // !NANOVG_GL3
 		"	uniform vec4 frag[UNIFORMARRAY_SIZE];\n"
@@ -686,6 +908,9 @@ static int glnvg__renderCreate(void* uptr)
 		"		vec2 pt = (paintMat * vec3(fpos,1.0)).xy;\n"
 		"		float d = clamp((sdroundrect(pt, extent, radius) + feather*0.5) / feather, 0.0, 1.0);\n"
 		"		vec4 color = mix(innerCol,outerCol,d);\n"
+		"#ifdef VERTEX_COLOR\n"
+		"		color *= fcolor;\n"
+		"#endif\n"
 		"		// Combine alpha\n"
 		"		color *= strokeAlpha * scissor;\n"
 		"		result = color;\n"
@@ -699,6 +924,7 @@ static int glnvg__renderCreate(void* uptr)
 		"#endif\n"
 		"		if (texType == 1) color = vec4(color.xyz*color.w,color.w);"
 		"		if (texType == 2) color = vec4(color.x);"
+		"		if (texType == 3) color = vec4(clamp((color.x - 0.5) * feather + 0.5, 0.0, 1.0));"
 		"		// Apply color tint and alpha.\n"
 		"		color *= innerCol;\n"
 		"		// Combine alpha\n"
@@ -714,6 +940,7 @@ static int glnvg__renderCreate(void* uptr)
 		"#endif\n"
 		"		if (texType == 1) color = vec4(color.xyz*color.w,color.w);"
 		"		if (texType == 2) color = vec4(color.x);"
+		"		if (texType == 3) color = vec4(clamp((color.x - 0.5) * feather + 0.5, 0.0, 1.0));"
 		"		color *= scissor;\n"
 		"		result = color * innerCol;\n"
 		"	}\n"
@@ -724,6 +951,79 @@ static int glnvg__renderCreate(void* uptr)
 		"#endif\n"
 		"}\n";
 
+#if defined NANOVG_GL3
+	// Batched rects and ellipses. Each instance is a quad covering the shape, the coverage
+	// is computed from the distance to the outline, measured in pixels through derivatives.
+	static const char* quadVertShader =
+		"	uniform vec2 viewSize;\n"
+		"	in vec4 xformA;\n"
+		"	in vec4 xformB;\n"
+		"	in vec4 color;\n"
+		"	in vec4 params;\n"
+		"	out vec2 flocal;\n"
+		"	out vec2 fpos;\n"
+		"	out vec4 fcolor;\n"
+		"	flat out vec4 fshape;\n"
+		"void main(void) {\n"
+		"	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0 - 1.0;\n"
+		"	vec2 local = corner * (xformB.zw + params.xy);\n"
+		"	vec2 pos = vec2(xformA.x*local.x + xformA.z*local.y + xformB.x, xformA.y*local.x + xformA.w*local.y + xformB.y);\n"
+		"	flocal = local;\n"
+		"	fpos = pos;\n"
+		"	fcolor = color;\n"
+		"	fshape = vec4(xformB.zw, params.zw);\n"
+		"	gl_Position = vec4(2.0*pos.x/viewSize.x - 1.0, 1.0 - 2.0*pos.y/viewSize.y, 0, 1);\n"
+		"}\n";
+
+	static const char* quadFragShader =
+		"	layout(std140) uniform frag {\n"
+		"		mat3 scissorMat;\n"
+		"		mat3 paintMat;\n"
+		"		vec4 innerCol;\n"
+		"		vec4 outerCol;\n"
+		"		vec2 scissorExt;\n"
+		"		vec2 scissorScale;\n"
+		"		vec2 extent;\n"
+		"		float radius;\n"
+		"		float feather;\n"
+		"		float strokeMult;\n"
+		"		float strokeThr;\n"
+		"		int texType;\n"
+		"		int type;\n"
+		"	};\n"
+		"	in vec2 flocal;\n"
+		"	in vec2 fpos;\n"
+		"	in vec4 fcolor;\n"
+		"	flat in vec4 fshape;\n"
+		"	out vec4 outColor;\n"
+		"\n"
+		"float scissorMask(vec2 p) {\n"
+		"	vec2 sc = (abs((scissorMat * vec3(p,1.0)).xy) - scissorExt);\n"
+		"	sc = vec2(0.5,0.5) - sc * scissorScale;\n"
+		"	return clamp(sc.x,0.0,1.0) * clamp(sc.y,0.0,1.0);\n"
+		"}\n"
+		"\n"
+		"void main(void) {\n"
+		"	vec2 q = abs(flocal) - fshape.xy;\n"
+		"	float rect = max(q.x, q.y);\n"
+		"	float ellipse = length(flocal / fshape.xy) - 1.0;\n"
+		"	float f = fshape.w > 0.5 && fshape.w < 1.5 ? ellipse : rect;\n"
+		"	float d = f / max(length(vec2(dFdx(f), dFdy(f))), 1e-6);\n"
+		"	// Bevels cut the corners along the line through the outer stroke corners of both edges.\n"
+		"	vec2 dq = q / max(vec2(length(vec2(dFdx(q.x), dFdy(q.x))), length(vec2(dFdx(q.y), dFdy(q.y)))), vec2(1e-6));\n"
+		"	float bevel = fshape.w > 1.5 ? (dq.x + dq.y - 0.5*fshape.z) * 0.70710678 : -1.0;\n"
+		"#ifdef EDGE_AA\n"
+		"	float fillAlpha = clamp(0.5 - d, 0.0, 1.0);\n"
+		"	float strokeAlpha = clamp(0.5 + 0.5*fshape.z - abs(d), 0.0, 1.0) * clamp(0.5 - bevel, 0.0, 1.0);\n"
+		"#else\n"
+		"	float fillAlpha = step(d, 0.0);\n"
+		"	float strokeAlpha = step(abs(d), 0.5*fshape.z) * step(bevel, 0.0);\n"
+		"#endif\n"
+		"	float alpha = fshape.z > 0.0 ? strokeAlpha : fillAlpha;\n"
+		"	outColor = fcolor * (alpha * scissorMask(fpos));\n"
+		"}\n";
+#endif
+
 	glnvg__checkError(gl, "init");
 
 	if (gl->flags & NVG_ANTIALIAS) {
@@ -737,17 +1037,38 @@ static int glnvg__renderCreate(void* uptr)
 	glnvg__checkError(gl, "uniform locations");
 	glnvg__getUniforms(&gl->shader);
 
+#if defined NANOVG_GL3
+	// Quads are optional, nvgQuad() falls back to paths when the shader is not available.
+	if (glnvg__createShader(&gl->quadShader, "quad", shaderHeader, (gl->flags & NVG_ANTIALIAS) ? "#define EDGE_AA 1\n" : NULL, quadVertShader, quadFragShader)) {
+		glnvg__getUniforms(&gl->quadShader);
+		glUniformBlockBinding(gl->quadShader.prog, gl->quadShader.loc[GLNVG_LOC_FRAG], GLNVG_FRAG_BINDING);
+
+		glGenVertexArrays(1, &gl->quadArr);
+		glBindVertexArray(gl->quadArr);
+		for (int i = 2; i <= 5; i++) {
+			glEnableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 1);
+		}
+		glBindVertexArray(0);
+	} else {
+		glnvg__deleteShader(&gl->quadShader);
+		memset(&gl->quadShader, 0, sizeof(gl->quadShader));
+	}
+#endif
+
 	// Create dynamic vertex array
 #if defined NANOVG_GL3
 	glGenVertexArrays(1, &gl->vertArr);
-#endif
+#else
 	glGenBuffers(1, &gl->vertBuf);
+#endif
 
 #if NANOVG_GL_USE_UNIFORMBUFFER
-	// Create UBOs
+	// Uniforms are streamed with the vertices, the buffer is created on the first flush
 	glUniformBlockBinding(gl->shader.prog, gl->shader.loc[GLNVG_LOC_FRAG], GLNVG_FRAG_BINDING);
-	glGenBuffers(1, &gl->fragBuf);
 	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+	gl->streamAlign = glnvg__maxi(align, 16);
+	gl->stream.persistent = glnvg__hasBufferStorage();
 #endif
 	gl->fragSize = sizeof(GLNVGfragUniforms) + align - sizeof(GLNVGfragUniforms) % align;
 
@@ -1014,13 +1335,15 @@ static int glnvg__convertPaint(GLNVGcontext* gl, GLNVGfragUniforms* frag, NVGpai
 		if (tex->type == NVG_TEXTURE_RGBA)
 			frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
 		else
-			frag->texType = 2;
+			frag->texType = paint->sdfScale > 0.0f ? 3 : 2;
 		#else
 		if (tex->type == NVG_TEXTURE_RGBA)
 			frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0.0f : 1.0f;
 		else
-			frag->texType = 2.0f;
+			frag->texType = paint->sdfScale > 0.0f ? 3.0f : 2.0f;
 		#endif
+		// Distance field alpha, feather holds how fast coverage changes across the outline.
+		frag->feather = paint->sdfScale;
 //		printf("frag->texType = %d\n", frag->texType);
 	} else {
 		frag->type = NSVG_SHADER_FILLGRAD;
@@ -1039,7 +1362,7 @@ static GLNVGfragUniforms* nvg__fragUniformPtr(GLNVGcontext* gl, int i);
 static void glnvg__setUniforms(GLNVGcontext* gl, int uniformOffset, int image)
 {
 #if NANOVG_GL_USE_UNIFORMBUFFER
-	glBindBufferRange(GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->fragBuf, uniformOffset, sizeof(GLNVGfragUniforms));
+	glBindBufferRange(GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->stream.buf, gl->stream.uniformBase + uniformOffset, sizeof(GLNVGfragUniforms));
 #else
 	GLNVGfragUniforms* frag = nvg__fragUniformPtr(gl, uniformOffset);
 	glUniform4fv(gl->shader.loc[GLNVG_LOC_FRAG], NANOVG_GL_UNIFORMARRAY_SIZE, &(frag->uniformArray[0][0]));
@@ -1181,16 +1504,72 @@ static void glnvg__triangles(GLNVGcontext* gl, GLNVGcall* call)
 {
 	glnvg__setUniforms(gl, call->uniformOffset, call->image);
 	glnvg__checkError(gl, "triangles fill");
+	glnvg__setTextureFilter(call->textureFilterMode);
+	glnvg__setTextureWrap(call->textureWrapMode);
 
 	glDrawArrays(GL_TRIANGLES, call->triangleOffset, call->triangleCount);
 }
 
+#if defined NANOVG_GL3
+static void glnvg__quads(GLNVGcontext* gl, GLNVGcall* call)
+{
+	GLsizei stride = sizeof(GLNVGquadInstance);
+	size_t offset = (size_t)gl->stream.instanceBase + (size_t)call->instanceOffset * sizeof(GLNVGquadInstance);
+
+	glUseProgram(gl->quadShader.prog);
+	glUniform2fv(gl->quadShader.loc[GLNVG_LOC_VIEWSIZE], 1, gl->view);
+	glBindVertexArray(gl->quadArr);
+	glBindBuffer(GL_ARRAY_BUFFER, gl->stream.buf);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(offset + 0*sizeof(float)));
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(offset + 4*sizeof(float)));
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(offset + 8*sizeof(float)));
+	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(offset + 12*sizeof(float)));
+
+	glnvg__setUniforms(gl, call->uniformOffset, 0);
+	glnvg__checkError(gl, "quads");
+
+	// Mirroring transforms flip the winding of the quads.
+	glDisable(GL_CULL_FACE);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, call->instanceCount);
+	glEnable(GL_CULL_FACE);
+
+	glUseProgram(gl->shader.prog);
+	glBindVertexArray(gl->vertArr);
+}
+
+static void glnvg__indexed(GLNVGcontext* gl, GLNVGcall* call)
+{
+	size_t offset = (size_t)gl->stream.indexBase + (size_t)call->triangleOffset * sizeof(GLuint);
+
+	glnvg__setUniforms(gl, call->uniformOffset, call->image);
+	glnvg__checkError(gl, "merged fill");
+	if (call->image != 0) {
+		glnvg__setTextureFilter(call->textureFilterMode);
+		glnvg__setTextureWrap(call->textureWrapMode);
+	}
+
+	glDrawElements(GL_TRIANGLES, call->triangleCount, GL_UNSIGNED_INT, (const GLvoid*)offset);
+}
+#endif
+
 static void glnvg__renderCancel(void* uptr) {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	gl->nverts = 0;
 	gl->npaths = 0;
 	gl->ncalls = 0;
 	gl->nuniforms = 0;
+	gl->ninstances = 0;
+}
+
+static void glnvg__renderGetStats(void* uptr, NVGframeStats* stats)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	stats->uploadBytes = gl->uploadBytes;
+	stats->callsBeforeMerge = gl->callsBeforeMerge;
+	stats->callsAfterMerge = gl->callsAfterMerge;
+	gl->uploadBytes = 0;
+	gl->callsBeforeMerge = 0;
+	gl->callsAfterMerge = 0;
 }
 
 static GLenum glnvg_convertBlendFuncEquation(int equation)
@@ -1256,6 +1635,167 @@ static GLNVGblend glnvg__blendCompositeOperation(NVGcompositeOperationState op)
 	return blend;
 }
 
+#if defined NANOVG_GL3
+static int glnvg__mergeable(GLNVGcontext* gl, GLNVGcall* call)
+{
+	// Stencil strokes only keep a stroke from blending over itself, joined strokes would not blend over each other.
+	if (call->type == GLNVG_STROKE)
+		return (gl->flags & NVG_STENCIL_STROKES) == 0;
+	return call->type == GLNVG_CONVEXFILL;
+}
+
+static int glnvg__sameState(GLNVGcontext* gl, GLNVGcall* a, GLNVGcall* b)
+{
+	return a->type == b->type && a->image == b->image &&
+		a->textureFilterMode == b->textureFilterMode && a->textureWrapMode == b->textureWrapMode &&
+		memcmp(&a->blendFunc, &b->blendFunc, sizeof(GLNVGblend)) == 0 &&
+		memcmp(&gl->uniforms[a->uniformOffset], &gl->uniforms[b->uniformOffset], sizeof(GLNVGfragUniforms)) == 0;
+}
+
+static void glnvg__setVertColors(GLNVGcontext* gl, int offset, int count, NVGcolor color)
+{
+	NVGcolor* dst = &gl->vertColors[offset];
+	int i;
+	for (i = 0; i < count; i++)
+		dst[i] = color;
+}
+
+// Fills in the color of every vertex, white for calls that keep their paint in the uniforms.
+static int glnvg__vertexColors(GLNVGcontext* gl)
+{
+	NVGcolor white = nvgRGBAf(1.0f, 1.0f, 1.0f, 1.0f);
+	int i, j;
+
+	if (gl->nverts > gl->cvertColors) {
+		NVGcolor* colors;
+		int ccolors = glnvg__maxi(gl->nverts, 4096) + gl->cvertColors/2; // 1.5x Overallocate
+		colors = (NVGcolor*)realloc(gl->vertColors, sizeof(NVGcolor) * ccolors);
+		if (colors == NULL) return 0;
+		gl->vertColors = colors;
+		gl->cvertColors = ccolors;
+	}
+
+	for (i = 0; i < gl->ncalls; i++) {
+		GLNVGcall* call = &gl->calls[i];
+		GLNVGpath* paths = &gl->paths[call->pathOffset];
+		NVGcolor color = glnvg__mergeable(gl, call) ? call->color : white;
+		for (j = 0; j < call->pathCount; j++) {
+			glnvg__setVertColors(gl, paths[j].fillOffset, paths[j].fillCount, color);
+			glnvg__setVertColors(gl, paths[j].strokeOffset, paths[j].strokeCount, color);
+		}
+		if (call->type == GLNVG_FILL || call->type == GLNVG_TRIANGLES)
+			glnvg__setVertColors(gl, call->triangleOffset, call->triangleCount, color);
+	}
+	return 1;
+}
+
+static int glnvg__allocIndices(GLNVGcontext* gl, int n)
+{
+	int ret = 0;
+	if (gl->nindices+n > gl->cindices) {
+		GLuint* indices;
+		int cindices = glnvg__maxi(gl->nindices + n, 4096) + gl->cindices/2; // 1.5x Overallocate
+		indices = (GLuint*)realloc(gl->indices, sizeof(GLuint) * cindices);
+		if (indices == NULL) return -1;
+		gl->indices = indices;
+		gl->cindices = cindices;
+	}
+	ret = gl->nindices;
+	gl->nindices += n;
+	return ret;
+}
+
+static GLuint* glnvg__fanIndices(GLuint* dst, int offset, int count)
+{
+	int i;
+	for (i = 2; i < count; i++) {
+		*dst++ = offset;
+		*dst++ = offset + i - 1;
+		*dst++ = offset + i;
+	}
+	return dst;
+}
+
+static GLuint* glnvg__stripIndices(GLuint* dst, int offset, int count)
+{
+	int i;
+	for (i = 2; i < count; i++) {
+		// Every other triangle of a strip swaps its first two vertices to keep the winding.
+		int odd = i & 1;
+		*dst++ = offset + i - 2 + odd;
+		*dst++ = offset + i - 1 - odd;
+		*dst++ = offset + i;
+	}
+	return dst;
+}
+
+// Triangles of a call in the order glnvg__convexFill() and glnvg__stroke() draw them.
+static int glnvg__countIndices(GLNVGcontext* gl, GLNVGcall* call)
+{
+	GLNVGpath* paths = &gl->paths[call->pathOffset];
+	int i, count = 0;
+	if (call->type == GLNVG_CONVEXFILL) {
+		for (i = 0; i < call->pathCount; i++)
+			count += glnvg__maxi(paths[i].fillCount - 2, 0);
+		if ((gl->flags & NVG_ANTIALIAS) == 0) return count * 3;
+	}
+	for (i = 0; i < call->pathCount; i++)
+		count += glnvg__maxi(paths[i].strokeCount - 2, 0);
+	return count * 3;
+}
+
+static GLuint* glnvg__callIndices(GLNVGcontext* gl, GLNVGcall* call, GLuint* dst)
+{
+	GLNVGpath* paths = &gl->paths[call->pathOffset];
+	int i;
+	if (call->type == GLNVG_CONVEXFILL) {
+		for (i = 0; i < call->pathCount; i++)
+			dst = glnvg__fanIndices(dst, paths[i].fillOffset, paths[i].fillCount);
+		if ((gl->flags & NVG_ANTIALIAS) == 0) return dst;
+	}
+	for (i = 0; i < call->pathCount; i++)
+		dst = glnvg__stripIndices(dst, paths[i].strokeOffset, paths[i].strokeCount);
+	return dst;
+}
+
+// Joins runs of adjacent fills or strokes that draw with the same uniforms, texture and blending
+// into one indexed triangle list. The triangles keep their order, so the run blends exactly as the
+// separate draws did. Calls that stay alone still draw straight from the vertex array.
+static void glnvg__mergeCalls(GLNVGcontext* gl)
+{
+	int i, j, k, n = 0;
+
+	gl->nindices = 0;
+	for (i = 0; i < gl->ncalls; i = j) {
+		GLNVGcall call = gl->calls[i];
+		int count = 0, offset = -1;
+
+		j = i + 1;
+		if (glnvg__mergeable(gl, &call)) {
+			count = glnvg__countIndices(gl, &call);
+			while (j < gl->ncalls && glnvg__sameState(gl, &call, &gl->calls[j]))
+				count += glnvg__countIndices(gl, &gl->calls[j++]);
+		}
+		if (j - i > 1)
+			offset = glnvg__allocIndices(gl, count);
+
+		if (offset != -1) {
+			GLuint* dst = &gl->indices[offset];
+			for (k = i; k < j; k++)
+				dst = glnvg__callIndices(gl, &gl->calls[k], dst);
+			call.type = GLNVG_INDEXED;
+			call.triangleOffset = offset;
+			call.triangleCount = count;
+			gl->calls[n++] = call;
+		} else {
+			for (k = i; k < j; k++)
+				gl->calls[n++] = gl->calls[k];
+		}
+	}
+	gl->ncalls = n;
+}
+#endif
+
 static void glnvg__renderFlush(void* uptr)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
@@ -1272,6 +1812,10 @@ static void glnvg__renderFlush(void* uptr)
 		glEnable(GL_BLEND);
 		glDisable(GL_DEPTH_TEST);
 		glDisable(GL_SCISSOR_TEST);
+		if (gl->clip[2] >= 0) {
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(gl->clip[0], gl->clip[1], gl->clip[2], gl->clip[3]);
+		}
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 		glStencilMask(0xffffffff);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
@@ -1291,30 +1835,50 @@ static void glnvg__renderFlush(void* uptr)
 		gl->blendFunc.dstAlpha = GL_INVALID_ENUM;
 		#endif
 
-#if NANOVG_GL_USE_UNIFORMBUFFER
-		// Upload ubo for frag shaders
-		glBindBuffer(GL_UNIFORM_BUFFER, gl->fragBuf);
-		glBufferData(GL_UNIFORM_BUFFER, gl->nuniforms * gl->fragSize, gl->uniforms, GL_STREAM_DRAW);
-#endif
-
-		// Upload vertex data
+		gl->callsBeforeMerge += gl->ncalls;
 #if defined NANOVG_GL3
+		// Join calls before the upload, their indices are streamed with the rest.
+		if (!glnvg__vertexColors(gl)) {
+			glUseProgram(0);
+			glnvg__renderCancel(gl);
+			return;
+		}
+		glnvg__mergeCalls(gl);
+
+		// Upload uniforms, quad instances and vertex data
+		if (!glnvg__streamUpload(gl)) {
+			glUseProgram(0);
+			glnvg__renderCancel(gl);
+			return;
+		}
 		glBindVertexArray(gl->vertArr);
-#endif
+		glBindBuffer(GL_ARRAY_BUFFER, gl->stream.buf);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->stream.buf);
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(6);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(size_t)gl->stream.vertexBase);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)((size_t)gl->stream.vertexBase + 2*sizeof(float)));
+		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(NVGcolor), (const GLvoid*)(size_t)gl->stream.colorBase);
+#else
+		// Upload vertex data
 		glBindBuffer(GL_ARRAY_BUFFER, gl->vertBuf);
 		glBufferData(GL_ARRAY_BUFFER, gl->nverts * sizeof(NVGvertex), gl->verts, GL_STREAM_DRAW);
+		gl->uploadBytes += gl->nverts * (int)sizeof(NVGvertex);
 		glEnableVertexAttribArray(0);
 		glEnableVertexAttribArray(1);
 		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(size_t)0);
 		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(0 + 2*sizeof(float)));
+#endif
 
 		// Set view and texture just once per frame.
 		glUniform1i(gl->shader.loc[GLNVG_LOC_TEX], 0);
 		glUniform2fv(gl->shader.loc[GLNVG_LOC_VIEWSIZE], 1, gl->view);
 
 #if NANOVG_GL_USE_UNIFORMBUFFER
-		glBindBuffer(GL_UNIFORM_BUFFER, gl->fragBuf);
+		glBindBuffer(GL_UNIFORM_BUFFER, gl->stream.buf);
 #endif
+		gl->callsAfterMerge += gl->ncalls;
 
 		for (i = 0; i < gl->ncalls; i++) {
 			GLNVGcall* call = &gl->calls[i];
@@ -1327,14 +1891,23 @@ static void glnvg__renderFlush(void* uptr)
 				glnvg__stroke(gl, call);
 			else if (call->type == GLNVG_TRIANGLES)
 				glnvg__triangles(gl, call);
+#if defined NANOVG_GL3
+			else if (call->type == GLNVG_QUADS)
+				glnvg__quads(gl, call);
+			else if (call->type == GLNVG_INDEXED)
+				glnvg__indexed(gl, call);
+#endif
 		}
 
 		glDisableVertexAttribArray(0);
 		glDisableVertexAttribArray(1);
 #if defined NANOVG_GL3
+		glDisableVertexAttribArray(6);
 		glBindVertexArray(0);
+		glnvg__streamFence(gl);
 #endif
 		glDisable(GL_CULL_FACE);
+		glDisable(GL_SCISSOR_TEST);
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glUseProgram(0);
 		glnvg__bindTexture(gl, 0);
@@ -1345,6 +1918,7 @@ static void glnvg__renderFlush(void* uptr)
 	gl->npaths = 0;
 	gl->ncalls = 0;
 	gl->nuniforms = 0;
+	gl->ninstances = 0;
 }
 
 static int glnvg__maxVertCount(const NVGpath* paths, int npaths)
@@ -1421,6 +1995,22 @@ static int glnvg__allocFragUniforms(GLNVGcontext* gl, int n)
 	return ret;
 }
 
+static int glnvg__allocInstances(GLNVGcontext* gl, int n)
+{
+	int ret = 0;
+	if (gl->ninstances+n > gl->cinstances) {
+		GLNVGquadInstance* instances;
+		int cinstances = glnvg__maxi(gl->ninstances + n, 1024) + gl->cinstances/2; // 1.5x Overallocate
+		instances = (GLNVGquadInstance*)realloc(gl->instances, sizeof(GLNVGquadInstance) * cinstances);
+		if (instances == NULL) return -1;
+		gl->instances = instances;
+		gl->cinstances = cinstances;
+	}
+	ret = gl->ninstances;
+	gl->ninstances += n;
+	return ret;
+}
+
 static GLNVGfragUniforms* nvg__fragUniformPtr(GLNVGcontext* gl, int i)
 {
 	return (GLNVGfragUniforms*)&gl->uniforms[i];
@@ -1434,6 +2024,28 @@ static void glnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 	vtx->v = v;
 }
 
+#if defined NANOVG_GL3
+// Moves the color of a solid paint from the uniforms to the vertices, so fills or strokes that only
+// differ in color share their uniforms and glnvg__mergeCalls() can join them. With the paint
+// transform and extent cleared the gradient evaluates to exactly white.
+static void glnvg__liftSolidPaint(GLNVGcall* call, GLNVGfragUniforms* frag)
+{
+	NVGcolor white = nvgRGBAf(1.0f, 1.0f, 1.0f, 1.0f);
+
+	call->color = white;
+	if (frag->type != NSVG_SHADER_FILLGRAD || memcmp(&frag->innerCol, &frag->outerCol, sizeof(NVGcolor)) != 0)
+		return;
+
+	call->color = frag->innerCol;
+	frag->innerCol = white;
+	frag->outerCol = white;
+	memset(frag->paintMat, 0, sizeof(frag->paintMat));
+	memset(frag->extent, 0, sizeof(frag->extent));
+	frag->radius = 0.0f;
+	frag->feather = 1.0f;
+}
+#endif
+
 static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
 							  const float* bounds, const NVGpath* paths, int npaths)
 {
@@ -1508,6 +2120,9 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperation
 		if (call->uniformOffset == -1) goto error;
 		// Fill shader
 		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, fringe, fringe, -1.0f);
+#if defined NANOVG_GL3
+		glnvg__liftSolidPaint(call, nvg__fragUniformPtr(gl, call->uniformOffset));
+#endif
 	}
 
 	return;
@@ -1566,6 +2181,9 @@ static void glnvg__renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperati
 		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
 		if (call->uniformOffset == -1) goto error;
 		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, strokeWidth, fringe, -1.0f);
+#if defined NANOVG_GL3
+		glnvg__liftSolidPaint(call, nvg__fragUniformPtr(gl, call->uniformOffset));
+#endif
 	}
 
 	return;
@@ -1580,38 +2198,119 @@ static void glnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOper
 								   const NVGvertex* verts, int nverts)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
-	GLNVGcall* call = glnvg__allocCall(gl);
-	GLNVGfragUniforms* frag;
-
-	if (call == NULL) return;
+	GLNVGcall* call = gl->ncalls > 0 ? &gl->calls[gl->ncalls-1] : NULL;
+	GLNVGblend blend = glnvg__blendCompositeOperation(compositeOperation);
+	GLNVGfragUniforms frag;
+	int offset;
 
-	call->type = GLNVG_TRIANGLES;
-	call->image = paint->image;
-	call->blendFunc = glnvg__blendCompositeOperation(compositeOperation);
-	call->textureFilterMode = paint->textureFilterMode;
-	call->textureWrapMode = paint->textureWrapMode;
+	// Fill shader
+	glnvg__convertPaint(gl, &frag, paint, scissor, 1.0f, 1.0f, -1.0f);
+	frag.type = NSVG_SHADER_IMG;
 
 	// Allocate vertices for all the paths.
-	call->triangleOffset = glnvg__allocVerts(gl, nverts);
-	if (call->triangleOffset == -1) goto error;
-	call->triangleCount = nverts;
+	offset = glnvg__allocVerts(gl, nverts);
+	if (offset == -1) return;
+	memcpy(&gl->verts[offset], verts, sizeof(NVGvertex) * nverts);
+
+	// Triangles are appended to the previous call when it draws the same texture with the same state, so runs
+	// of text or atlas sprites become one draw. Its vertices always end where the new ones start, since any
+	// other call in between would have been the last one.
+	if (call == NULL || call->type != GLNVG_TRIANGLES || call->image != paint->image ||
+		call->textureFilterMode != paint->textureFilterMode || call->textureWrapMode != paint->textureWrapMode ||
+		memcmp(&call->blendFunc, &blend, sizeof(blend)) != 0 ||
+		memcmp(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag)) != 0) {
+		call = glnvg__allocCall(gl);
+		if (call == NULL) goto error;
+		call->type = GLNVG_TRIANGLES;
+		call->image = paint->image;
+		call->blendFunc = blend;
+		call->textureFilterMode = paint->textureFilterMode;
+		call->textureWrapMode = paint->textureWrapMode;
+		call->triangleOffset = offset;
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+		if (call->uniformOffset == -1) {
+			gl->ncalls--;
+			goto error;
+		}
+		memcpy(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag));
+	}
+	call->triangleCount += nverts;
 
-	memcpy(&gl->verts[call->triangleOffset], verts, sizeof(NVGvertex) * nverts);
+	return;
 
-	// Fill shader
-	call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
-	if (call->uniformOffset == -1) goto error;
-	frag = nvg__fragUniformPtr(gl, call->uniformOffset);
-	glnvg__convertPaint(gl, frag, paint, scissor, 1.0f, 1.0f, -1.0f);
-	frag->type = NSVG_SHADER_IMG;
+error:
+	gl->nverts -= nverts;
+}
 
-	return;
+#if defined NANOVG_GL3
+static int glnvg__renderQuads(void* uptr, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+							  const NVGquad* quads, int nquads)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGcall* call = gl->ncalls > 0 ? &gl->calls[gl->ncalls-1] : NULL;
+	GLNVGblend blend = glnvg__blendCompositeOperation(compositeOperation);
+	GLNVGfragUniforms frag;
+	NVGpaint paint;
+	int i, offset;
+
+	if (gl->quadShader.prog == 0) return 0;
+
+	// Only the scissor part of the uniforms is used by the quad shader.
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	glnvg__convertPaint(gl, &frag, &paint, scissor, 1.0f, fringe, -1.0f);
+
+	offset = glnvg__allocInstances(gl, nquads);
+	if (offset == -1) return 0;
+
+	// Quads are appended to the previous call when it is a quad batch with the same state. Its instances
+	// always end where the new ones start, since any other call in between would have been the last one.
+	if (call == NULL || call->type != GLNVG_QUADS ||
+		memcmp(&call->blendFunc, &blend, sizeof(blend)) != 0 ||
+		memcmp(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag)) != 0) {
+		call = glnvg__allocCall(gl);
+		if (call == NULL) goto error;
+		call->type = GLNVG_QUADS;
+		call->blendFunc = blend;
+		call->instanceOffset = offset;
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+		if (call->uniformOffset == -1) {
+			gl->ncalls--;
+			goto error;
+		}
+		memcpy(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag));
+	}
+	call->instanceCount += nquads;
+
+	for (i = 0; i < nquads; i++) {
+		const NVGquad* quad = &quads[i];
+		GLNVGquadInstance* inst = &gl->instances[offset + i];
+		NVGcolor color = glnvg__premulColor(quad->color);
+		// Pad by half the stroke plus the fringe, converted to shape space along each axis.
+		float pad = quad->strokeWidth*0.5f + fringe;
+		float sx = sqrtf(quad->xform[0]*quad->xform[0] + quad->xform[1]*quad->xform[1]);
+		float sy = sqrtf(quad->xform[2]*quad->xform[2] + quad->xform[3]*quad->xform[3]);
+
+		memcpy(inst->xform, quad->xform, sizeof(inst->xform));
+		inst->extent[0] = quad->extent[0];
+		inst->extent[1] = quad->extent[1];
+		inst->color[0] = color.r;
+		inst->color[1] = color.g;
+		inst->color[2] = color.b;
+		inst->color[3] = color.a;
+		inst->pad[0] = sx > 1e-6f ? pad / sx : 0.0f;
+		inst->pad[1] = sy > 1e-6f ? pad / sy : 0.0f;
+		inst->strokeWidth = quad->strokeWidth / fringe;
+		inst->shape = quad->shape == NVG_QUAD_RECT && quad->lineJoin == NVG_BEVEL ? 2.0f : (float)quad->shape;
+	}
+
+	return 1;
 
 error:
-	// We get here if call alloc was ok, but something else is not.
-	// Roll back the last call to prevent drawing it.
-	if (gl->ncalls > 0) gl->ncalls--;
+	gl->ninstances -= nquads;
+	return 0;
 }
+#endif
 
 static void glnvg__renderDelete(void* uptr)
 {
@@ -1622,15 +2321,16 @@ static void glnvg__renderDelete(void* uptr)
 	glnvg__deleteShader(&gl->shader);
 
 #if NANOVG_GL3
-#if NANOVG_GL_USE_UNIFORMBUFFER
-	if (gl->fragBuf != 0)
-		glDeleteBuffers(1, &gl->fragBuf);
-#endif
+	glnvg__deleteShader(&gl->quadShader);
+	if (gl->quadArr != 0)
+		glDeleteVertexArrays(1, &gl->quadArr);
+	glnvg__deleteStream(&gl->stream);
 	if (gl->vertArr != 0)
 		glDeleteVertexArrays(1, &gl->vertArr);
-#endif
+#else
 	if (gl->vertBuf != 0)
 		glDeleteBuffers(1, &gl->vertBuf);
+#endif
 
 	for (i = 0; i < gl->ntextures; i++) {
 		if (gl->textures[i].tex != 0 && (gl->textures[i].flags & NVG_IMAGE_NODELETE) == 0)
@@ -1641,7 +2341,12 @@ static void glnvg__renderDelete(void* uptr)
 	free(gl->paths);
 	free(gl->verts);
 	free(gl->uniforms);
+	free(gl->instances);
 	free(gl->calls);
+#if defined NANOVG_GL3
+	free(gl->vertColors);
+	free(gl->indices);
+#endif
 
 	free(gl);
 }
@@ -1662,6 +2367,7 @@ NVGcontext* nvgCreateGLES3(int flags)
 	GLNVGcontext* gl = (GLNVGcontext*)malloc(sizeof(GLNVGcontext));
 	if (gl == NULL) goto error;
 	memset(gl, 0, sizeof(GLNVGcontext));
+	gl->clip[2] = -1;
 
 	memset(&params, 0, sizeof(params));
 	params.renderCreate = glnvg__renderCreate;
@@ -1676,6 +2382,10 @@ NVGcontext* nvgCreateGLES3(int flags)
 	params.renderFill = glnvg__renderFill;
 	params.renderStroke = glnvg__renderStroke;
 	params.renderTriangles = glnvg__renderTriangles;
+#if defined NANOVG_GL3
+	params.renderQuads = glnvg__renderQuads;
+#endif
+	params.renderGetStats = glnvg__renderGetStats;
 	params.renderDelete = glnvg__renderDelete;
 	params.userPtr = gl;
 	params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
@@ -1745,4 +2455,21 @@ GLuint nvglImageHandleGLES3(NVGcontext* ctx, int image)
 	return tex->tex;
 }
 
+#if defined NANOVG_GL2
+void nvglClipGL2(NVGcontext* ctx, int x, int y, int w, int h)
+#elif defined NANOVG_GL3
+void nvglClipGL3(NVGcontext* ctx, int x, int y, int w, int h)
+#elif defined NANOVG_GLES2
+void nvglClipGLES2(NVGcontext* ctx, int x, int y, int w, int h)
+#elif defined NANOVG_GLES3
+void nvglClipGLES3(NVGcontext* ctx, int x, int y, int w, int h)
+#endif
+{
+	GLNVGcontext* gl = (GLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	gl->clip[0] = x;
+	gl->clip[1] = y;
+	gl->clip[2] = w < 0 ? -1 : w;
+	gl->clip[3] = glnvg__maxi(h, 0);
+}
+
 #endif /* NANOVG_GL_IMPLEMENTATION */
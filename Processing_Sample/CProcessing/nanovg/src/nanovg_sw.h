@@ -0,0 +1,2032 @@
+//
+// Software rasterizer back-end for NanoVG.
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef NANOVG_SW_H
+#define NANOVG_SW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The software back-end renders into an RGBA8 framebuffer in system memory, stored with the
+// top row first. It mirrors the GL3 back-end: the same geometry is rasterized at pixel centers,
+// the stencil passes used for concave fills and stencil strokes are emulated per tile and
+// blending follows the GL blend equations, so output matches the GL renderer closely.
+//
+// Calls are recorded during the frame and rasterized on nvgEndFrame(). The framebuffer is split
+// into tiles, each call is binned into the tiles it touches, and tiles are rendered in parallel
+// when the context is created with more than one thread (threads use tinycthread).
+
+// Create flags, these share their values with the GL back-end create flags.
+enum NVGswCreateFlags {
+	// Flag indicating if geometry based anti-aliasing is used.
+	NVGSW_ANTIALIAS			= 1<<0,
+	// Flag indicating if strokes should be drawn using the stencil, so overlaps are drawn just once.
+	NVGSW_STENCIL_STROKES	= 1<<1,
+};
+
+// Creates a software NanoVG context which uses up to 'threads' threads (including the caller's) to rasterize.
+NVGcontext* nvgCreateSW(int flags, int threads);
+void nvgDeleteSW(NVGcontext* ctx);
+
+// Sets the size of the framebuffer in pixels. nvgBeginFrame() maps its window size onto the whole framebuffer,
+// the same way a GL viewport does. The contents are cleared to transparent black when the size changes.
+int nvgswResize(NVGcontext* ctx, int width, int height);
+
+// Clears the framebuffer to a (non premultiplied) color, like glClear does for the GL back-end.
+void nvgswClear(NVGcontext* ctx, NVGcolor color);
+
+// Clears a rectangle of the framebuffer in pixels, like glClear with a scissor does. The rectangle is
+// clipped to the framebuffer and x, y is its top left corner.
+void nvgswClearRect(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color);
+
+// Limits everything the context renders to a rectangle of the framebuffer in pixels, like glScissor
+// but with x, y the top left corner. A negative width removes the limit. Unlike nvgScissor() it is
+// not part of the state, so nvgSave() and nvgRestore() do not change it.
+void nvgswClip(NVGcontext* ctx, int x, int y, int w, int h);
+
+// Returns the framebuffer pixels as RGBA8 with the top row first, and optionally its size.
+const unsigned char* nvgswPixels(NVGcontext* ctx, int* width, int* height);
+
+// Renders into an RGBA image instead of the framebuffer, like a GL framebuffer object with the image as
+// its color attachment, until called again with image 0. Frames map onto the whole image and the clear
+// and pixel functions above act on it. Switch between frames only, and create the image with
+// NVG_IMAGE_PREMULTIPLIED since blending leaves premultiplied colors. Returns 0 if image is not RGBA.
+int nvgswSetTarget(NVGcontext* ctx, int image);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOVG_SW_H */
+
+#ifdef NANOVG_SW_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "nanovg.h"
+#include "tinycthread.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define NANOVG_SW_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+// Tiles are square, each worker renders whole tiles so no two threads ever touch the same pixel.
+#define NANOVG_SW_TILE_SIZE 64
+
+// Convex fills with up to this many vertices are rasterized as one polygon instead of a triangle fan.
+#define NANOVG_SW_MAX_POLYGON 256
+
+enum SWNVGshaderType {
+	SWNVG_SHADER_FILLGRAD,
+	SWNVG_SHADER_FILLIMG,
+	SWNVG_SHADER_SIMPLE,
+	SWNVG_SHADER_IMG
+};
+
+enum SWNVGcallType {
+	SWNVG_NONE = 0,
+	SWNVG_FILL,
+	SWNVG_CONVEXFILL,
+	SWNVG_STROKE,
+	SWNVG_TRIANGLES,
+	SWNVG_QUADS,
+};
+
+enum SWNVGstencilFunc {
+	SWNVG_STENCIL_ALWAYS,
+	SWNVG_STENCIL_EQUAL_ZERO,
+	SWNVG_STENCIL_NOTEQUAL_ZERO,
+};
+
+enum SWNVGstencilOp {
+	SWNVG_STENCIL_KEEP,
+	SWNVG_STENCIL_INCR,		// Saturating increment.
+	SWNVG_STENCIL_ZERO,
+	SWNVG_STENCIL_WINDING,	// Wrapping increment for front faces, wrapping decrement for back faces.
+};
+
+enum SWNVGtextureFilterMode {
+	SWNVG_TEXTURE_FILTER_NEAREST,
+	SWNVG_TEXTURE_FILTER_LINEAR
+};
+
+enum SWNVGtextureWrapMode {
+	SWNVG_TEXTURE_WRAP_CLAMP,
+	SWNVG_TEXTURE_WRAP_CLAMP_EDGE,
+	SWNVG_TEXTURE_WRAP_REPEAT,
+	SWNVG_TEXTURE_WRAP_MIRROR
+};
+
+struct SWNVGtexture {
+	int id;
+	int width, height;
+	int type;
+	int flags;
+	unsigned char* data;
+};
+typedef struct SWNVGtexture SWNVGtexture;
+
+struct SWNVGblend {
+	int equation;
+	int srcRGB;
+	int dstRGB;
+	int srcAlpha;
+	int dstAlpha;
+	int sourceOver;		// Premultiplied source over, the common case gets a fast path.
+};
+typedef struct SWNVGblend SWNVGblend;
+
+// Same values as the GL back-end fragment uniforms, see glnvg__convertPaint().
+struct SWNVGpaint {
+	float scissorMat[6];
+	float paintMat[6];
+	float innerCol[4];
+	float outerCol[4];
+	float scissorExt[2];
+	float scissorScale[2];
+	float extent[2];
+	float radius;
+	float feather;
+	float strokeMult;
+	float strokeThr;
+	int texType;
+	int type;
+	int solid;			// Gradient with equal colors, shading can skip the distance.
+	int scissor;		// Zero when there is no scissor and the mask is always one.
+	int image;
+	int textureFilterMode;
+	int textureWrapMode;
+	SWNVGtexture* tex;	// Resolved from image when the frame is flushed.
+};
+typedef struct SWNVGpaint SWNVGpaint;
+
+struct SWNVGquad {
+	float invxform[6];	// Render space to shape space.
+	float extent[2];
+	float pad[2];		// Padding in shape space, covers the stroke and the AA fringe.
+	float color[4];		// Premultiplied.
+	float strokeWidth;	// In pixels, 0 for fills.
+	int shape;
+	int bevel;			// Rect stroke with beveled corners.
+	int bounds[4];		// Covered pixels, x1 and y1 are exclusive.
+};
+typedef struct SWNVGquad SWNVGquad;
+
+struct SWNVGcall {
+	int type;
+	int pathOffset;
+	int pathCount;
+	int triangleOffset;
+	int triangleCount;
+	int paintOffset;
+	int instanceOffset;
+	int instanceCount;
+	int bounds[4];		// Covered pixels, x1 and y1 are exclusive.
+	SWNVGblend blend;
+};
+typedef struct SWNVGcall SWNVGcall;
+
+struct SWNVGpath {
+	int fillOffset;
+	int fillCount;
+	int strokeOffset;
+	int strokeCount;
+};
+typedef struct SWNVGpath SWNVGpath;
+
+// Per thread scratch memory.
+struct SWNVGtile {
+	int x0, y0, x1, y1;
+	unsigned char* stencil;
+	float* span;
+	unsigned char* cover;
+};
+typedef struct SWNVGtile SWNVGtile;
+
+struct SWNVGpass {
+	const SWNVGpaint* paint;	// NULL when the pass only touches the stencil.
+	const SWNVGblend* blend;
+	int stencilFunc;
+	int stencilOp;
+	int cull;
+};
+typedef struct SWNVGpass SWNVGpass;
+
+struct SWNVGcontext;
+
+struct SWNVGworker {
+	struct SWNVGcontext* sw;
+	thrd_t thread;
+	SWNVGtile tile;
+};
+typedef struct SWNVGworker SWNVGworker;
+
+struct SWNVGcontext {
+	int flags;
+	float view[2];
+	float scale[2];		// Render space to pixels.
+
+	unsigned char* pixels;
+	int width;
+	int height;
+	int clip[4];		// See nvgswClip(), off when clip[2] < 0.
+
+	// The framebuffer while an image is the render target, see nvgswSetTarget().
+	int target;
+	unsigned char* framePixels;
+	int frameWidth;
+	int frameHeight;
+
+	SWNVGtexture* textures;
+	int ntextures;
+	int ctextures;
+	int textureId;
+
+	// Per frame buffers
+	SWNVGcall* calls;
+	int ccalls;
+	int ncalls;
+	SWNVGpath* paths;
+	int cpaths;
+	int npaths;
+	NVGvertex* verts;
+	int cverts;
+	int nverts;
+	SWNVGpaint* paints;
+	int cpaints;
+	int npaints;
+	SWNVGquad* quads;
+	int cquads;
+	int nquads;
+
+	// Tile bins, calls touching tile i are bins[binOffsets[i]] .. bins[binOffsets[i+1]-1] in draw order.
+	int* binOffsets;
+	int cbinOffsets;
+	int* bins;
+	int cbins;
+	int ntilesX;
+	int ntilesY;
+
+	// Workers
+	SWNVGtile tile;		// Scratch for the calling thread.
+	SWNVGworker* workers;
+	int nworkers;
+	mtx_t lock;
+	cnd_t wake;
+	cnd_t done;
+	int generation;
+	int nextTile;
+	int ntiles;
+	int active;
+	int quit;
+};
+typedef struct SWNVGcontext SWNVGcontext;
+
+static int swnvg__maxi(int a, int b) { return a > b ? a : b; }
+static int swnvg__mini(int a, int b) { return a < b ? a : b; }
+static float swnvg__minf(float a, float b) { return a < b ? a : b; }
+static float swnvg__maxf(float a, float b) { return a > b ? a : b; }
+static float swnvg__clampf(float a, float mn, float mx) { return a < mn ? mn : (a > mx ? mx : a); }
+
+static SWNVGtexture* swnvg__allocTexture(SWNVGcontext* sw)
+{
+	SWNVGtexture* tex = NULL;
+	int i;
+
+	for (i = 0; i < sw->ntextures; i++) {
+		if (sw->textures[i].id == 0) {
+			tex = &sw->textures[i];
+			break;
+		}
+	}
+	if (tex == NULL) {
+		if (sw->ntextures+1 > sw->ctextures) {
+			SWNVGtexture* textures;
+			int ctextures = swnvg__maxi(sw->ntextures+1, 4) +  sw->ctextures/2; // 1.5x Overallocate
+			textures = (SWNVGtexture*)realloc(sw->textures, sizeof(SWNVGtexture)*ctextures);
+			if (textures == NULL) return NULL;
+			sw->textures = textures;
+			sw->ctextures = ctextures;
+		}
+		tex = &sw->textures[sw->ntextures++];
+	}
+
+	memset(tex, 0, sizeof(*tex));
+	tex->id = ++sw->textureId;
+
+	return tex;
+}
+
+static SWNVGtexture* swnvg__findTexture(SWNVGcontext* sw, int id)
+{
+	int i;
+	for (i = 0; i < sw->ntextures; i++)
+		if (sw->textures[i].id == id)
+			return &sw->textures[i];
+	return NULL;
+}
+
+static void swnvg__restoreTarget(SWNVGcontext* sw)
+{
+	if (sw->target == 0) return;
+	sw->pixels = sw->framePixels;
+	sw->width = sw->frameWidth;
+	sw->height = sw->frameHeight;
+	sw->framePixels = NULL;
+	sw->target = 0;
+}
+
+static int swnvg__deleteTexture(SWNVGcontext* sw, int id)
+{
+	int i;
+	if (id == sw->target)
+		swnvg__restoreTarget(sw);
+	for (i = 0; i < sw->ntextures; i++) {
+		if (sw->textures[i].id == id) {
+			free(sw->textures[i].data);
+			memset(&sw->textures[i], 0, sizeof(sw->textures[i]));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int swnvg__allocTile(SWNVGtile* tile)
+{
+	tile->stencil = (unsigned char*)malloc(NANOVG_SW_TILE_SIZE * NANOVG_SW_TILE_SIZE);
+	tile->span = (float*)malloc(sizeof(float) * 4 * NANOVG_SW_TILE_SIZE);
+	tile->cover = (unsigned char*)malloc(NANOVG_SW_TILE_SIZE);
+	return tile->stencil != NULL && tile->span != NULL && tile->cover != NULL;
+}
+
+static void swnvg__freeTile(SWNVGtile* tile)
+{
+	free(tile->stencil);
+	free(tile->span);
+	free(tile->cover);
+	memset(tile, 0, sizeof(*tile));
+}
+
+//
+// Shading, the software equivalent of the GL back-end fragment shader.
+//
+
+static float swnvg__sdroundrect(float px, float py, float ex, float ey, float rad)
+{
+	float dx = fabsf(px) - (ex - rad);
+	float dy = fabsf(py) - (ey - rad);
+	float mx = swnvg__maxf(dx, 0.0f), my = swnvg__maxf(dy, 0.0f);
+	return swnvg__minf(swnvg__maxf(dx, dy), 0.0f) + sqrtf(mx*mx + my*my) - rad;
+}
+
+static float swnvg__scissorMask(const SWNVGpaint* paint, float x, float y)
+{
+	const float* m = paint->scissorMat;
+	float sx, sy;
+	if (!paint->scissor) return 1.0f;
+	sx = fabsf(m[0]*x + m[2]*y + m[4]) - paint->scissorExt[0];
+	sy = fabsf(m[1]*x + m[3]*y + m[5]) - paint->scissorExt[1];
+	sx = 0.5f - sx * paint->scissorScale[0];
+	sy = 0.5f - sy * paint->scissorScale[1];
+	return swnvg__clampf(sx, 0.0f, 1.0f) * swnvg__clampf(sy, 0.0f, 1.0f);
+}
+
+static int swnvg__wrap(int i, int size, int mode)
+{
+	if (mode == SWNVG_TEXTURE_WRAP_REPEAT) {
+		i %= size;
+		return i < 0 ? i + size : i;
+	} else if (mode == SWNVG_TEXTURE_WRAP_MIRROR) {
+		int period = size * 2;
+		i %= period;
+		if (i < 0) i += period;
+		return i < size ? i : period - 1 - i;
+	} else if (mode == SWNVG_TEXTURE_WRAP_CLAMP) {
+		// Clamp to a transparent border.
+		return (i < 0 || i >= size) ? -1 : i;
+	}
+	return i < 0 ? 0 : (i >= size ? size - 1 : i);
+}
+
+static void swnvg__texel(const SWNVGtexture* tex, int x, int y, float* out)
+{
+	const unsigned char* p;
+	if (x < 0 || y < 0) {
+		out[0] = out[1] = out[2] = out[3] = 0.0f;
+		return;
+	}
+	if (tex->type == NVG_TEXTURE_RGBA) {
+		p = &tex->data[(y * tex->width + x) * 4];
+		out[0] = p[0] * (1.0f/255.0f);
+		out[1] = p[1] * (1.0f/255.0f);
+		out[2] = p[2] * (1.0f/255.0f);
+		out[3] = p[3] * (1.0f/255.0f);
+	} else {
+		// Alpha textures read as red only, like a GL_RED texture.
+		out[0] = tex->data[y * tex->width + x] * (1.0f/255.0f);
+		out[1] = out[2] = 0.0f;
+		out[3] = 1.0f;
+	}
+}
+
+static void swnvg__sample(const SWNVGpaint* paint, float u, float v, float* out)
+{
+	const SWNVGtexture* tex = paint->tex;
+	int wrap = paint->textureWrapMode;
+	int i;
+
+	if (tex == NULL || tex->data == NULL) {
+		out[0] = out[1] = out[2] = out[3] = 0.0f;
+		return;
+	}
+
+	if (paint->textureFilterMode == SWNVG_TEXTURE_FILTER_NEAREST) {
+		int x = swnvg__wrap((int)floorf(u * tex->width), tex->width, wrap);
+		int y = swnvg__wrap((int)floorf(v * tex->height), tex->height, wrap);
+		swnvg__texel(tex, x, y, out);
+	} else {
+		float fx = u * tex->width - 0.5f, fy = v * tex->height - 0.5f;
+		float x0f = floorf(fx), y0f = floorf(fy);
+		float tx = fx - x0f, ty = fy - y0f;
+		int x0 = swnvg__wrap((int)x0f, tex->width, wrap), x1 = swnvg__wrap((int)x0f + 1, tex->width, wrap);
+		int y0 = swnvg__wrap((int)y0f, tex->height, wrap), y1 = swnvg__wrap((int)y0f + 1, tex->height, wrap);
+		float c00[4], c10[4], c01[4], c11[4];
+		swnvg__texel(tex, x0, y0, c00);
+		swnvg__texel(tex, x1, y0, c10);
+		swnvg__texel(tex, x0, y1, c01);
+		swnvg__texel(tex, x1, y1, c11);
+		for (i = 0; i < 4; i++) {
+			float top = c00[i] + (c10[i] - c00[i]) * tx;
+			float bottom = c01[i] + (c11[i] - c01[i]) * tx;
+			out[i] = top + (bottom - top) * ty;
+		}
+	}
+
+	if (paint->texType == 1) {
+		out[0] *= out[3];
+		out[1] *= out[3];
+		out[2] *= out[3];
+	} else if (paint->texType == 2) {
+		out[1] = out[2] = out[3] = out[0];
+	} else if (paint->texType == 3) {
+		// Distance field alpha, feather holds how fast coverage changes across the outline.
+		out[0] = swnvg__clampf((out[0] - 0.5f) * paint->feather + 0.5f, 0.0f, 1.0f);
+		out[1] = out[2] = out[3] = out[0];
+	}
+}
+
+// Computes the premultiplied color of one pixel, returns 0 if the pixel is discarded.
+static int swnvg__shade(const SWNVGcontext* sw, const SWNVGpaint* paint, float x, float y, float u, float v, float* out)
+{
+	float strokeAlpha = 1.0f, scissor, alpha;
+	float tcol[4];
+	int i;
+
+	if (sw->flags & NVGSW_ANTIALIAS) {
+		strokeAlpha = swnvg__minf(1.0f, (1.0f - fabsf(u*2.0f - 1.0f)) * paint->strokeMult) * swnvg__minf(1.0f, v);
+		if (strokeAlpha < paint->strokeThr) return 0;
+	}
+	scissor = swnvg__scissorMask(paint, x, y);
+
+	if (paint->type == SWNVG_SHADER_FILLGRAD && paint->solid) {
+		alpha = strokeAlpha * scissor;
+		for (i = 0; i < 4; i++)
+			out[i] = paint->innerCol[i] * alpha;
+	} else if (paint->type == SWNVG_SHADER_FILLGRAD) {
+		const float* m = paint->paintMat;
+		float px = m[0]*x + m[2]*y + m[4];
+		float py = m[1]*x + m[3]*y + m[5];
+		float d = swnvg__sdroundrect(px, py, paint->extent[0], paint->extent[1], paint->radius) + paint->feather*0.5f;
+		d = paint->feather > 1e-6f ? swnvg__clampf(d / paint->feather, 0.0f, 1.0f) : (d > 0.0f ? 1.0f : 0.0f);
+		alpha = strokeAlpha * scissor;
+		for (i = 0; i < 4; i++)
+			out[i] = (paint->innerCol[i] + (paint->outerCol[i] - paint->innerCol[i]) * d) * alpha;
+	} else if (paint->type == SWNVG_SHADER_FILLIMG) {
+		const float* m = paint->paintMat;
+		float px = (m[0]*x + m[2]*y + m[4]) / paint->extent[0];
+		float py = (m[1]*x + m[3]*y + m[5]) / paint->extent[1];
+		swnvg__sample(paint, px, py, tcol);
+		alpha = strokeAlpha * scissor;
+		for (i = 0; i < 4; i++)
+			out[i] = tcol[i] * paint->innerCol[i] * alpha;
+	} else if (paint->type == SWNVG_SHADER_IMG) {
+		swnvg__sample(paint, u, v, tcol);
+		for (i = 0; i < 4; i++)
+			out[i] = tcol[i] * scissor * paint->innerCol[i];
+	} else {
+		out[0] = out[1] = out[2] = out[3] = 1.0f;
+	}
+	return 1;
+}
+
+//
+// Blending, follows the GL blend equations on an 8 bit per channel target.
+//
+
+#if NANOVG_SW_SSE2
+static __m128 swnvg__factor4(int factor, __m128 s, __m128 d)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	switch (factor) {
+	case NVG_ZERO: return _mm_setzero_ps();
+	case NVG_SRC_COLOR: return s;
+	case NVG_ONE_MINUS_SRC_COLOR: return _mm_sub_ps(one, s);
+	case NVG_DST_COLOR: return d;
+	case NVG_ONE_MINUS_DST_COLOR: return _mm_sub_ps(one, d);
+	case NVG_SRC_ALPHA: return _mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,3,3));
+	case NVG_ONE_MINUS_SRC_ALPHA: return _mm_sub_ps(one, _mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,3,3)));
+	case NVG_DST_ALPHA: return _mm_shuffle_ps(d, d, _MM_SHUFFLE(3,3,3,3));
+	case NVG_ONE_MINUS_DST_ALPHA: return _mm_sub_ps(one, _mm_shuffle_ps(d, d, _MM_SHUFFLE(3,3,3,3)));
+	case NVG_SRC_ALPHA_SATURATE: {
+		__m128 f = _mm_min_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,3,3)), _mm_sub_ps(one, _mm_shuffle_ps(d, d, _MM_SHUFFLE(3,3,3,3))));
+		const __m128 rgb = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		return _mm_or_ps(_mm_and_ps(rgb, f), _mm_andnot_ps(rgb, one));
+	}
+	default: return one;
+	}
+}
+
+static __m128 swnvg__factorSeparate4(int factorRGB, int factorAlpha, __m128 s, __m128 d)
+{
+	const __m128 rgb = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	__m128 f = swnvg__factor4(factorRGB, s, d);
+	if (factorAlpha == factorRGB) return f;
+	return _mm_or_ps(_mm_and_ps(rgb, f), _mm_andnot_ps(rgb, swnvg__factor4(factorAlpha, s, d)));
+}
+
+static void swnvg__blendSpan(unsigned char* dst, const float* src, const unsigned char* cover, int n, const SWNVGblend* blend)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 to255 = _mm_set1_ps(255.0f);
+	const __m128 from255 = _mm_set1_ps(1.0f/255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	int i;
+
+	for (i = 0; i < n; i++, dst += 4) {
+		__m128 s, d, r;
+		__m128i di, ri;
+		int packed;
+
+		if (!cover[i]) continue;
+		s = _mm_loadu_ps(&src[i*4]);
+		if (blend->sourceOver && src[i*4+3] <= 0.0f &&
+			src[i*4+0] <= 0.0f && src[i*4+1] <= 0.0f && src[i*4+2] <= 0.0f) continue;
+
+		memcpy(&packed, dst, 4);
+		di = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		d = _mm_mul_ps(_mm_cvtepi32_ps(di), from255);
+
+		if (blend->sourceOver) {
+			r = _mm_add_ps(s, _mm_mul_ps(d, _mm_sub_ps(one, _mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,3,3)))));
+		} else if (blend->equation == NVG_BLEND_EQUATION_MIN) {
+			r = _mm_min_ps(s, d);
+		} else if (blend->equation == NVG_BLEND_EQUATION_MAX) {
+			r = _mm_max_ps(s, d);
+		} else {
+			__m128 sf = _mm_mul_ps(s, swnvg__factorSeparate4(blend->srcRGB, blend->srcAlpha, s, d));
+			__m128 df = _mm_mul_ps(d, swnvg__factorSeparate4(blend->dstRGB, blend->dstAlpha, s, d));
+			// NanoVG's subtract is GL_FUNC_REVERSE_SUBTRACT, the source is taken away from the destination.
+			r = blend->equation == NVG_BLEND_EQUATION_SUBTRACT ? _mm_sub_ps(df, sf) : _mm_add_ps(sf, df);
+		}
+
+		r = _mm_min_ps(_mm_max_ps(r, _mm_setzero_ps()), one);
+		ri = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, to255), half));
+		ri = _mm_packus_epi16(_mm_packs_epi32(ri, zero), zero);
+		packed = _mm_cvtsi128_si32(ri);
+		memcpy(dst, &packed, 4);
+	}
+}
+#else
+static float swnvg__factor(int factor, const float* s, const float* d, int c)
+{
+	switch (factor) {
+	case NVG_ZERO: return 0.0f;
+	case NVG_SRC_COLOR: return s[c];
+	case NVG_ONE_MINUS_SRC_COLOR: return 1.0f - s[c];
+	case NVG_DST_COLOR: return d[c];
+	case NVG_ONE_MINUS_DST_COLOR: return 1.0f - d[c];
+	case NVG_SRC_ALPHA: return s[3];
+	case NVG_ONE_MINUS_SRC_ALPHA: return 1.0f - s[3];
+	case NVG_DST_ALPHA: return d[3];
+	case NVG_ONE_MINUS_DST_ALPHA: return 1.0f - d[3];
+	case NVG_SRC_ALPHA_SATURATE: return c == 3 ? 1.0f : swnvg__minf(s[3], 1.0f - d[3]);
+	default: return 1.0f;
+	}
+}
+
+static void swnvg__blendSpan(unsigned char* dst, const float* src, const unsigned char* cover, int n, const SWNVGblend* blend)
+{
+	int i, c;
+
+	for (i = 0; i < n; i++, dst += 4) {
+		const float* s = &src[i*4];
+		float d[4], r[4];
+
+		if (!cover[i]) continue;
+		if (blend->sourceOver && s[0] <= 0.0f && s[1] <= 0.0f && s[2] <= 0.0f && s[3] <= 0.0f) continue;
+
+		for (c = 0; c < 4; c++)
+			d[c] = dst[c] * (1.0f/255.0f);
+
+		for (c = 0; c < 4; c++) {
+			if (blend->sourceOver) {
+				r[c] = s[c] + d[c] * (1.0f - s[3]);
+			} else if (blend->equation == NVG_BLEND_EQUATION_MIN) {
+				r[c] = swnvg__minf(s[c], d[c]);
+			} else if (blend->equation == NVG_BLEND_EQUATION_MAX) {
+				r[c] = swnvg__maxf(s[c], d[c]);
+			} else {
+				float sf = s[c] * swnvg__factor(c == 3 ? blend->srcAlpha : blend->srcRGB, s, d, c);
+				float df = d[c] * swnvg__factor(c == 3 ? blend->dstAlpha : blend->dstRGB, s, d, c);
+				// NanoVG's subtract is GL_FUNC_REVERSE_SUBTRACT, the source is taken away from the destination.
+				r[c] = blend->equation == NVG_BLEND_EQUATION_SUBTRACT ? df - sf : sf + df;
+			}
+		}
+
+		for (c = 0; c < 4; c++)
+			dst[c] = (unsigned char)(swnvg__clampf(r[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+#endif
+
+static SWNVGblend swnvg__blendCompositeOperation(NVGcompositeOperationState op)
+{
+	const int equations = NVG_BLEND_EQUATION_ADD | NVG_BLEND_EQUATION_SUBTRACT | NVG_BLEND_EQUATION_MIN | NVG_BLEND_EQUATION_MAX;
+	const int factors = (NVG_SRC_ALPHA_SATURATE << 1) - 1;
+	SWNVGblend blend;
+	blend.equation = op.blendEquation;
+	blend.srcRGB = op.srcRGB;
+	blend.dstRGB = op.dstRGB;
+	blend.srcAlpha = op.srcAlpha;
+	blend.dstAlpha = op.dstAlpha;
+	if ((blend.equation & equations) == 0 ||
+		(blend.srcRGB & factors) == 0 ||
+		(blend.dstRGB & factors) == 0 ||
+		(blend.srcAlpha & factors) == 0 ||
+		(blend.dstAlpha & factors) == 0)
+	{
+		blend.equation = NVG_BLEND_EQUATION_ADD;
+		blend.srcRGB = NVG_ONE;
+		blend.dstRGB = NVG_ONE_MINUS_SRC_ALPHA;
+		blend.srcAlpha = NVG_ONE;
+		blend.dstAlpha = NVG_ONE_MINUS_SRC_ALPHA;
+	}
+	blend.sourceOver = blend.equation == NVG_BLEND_EQUATION_ADD &&
+		blend.srcRGB == NVG_ONE && blend.srcAlpha == NVG_ONE &&
+		blend.dstRGB == NVG_ONE_MINUS_SRC_ALPHA && blend.dstAlpha == NVG_ONE_MINUS_SRC_ALPHA;
+	return blend;
+}
+
+// Blends one color over a run of pixels, used when the shading is the same for the whole span.
+static void swnvg__fillSpan(unsigned char* dst, const float* color, unsigned char* cover, float* span, int n, const SWNVGblend* blend)
+{
+	int i;
+
+	if (blend->sourceOver && color[3] >= 1.0f) {
+		// Opaque source over replaces the pixels, no need to read them back.
+		unsigned char packed[4];
+		for (i = 0; i < 4; i++)
+			packed[i] = (unsigned char)(swnvg__clampf(color[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+		for (i = 0; i < n; i++)
+			memcpy(&dst[i*4], packed, 4);
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		memcpy(&span[i*4], color, sizeof(float) * 4);
+		cover[i] = 1;
+	}
+	swnvg__blendSpan(dst, span, cover, n, blend);
+}
+
+//
+// Scanline rasterization.
+//
+
+static void swnvg__span(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpass* pass, int y, int x0, int x1,
+						float u, float dudx, float v, float dvdx, int winding)
+{
+	unsigned char* stencil = &tile->stencil[(y - tile->y0) * NANOVG_SW_TILE_SIZE + (x0 - tile->x0)];
+	float fy = (y + 0.5f) / sw->scale[1];
+	float fx = (x0 + 0.5f) / sw->scale[0], dfx = 1.0f / sw->scale[0];
+	int x, n = x1 - x0 + 1, any = 0;
+
+	if (pass->stencilFunc == SWNVG_STENCIL_ALWAYS && pass->stencilOp == SWNVG_STENCIL_KEEP) {
+		// Plain color pass, no stencil to test or update.
+		if (pass->paint == NULL) return;
+		if (dudx == 0.0f && dvdx == 0.0f && pass->paint->type == SWNVG_SHADER_FILLGRAD &&
+			pass->paint->solid && !pass->paint->scissor) {
+			// Flat varyings and a solid paint shade every pixel of the span the same.
+			float color[4];
+			if (swnvg__shade(sw, pass->paint, fx, fy, u, v, color))
+				swnvg__fillSpan(&sw->pixels[(y * sw->width + x0) * 4], color, tile->cover, tile->span, n, pass->blend);
+			return;
+		}
+		for (x = 0; x < n; x++, fx += dfx, u += dudx, v += dvdx) {
+			tile->cover[x] = (unsigned char)swnvg__shade(sw, pass->paint, fx, fy, u, v, &tile->span[x*4]);
+			any |= tile->cover[x];
+		}
+		if (any)
+			swnvg__blendSpan(&sw->pixels[(y * sw->width + x0) * 4], tile->span, tile->cover, n, pass->blend);
+		return;
+	}
+
+	for (x = 0; x < n; x++, fx += dfx, u += dudx, v += dvdx) {
+		unsigned char* st = &stencil[x];
+		tile->cover[x] = 0;
+
+		if ((pass->stencilFunc == SWNVG_STENCIL_EQUAL_ZERO && *st != 0) ||
+			(pass->stencilFunc == SWNVG_STENCIL_NOTEQUAL_ZERO && *st == 0)) {
+			if (pass->stencilOp == SWNVG_STENCIL_ZERO) *st = 0;
+			continue;
+		}
+
+		if (pass->paint != NULL) {
+			if (!swnvg__shade(sw, pass->paint, fx, fy, u, v, &tile->span[x*4])) continue;
+			tile->cover[x] = 1;
+			any = 1;
+		}
+
+		if (pass->stencilOp == SWNVG_STENCIL_INCR) {
+			if (*st < 255) (*st)++;
+		} else if (pass->stencilOp == SWNVG_STENCIL_ZERO) {
+			*st = 0;
+		} else if (pass->stencilOp == SWNVG_STENCIL_WINDING) {
+			*st = (unsigned char)(*st + winding);
+		}
+	}
+
+	if (any)
+		swnvg__blendSpan(&sw->pixels[(y * sw->width + x0) * 4], tile->span, tile->cover, n, pass->blend);
+}
+
+// Finds the pixels of a row whose centers are inside all edges, returns 0 if there are none.
+static int swnvg__edgeSpan(const SWNVGtile* tile, const float* ea, const float* eb, const float* ec, const float* inva,
+						   const int* incl, int nedges, float yc, int* x0, int* x1)
+{
+	float lo = (float)tile->x0 - 1.0f, hi = (float)tile->x1 + 1.0f;
+	int xl = tile->x0, xr = tile->x1 - 1, i;
+
+	for (i = 0; i < nedges; i++) {
+		float val = eb[i] * yc + ec[i];
+		if (ea[i] > 0.0f) {
+			float t = swnvg__clampf(-val * inva[i] - 0.5f, lo, hi);
+			xl = swnvg__maxi(xl, incl[i] ? (int)ceilf(t) : (int)floorf(t) + 1);
+		} else if (ea[i] < 0.0f) {
+			float t = swnvg__clampf(-val * inva[i] - 0.5f, lo, hi);
+			xr = swnvg__mini(xr, incl[i] ? (int)floorf(t) : (int)ceilf(t) - 1);
+		} else if (val < 0.0f || (val == 0.0f && !incl[i])) {
+			return 0;
+		}
+		if (xl > xr) return 0;
+	}
+
+	*x0 = xl;
+	*x1 = xr;
+	return 1;
+}
+
+// Rasterizes one triangle into the tile. Pixels are covered when their center is inside the triangle,
+// with a top-left rule on the edges so triangles sharing an edge never cover a pixel twice.
+static void swnvg__triangle(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpass* pass,
+							const NVGvertex* a, const NVGvertex* b, const NVGvertex* c)
+{
+	float x[3], y[3], u[3], v[3];
+	float ea[3], eb[3], ec[3], inva[3];
+	int incl[3];
+	float area, dudx, dudy, dvdx, dvdy, miny, maxy;
+	int i, py, y0, y1, winding;
+
+	x[0] = a->x * sw->scale[0]; y[0] = a->y * sw->scale[1]; u[0] = a->u; v[0] = a->v;
+	x[1] = b->x * sw->scale[0]; y[1] = b->y * sw->scale[1]; u[1] = b->u; v[1] = b->v;
+	x[2] = c->x * sw->scale[0]; y[2] = c->y * sw->scale[1]; u[2] = c->u; v[2] = c->v;
+
+	// Render space has y pointing down, so a negative area is counter clockwise in GL terms and front facing.
+	area = (x[1]-x[0])*(y[2]-y[0]) - (y[1]-y[0])*(x[2]-x[0]);
+	if (area == 0.0f || (pass->cull && area > 0.0f)) return;
+	winding = area < 0.0f ? 1 : -1;
+	if (area < 0.0f) {
+		float t;
+		t = x[1]; x[1] = x[2]; x[2] = t;
+		t = y[1]; y[1] = y[2]; y[2] = t;
+		t = u[1]; u[1] = u[2]; u[2] = t;
+		t = v[1]; v[1] = v[2]; v[2] = t;
+		area = -area;
+	}
+
+	miny = swnvg__minf(y[0], swnvg__minf(y[1], y[2]));
+	maxy = swnvg__maxf(y[0], swnvg__maxf(y[1], y[2]));
+	y0 = swnvg__maxi(tile->y0, (int)ceilf(swnvg__maxf(miny - 0.5f, (float)tile->y0 - 1.0f)));
+	y1 = swnvg__mini(tile->y1 - 1, (int)floorf(swnvg__minf(maxy - 0.5f, (float)tile->y1 + 1.0f)));
+	if (y0 > y1) return;
+
+	// Edge functions ea*x + eb*y + ec, positive inside.
+	for (i = 0; i < 3; i++) {
+		int j = (i + 1) % 3;
+		ea[i] = y[i] - y[j];
+		eb[i] = x[j] - x[i];
+		ec[i] = -(ea[i] * x[i] + eb[i] * y[i]);
+		incl[i] = ea[i] > 0.0f || (ea[i] == 0.0f && eb[i] > 0.0f);
+		inva[i] = ea[i] != 0.0f ? 1.0f / ea[i] : 0.0f;
+	}
+
+	// Attribute gradients.
+	dudx = ((u[1]-u[0])*(y[2]-y[0]) - (u[2]-u[0])*(y[1]-y[0])) / area;
+	dudy = ((u[2]-u[0])*(x[1]-x[0]) - (u[1]-u[0])*(x[2]-x[0])) / area;
+	dvdx = ((v[1]-v[0])*(y[2]-y[0]) - (v[2]-v[0])*(y[1]-y[0])) / area;
+	dvdy = ((v[2]-v[0])*(x[1]-x[0]) - (v[1]-v[0])*(x[2]-x[0])) / area;
+
+	for (py = y0; py <= y1; py++) {
+		float yc = py + 0.5f, xc, uc, vc;
+		int xl, xr;
+
+		if (!swnvg__edgeSpan(tile, ea, eb, ec, inva, incl, 3, yc, &xl, &xr)) continue;
+		xc = xl + 0.5f;
+		uc = u[0] + dudx * (xc - x[0]) + dudy * (yc - y[0]);
+		vc = v[0] + dvdx * (xc - x[0]) + dvdy * (yc - y[0]);
+		swnvg__span(sw, tile, pass, py, xl, xr, uc, dudx, vc, dvdx, winding);
+	}
+}
+
+// Rasterizes the fan of a convex path as one polygon, which covers the same pixels as its triangles
+// but needs a single span per row. Returns 0 if the fan has to be drawn as triangles.
+static int swnvg__convexPolygon(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpass* pass, const NVGvertex* verts, int count)
+{
+	float ea[NANOVG_SW_MAX_POLYGON], eb[NANOVG_SW_MAX_POLYGON], ec[NANOVG_SW_MAX_POLYGON], inva[NANOVG_SW_MAX_POLYGON];
+	int incl[NANOVG_SW_MAX_POLYGON];
+	float area = 0.0f, miny = 1e30f, maxy = -1e30f, dir;
+	int i, py, y0, y1;
+
+	if (count < 3 || count > NANOVG_SW_MAX_POLYGON) return 0;
+	for (i = 1; i < count; i++) {
+		// The fan is only a flat polygon when all vertices share the same varyings.
+		if (verts[i].u != verts[0].u || verts[i].v != verts[0].v) return 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		const NVGvertex* a = &verts[i];
+		const NVGvertex* b = &verts[(i + 1) % count];
+		float ax = a->x * sw->scale[0], ay = a->y * sw->scale[1];
+		float bx = b->x * sw->scale[0], by = b->y * sw->scale[1];
+		area += ax*by - bx*ay;
+		ea[i] = ay - by;
+		eb[i] = bx - ax;
+		ec[i] = -(ea[i] * ax + eb[i] * ay);
+		miny = swnvg__minf(miny, ay);
+		maxy = swnvg__maxf(maxy, ay);
+	}
+	if (area == 0.0f) return 1;
+	if (pass->cull && area > 0.0f) return 1;
+
+	// Orient the edges so the inside is positive, same as swapping the triangle vertices.
+	dir = area < 0.0f ? -1.0f : 1.0f;
+	for (i = 0; i < count; i++) {
+		ea[i] *= dir;
+		eb[i] *= dir;
+		ec[i] *= dir;
+		incl[i] = ea[i] > 0.0f || (ea[i] == 0.0f && eb[i] > 0.0f);
+		inva[i] = ea[i] != 0.0f ? 1.0f / ea[i] : 0.0f;
+	}
+
+	y0 = swnvg__maxi(tile->y0, (int)ceilf(swnvg__maxf(miny - 0.5f, (float)tile->y0 - 1.0f)));
+	y1 = swnvg__mini(tile->y1 - 1, (int)floorf(swnvg__minf(maxy - 0.5f, (float)tile->y1 + 1.0f)));
+
+	for (py = y0; py <= y1; py++) {
+		int xl, xr;
+		if (!swnvg__edgeSpan(tile, ea, eb, ec, inva, incl, count, py + 0.5f, &xl, &xr)) continue;
+		swnvg__span(sw, tile, pass, py, xl, xr, verts[0].u, 0.0f, verts[0].v, 0.0f, area < 0.0f ? 1 : -1);
+	}
+	return 1;
+}
+
+static void swnvg__triangleStrip(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpass* pass, const NVGvertex* verts, int count)
+{
+	int i;
+	for (i = 0; i + 2 < count; i++) {
+		// Every other triangle of a strip is reversed to keep the facing of the strip.
+		if (i & 1)
+			swnvg__triangle(sw, tile, pass, &verts[i+1], &verts[i], &verts[i+2]);
+		else
+			swnvg__triangle(sw, tile, pass, &verts[i], &verts[i+1], &verts[i+2]);
+	}
+}
+
+static void swnvg__triangleFan(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpass* pass, const NVGvertex* verts, int count)
+{
+	int i;
+	for (i = 1; i + 1 < count; i++)
+		swnvg__triangle(sw, tile, pass, &verts[0], &verts[i], &verts[i+1]);
+}
+
+static void swnvg__quad(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGpaint* scissor, const SWNVGblend* blend, const SWNVGquad* quad)
+{
+	const float* m = quad->invxform;
+	int x0 = swnvg__maxi(tile->x0, quad->bounds[0]), x1 = swnvg__mini(tile->x1, quad->bounds[2]);
+	int y0 = swnvg__maxi(tile->y0, quad->bounds[1]), y1 = swnvg__mini(tile->y1, quad->bounds[3]);
+	float ex = quad->extent[0], ey = quad->extent[1];
+	// Shape space units per pixel along each axis, for the bevel distance.
+	float ux = sqrtf(m[0]*m[0] / (sw->scale[0]*sw->scale[0]) + m[2]*m[2] / (sw->scale[1]*sw->scale[1]));
+	float uy = sqrtf(m[1]*m[1] / (sw->scale[0]*sw->scale[0]) + m[3]*m[3] / (sw->scale[1]*sw->scale[1]));
+	int x, y;
+
+	if (x0 >= x1 || y0 >= y1) return;
+
+	for (y = y0; y < y1; y++) {
+		float fy = (y + 0.5f) / sw->scale[1];
+		int any = 0;
+		for (x = x0; x < x1; x++) {
+			float fx = (x + 0.5f) / sw->scale[0];
+			float lx = m[0]*fx + m[2]*fy + m[4];
+			float ly = m[1]*fx + m[3]*fy + m[5];
+			float f, gx, gy, gpx, gpy, d, alpha;
+			float* out = &tile->span[(x - x0)*4];
+			int i;
+
+			tile->cover[x - x0] = 0;
+			if (fabsf(lx) > ex + quad->pad[0] || fabsf(ly) > ey + quad->pad[1]) continue;
+
+			// Distance to the outline in pixels, see the quad fragment shader of the GL back-end.
+			if (quad->shape == NVG_QUAD_RECT) {
+				float qx = fabsf(lx) - ex, qy = fabsf(ly) - ey;
+				if (qx > qy) { f = qx; gx = lx < 0.0f ? -1.0f : 1.0f; gy = 0.0f; }
+				else { f = qy; gx = 0.0f; gy = ly < 0.0f ? -1.0f : 1.0f; }
+			} else {
+				float nx = lx / ex, ny = ly / ey;
+				float len = sqrtf(nx*nx + ny*ny);
+				f = len - 1.0f;
+				if (len > 1e-6f) { gx = nx / (ex * len); gy = ny / (ey * len); }
+				else { gx = 1.0f / ex; gy = 0.0f; }
+			}
+			gpx = (gx*m[0] + gy*m[1]) / sw->scale[0];
+			gpy = (gx*m[2] + gy*m[3]) / sw->scale[1];
+			d = f / swnvg__maxf(sqrtf(gpx*gpx + gpy*gpy), 1e-6f);
+
+			if (sw->flags & NVGSW_ANTIALIAS) {
+				alpha = quad->strokeWidth > 0.0f ? swnvg__clampf(0.5f + 0.5f*quad->strokeWidth - fabsf(d), 0.0f, 1.0f)
+												 : swnvg__clampf(0.5f - d, 0.0f, 1.0f);
+			} else {
+				alpha = quad->strokeWidth > 0.0f ? (fabsf(d) <= 0.5f*quad->strokeWidth ? 1.0f : 0.0f)
+												 : (d <= 0.0f ? 1.0f : 0.0f);
+			}
+			if (quad->bevel) {
+				// Cut the corners along the line through the outer stroke corners of both edges.
+				float qx = (fabsf(lx) - ex) / swnvg__maxf(ux, 1e-6f), qy = (fabsf(ly) - ey) / swnvg__maxf(uy, 1e-6f);
+				float bevel = (qx + qy - 0.5f*quad->strokeWidth) * 0.70710678f;
+				alpha *= (sw->flags & NVGSW_ANTIALIAS) ? swnvg__clampf(0.5f - bevel, 0.0f, 1.0f) : (bevel <= 0.0f ? 1.0f : 0.0f);
+			}
+			alpha *= swnvg__scissorMask(scissor, fx, fy);
+			for (i = 0; i < 4; i++)
+				out[i] = quad->color[i] * alpha;
+			tile->cover[x - x0] = 1;
+			any = 1;
+		}
+		if (any)
+			swnvg__blendSpan(&sw->pixels[(y * sw->width + x0) * 4], tile->span, tile->cover, x1 - x0, blend);
+	}
+}
+
+static void swnvg__clearStencil(SWNVGtile* tile, const int* bounds)
+{
+	int x0 = swnvg__maxi(tile->x0, bounds[0]), x1 = swnvg__mini(tile->x1, bounds[2]);
+	int y0 = swnvg__maxi(tile->y0, bounds[1]), y1 = swnvg__mini(tile->y1, bounds[3]);
+	int y;
+	for (y = y0; y < y1 && x0 < x1; y++)
+		memset(&tile->stencil[(y - tile->y0) * NANOVG_SW_TILE_SIZE + (x0 - tile->x0)], 0, x1 - x0);
+}
+
+static void swnvg__renderCall(const SWNVGcontext* sw, SWNVGtile* tile, const SWNVGcall* call)
+{
+	const SWNVGpath* paths = &sw->paths[call->pathOffset];
+	SWNVGpass pass;
+	int i;
+
+	memset(&pass, 0, sizeof(pass));
+	pass.blend = &call->blend;
+	pass.cull = 1;
+
+	if (call->type == SWNVG_FILL) {
+		// Winding into the stencil.
+		pass.stencilOp = SWNVG_STENCIL_WINDING;
+		pass.cull = 0;
+		for (i = 0; i < call->pathCount; i++)
+			swnvg__triangleFan(sw, tile, &pass, &sw->verts[paths[i].fillOffset], paths[i].fillCount);
+		pass.cull = 1;
+		pass.paint = &sw->paints[call->paintOffset];
+		// Anti-aliased fringes outside of the fill.
+		if (sw->flags & NVGSW_ANTIALIAS) {
+			pass.stencilFunc = SWNVG_STENCIL_EQUAL_ZERO;
+			pass.stencilOp = SWNVG_STENCIL_KEEP;
+			for (i = 0; i < call->pathCount; i++)
+				swnvg__triangleStrip(sw, tile, &pass, &sw->verts[paths[i].strokeOffset], paths[i].strokeCount);
+		}
+		// Cover the fill and clear the stencil.
+		pass.stencilFunc = SWNVG_STENCIL_NOTEQUAL_ZERO;
+		pass.stencilOp = SWNVG_STENCIL_ZERO;
+		swnvg__triangleStrip(sw, tile, &pass, &sw->verts[call->triangleOffset], call->triangleCount);
+	} else if (call->type == SWNVG_CONVEXFILL) {
+		pass.paint = &sw->paints[call->paintOffset];
+		for (i = 0; i < call->pathCount; i++) {
+			if (!swnvg__convexPolygon(sw, tile, &pass, &sw->verts[paths[i].fillOffset], paths[i].fillCount))
+				swnvg__triangleFan(sw, tile, &pass, &sw->verts[paths[i].fillOffset], paths[i].fillCount);
+		}
+		if (sw->flags & NVGSW_ANTIALIAS) {
+			for (i = 0; i < call->pathCount; i++)
+				swnvg__triangleStrip(sw, tile, &pass, &sw->verts[paths[i].strokeOffset], paths[i].strokeCount);
+		}
+	} else if (call->type == SWNVG_STROKE) {
+		if (sw->flags & NVGSW_STENCIL_STROKES) {
+			// Fill the stroke base without overlap.
+			pass.paint = &sw->paints[call->paintOffset + 1];
+			pass.stencilFunc = SWNVG_STENCIL_EQUAL_ZERO;
+			pass.stencilOp = SWNVG_STENCIL_INCR;
+			for (i = 0; i < call->pathCount; i++)
+				swnvg__triangleStrip(sw, tile, &pass, &sw->verts[paths[i].strokeOffset], paths[i].strokeCount);
+			// Draw anti-aliased pixels.
+			pass.paint = &sw->paints[call->paintOffset];
+			pass.stencilOp = SWNVG_STENCIL_KEEP;
+			for (i = 0; i < call->pathCount; i++)
+				swnvg__triangleStrip(sw, tile, &pass, &sw->verts[paths[i].strokeOffset], paths[i].strokeCount);
+			// Clear the stencil, everything the stroke touched is inside its bounds.
+			swnvg__clearStencil(tile, call->bounds);
+		} else {
+			pass.paint = &sw->paints[call->paintOffset];
+			for (i = 0; i < call->pathCount; i++)
+				swnvg__triangleStrip(sw, tile, &pass, &sw->verts[paths[i].strokeOffset], paths[i].strokeCount);
+		}
+	} else if (call->type == SWNVG_TRIANGLES) {
+		pass.paint = &sw->paints[call->paintOffset];
+		for (i = 0; i + 2 < call->triangleCount; i += 3) {
+			const NVGvertex* tri = &sw->verts[call->triangleOffset + i];
+			swnvg__triangle(sw, tile, &pass, &tri[0], &tri[1], &tri[2]);
+		}
+	} else if (call->type == SWNVG_QUADS) {
+		for (i = 0; i < call->instanceCount; i++)
+			swnvg__quad(sw, tile, &sw->paints[call->paintOffset], &call->blend, &sw->quads[call->instanceOffset + i]);
+	}
+}
+
+static void swnvg__renderTile(SWNVGcontext* sw, SWNVGtile* tile, int index)
+{
+	int tx = index % sw->ntilesX, ty = index / sw->ntilesX;
+	int i;
+
+	tile->x0 = tx * NANOVG_SW_TILE_SIZE;
+	tile->y0 = ty * NANOVG_SW_TILE_SIZE;
+	tile->x1 = swnvg__mini(tile->x0 + NANOVG_SW_TILE_SIZE, sw->width);
+	tile->y1 = swnvg__mini(tile->y0 + NANOVG_SW_TILE_SIZE, sw->height);
+	if (sw->clip[2] >= 0) {
+		// Stencil offsets stay relative to the clipped corner, which only shrinks the tile.
+		tile->x0 = swnvg__maxi(tile->x0, sw->clip[0]);
+		tile->y0 = swnvg__maxi(tile->y0, sw->clip[1]);
+		tile->x1 = swnvg__mini(tile->x1, sw->clip[0] + sw->clip[2]);
+		tile->y1 = swnvg__mini(tile->y1, sw->clip[1] + sw->clip[3]);
+		if (tile->x1 <= tile->x0 || tile->y1 <= tile->y0) return;
+	}
+	memset(tile->stencil, 0, NANOVG_SW_TILE_SIZE * NANOVG_SW_TILE_SIZE);
+
+	for (i = sw->binOffsets[index]; i < sw->binOffsets[index+1]; i++)
+		swnvg__renderCall(sw, tile, &sw->calls[sw->bins[i]]);
+}
+
+//
+// Tile workers.
+//
+
+static int swnvg__worker(void* arg)
+{
+	SWNVGworker* worker = (SWNVGworker*)arg;
+	SWNVGcontext* sw = worker->sw;
+	int seen = 0;
+
+	mtx_lock(&sw->lock);
+	for (;;) {
+		while (sw->generation == seen && !sw->quit)
+			cnd_wait(&sw->wake, &sw->lock);
+		if (sw->quit) break;
+		seen = sw->generation;
+
+		sw->active++;
+		while (sw->nextTile < sw->ntiles) {
+			int index = sw->nextTile++;
+			mtx_unlock(&sw->lock);
+			swnvg__renderTile(sw, &worker->tile, index);
+			mtx_lock(&sw->lock);
+		}
+		sw->active--;
+		if (sw->active == 0)
+			cnd_broadcast(&sw->done);
+	}
+	mtx_unlock(&sw->lock);
+	return 0;
+}
+
+static void swnvg__renderTiles(SWNVGcontext* sw)
+{
+	int i;
+
+	if (sw->nworkers == 0) {
+		for (i = 0; i < sw->ntiles; i++)
+			swnvg__renderTile(sw, &sw->tile, i);
+		return;
+	}
+
+	mtx_lock(&sw->lock);
+	sw->nextTile = 0;
+	sw->generation++;
+	cnd_broadcast(&sw->wake);
+
+	// The calling thread works on tiles too.
+	while (sw->nextTile < sw->ntiles) {
+		int index = sw->nextTile++;
+		mtx_unlock(&sw->lock);
+		swnvg__renderTile(sw, &sw->tile, index);
+		mtx_lock(&sw->lock);
+	}
+	while (sw->active > 0)
+		cnd_wait(&sw->done, &sw->lock);
+	mtx_unlock(&sw->lock);
+}
+
+//
+// Binning.
+//
+
+static int swnvg__binCalls(SWNVGcontext* sw)
+{
+	int ntiles, i, tx, ty, total = 0;
+
+	sw->ntilesX = (sw->width + NANOVG_SW_TILE_SIZE - 1) / NANOVG_SW_TILE_SIZE;
+	sw->ntilesY = (sw->height + NANOVG_SW_TILE_SIZE - 1) / NANOVG_SW_TILE_SIZE;
+	ntiles = sw->ntilesX * sw->ntilesY;
+
+	if (ntiles + 1 > sw->cbinOffsets) {
+		int* offsets = (int*)realloc(sw->binOffsets, sizeof(int) * (ntiles + 1));
+		if (offsets == NULL) return 0;
+		sw->binOffsets = offsets;
+		sw->cbinOffsets = ntiles + 1;
+	}
+	memset(sw->binOffsets, 0, sizeof(int) * (ntiles + 1));
+
+	// Count the calls per tile, then turn the counts into offsets.
+	for (i = 0; i < sw->ncalls; i++) {
+		const int* b = sw->calls[i].bounds;
+		if (b[0] >= b[2] || b[1] >= b[3]) continue;
+		for (ty = b[1] / NANOVG_SW_TILE_SIZE; ty <= (b[3] - 1) / NANOVG_SW_TILE_SIZE; ty++)
+			for (tx = b[0] / NANOVG_SW_TILE_SIZE; tx <= (b[2] - 1) / NANOVG_SW_TILE_SIZE; tx++)
+				sw->binOffsets[ty * sw->ntilesX + tx + 1]++;
+	}
+	for (i = 0; i < ntiles; i++) {
+		total += sw->binOffsets[i + 1];
+		sw->binOffsets[i + 1] = total;
+	}
+
+	if (total > sw->cbins) {
+		int cbins = swnvg__maxi(total, 1024) + sw->cbins/2; // 1.5x Overallocate
+		int* bins = (int*)realloc(sw->bins, sizeof(int) * cbins);
+		if (bins == NULL) return 0;
+		sw->bins = bins;
+		sw->cbins = cbins;
+	}
+
+	// Fill the bins in call order, using the start offsets as write cursors and restoring them afterwards.
+	for (i = 0; i < sw->ncalls; i++) {
+		const int* b = sw->calls[i].bounds;
+		if (b[0] >= b[2] || b[1] >= b[3]) continue;
+		for (ty = b[1] / NANOVG_SW_TILE_SIZE; ty <= (b[3] - 1) / NANOVG_SW_TILE_SIZE; ty++)
+			for (tx = b[0] / NANOVG_SW_TILE_SIZE; tx <= (b[2] - 1) / NANOVG_SW_TILE_SIZE; tx++)
+				sw->bins[sw->binOffsets[ty * sw->ntilesX + tx]++] = i;
+	}
+	for (i = ntiles; i > 0; i--)
+		sw->binOffsets[i] = sw->binOffsets[i - 1];
+	sw->binOffsets[0] = 0;
+
+	sw->ntiles = ntiles;
+	return 1;
+}
+
+static void swnvg__vertexBounds(const SWNVGcontext* sw, const NVGvertex* verts, int count, float* bounds)
+{
+	int i;
+	for (i = 0; i < count; i++) {
+		bounds[0] = swnvg__minf(bounds[0], verts[i].x);
+		bounds[1] = swnvg__minf(bounds[1], verts[i].y);
+		bounds[2] = swnvg__maxf(bounds[2], verts[i].x);
+		bounds[3] = swnvg__maxf(bounds[3], verts[i].y);
+	}
+	NVG_NOTUSED(sw);
+}
+
+static void swnvg__setPixelBounds(const SWNVGcontext* sw, const float* bounds, int* out)
+{
+	// One pixel of margin, pixel centers on the edge are decided by the rasterizer.
+	out[0] = (int)floorf(swnvg__clampf(bounds[0] * sw->scale[0], -1.0f, (float)sw->width + 1.0f)) - 1;
+	out[1] = (int)floorf(swnvg__clampf(bounds[1] * sw->scale[1], -1.0f, (float)sw->height + 1.0f)) - 1;
+	out[2] = (int)ceilf(swnvg__clampf(bounds[2] * sw->scale[0], -1.0f, (float)sw->width + 1.0f)) + 1;
+	out[3] = (int)ceilf(swnvg__clampf(bounds[3] * sw->scale[1], -1.0f, (float)sw->height + 1.0f)) + 1;
+	out[0] = swnvg__maxi(out[0], 0);
+	out[1] = swnvg__maxi(out[1], 0);
+	out[2] = swnvg__mini(out[2], sw->width);
+	out[3] = swnvg__mini(out[3], sw->height);
+}
+
+//
+// Render API.
+//
+
+static int swnvg__renderCreate(void* uptr)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	NVG_NOTUSED(sw);
+	return 1;
+}
+
+static int swnvg__renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__allocTexture(sw);
+	int bpp = type == NVG_TEXTURE_RGBA ? 4 : 1;
+
+	if (tex == NULL) return 0;
+
+	tex->width = w;
+	tex->height = h;
+	tex->type = type;
+	tex->flags = imageFlags;
+	tex->data = (unsigned char*)malloc((size_t)w * h * bpp);
+	if (tex->data == NULL) {
+		swnvg__deleteTexture(sw, tex->id);
+		return 0;
+	}
+	if (data != NULL)
+		memcpy(tex->data, data, (size_t)w * h * bpp);
+	else
+		memset(tex->data, 0, (size_t)w * h * bpp);
+
+	// Mipmaps are not generated, minification always samples the base level.
+	return tex->id;
+}
+
+static int swnvg__renderDeleteTexture(void* uptr, int image)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	return swnvg__deleteTexture(sw, image);
+}
+
+static int swnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__findTexture(sw, image);
+	int bpp, row;
+
+	if (tex == NULL) return 0;
+	bpp = tex->type == NVG_TEXTURE_RGBA ? 4 : 1;
+
+	// Like the GL back-end, data holds the whole image and only the given rectangle is copied.
+	for (row = y; row < y + h; row++) {
+		size_t offset = ((size_t)row * tex->width + x) * bpp;
+		memcpy(&tex->data[offset], &data[offset], (size_t)w * bpp);
+	}
+
+	return 1;
+}
+
+static int swnvg__renderGetTexturePixelData(void* uptr, int image, unsigned char* data)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__findTexture(sw, image);
+	int i, n;
+
+	if (tex == NULL) return 0;
+	n = tex->width * tex->height;
+	if (tex->type == NVG_TEXTURE_RGBA) {
+		memcpy(data, tex->data, (size_t)n * 4);
+	} else {
+		for (i = 0; i < n; i++) {
+			data[i*4+0] = tex->data[i];
+			data[i*4+1] = 0;
+			data[i*4+2] = 0;
+			data[i*4+3] = 255;
+		}
+	}
+
+	return 1;
+}
+
+static int swnvg__renderGetTextureSize(void* uptr, int image, int* w, int* h)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGtexture* tex = swnvg__findTexture(sw, image);
+	if (tex == NULL) return 0;
+	*w = tex->width;
+	*h = tex->height;
+	return 1;
+}
+
+static void swnvg__xformToMat2x3(float* m, const float* t)
+{
+	memcpy(m, t, sizeof(float) * 6);
+}
+
+static void swnvg__premulColor(float* out, NVGcolor c)
+{
+	out[0] = c.r * c.a;
+	out[1] = c.g * c.a;
+	out[2] = c.b * c.a;
+	out[3] = c.a;
+}
+
+static int swnvg__convertPaint(SWNVGcontext* sw, SWNVGpaint* frag, NVGpaint* paint,
+							   NVGscissor* scissor, float width, float fringe, float strokeThr)
+{
+	SWNVGtexture* tex = NULL;
+	float invxform[6];
+
+	memset(frag, 0, sizeof(*frag));
+
+	swnvg__premulColor(frag->innerCol, paint->innerColor);
+	swnvg__premulColor(frag->outerCol, paint->outerColor);
+
+	if (scissor->extent[0] < -0.5f || scissor->extent[1] < -0.5f) {
+		memset(frag->scissorMat, 0, sizeof(frag->scissorMat));
+		frag->scissorExt[0] = 1.0f;
+		frag->scissorExt[1] = 1.0f;
+		frag->scissorScale[0] = 1.0f;
+		frag->scissorScale[1] = 1.0f;
+	} else {
+		nvgTransformInverse(invxform, scissor->xform);
+		swnvg__xformToMat2x3(frag->scissorMat, invxform);
+		frag->scissorExt[0] = scissor->extent[0];
+		frag->scissorExt[1] = scissor->extent[1];
+		frag->scissorScale[0] = sqrtf(scissor->xform[0]*scissor->xform[0] + scissor->xform[2]*scissor->xform[2]) / fringe;
+		frag->scissorScale[1] = sqrtf(scissor->xform[1]*scissor->xform[1] + scissor->xform[3]*scissor->xform[3]) / fringe;
+		frag->scissor = 1;
+	}
+
+	memcpy(frag->extent, paint->extent, sizeof(frag->extent));
+	frag->strokeMult = (width*0.5f + fringe*0.5f) / fringe;
+	frag->strokeThr = strokeThr;
+	frag->textureFilterMode = paint->textureFilterMode;
+	frag->textureWrapMode = paint->textureWrapMode;
+
+	if (paint->image != 0) {
+		tex = swnvg__findTexture(sw, paint->image);
+		if (tex == NULL) return 0;
+		if ((tex->flags & NVG_IMAGE_FLIPY) != 0) {
+			float m1[6], m2[6];
+			nvgTransformTranslate(m1, 0.0f, frag->extent[1] * 0.5f);
+			nvgTransformMultiply(m1, paint->xform);
+			nvgTransformScale(m2, 1.0f, -1.0f);
+			nvgTransformMultiply(m2, m1);
+			nvgTransformTranslate(m1, 0.0f, -frag->extent[1] * 0.5f);
+			nvgTransformMultiply(m1, m2);
+			nvgTransformInverse(invxform, m1);
+		} else {
+			nvgTransformInverse(invxform, paint->xform);
+		}
+		frag->type = SWNVG_SHADER_FILLIMG;
+		frag->image = paint->image;
+
+		if (tex->type == NVG_TEXTURE_RGBA)
+			frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
+		else
+			frag->texType = paint->sdfScale > 0.0f ? 3 : 2;
+		frag->feather = paint->sdfScale;
+	} else {
+		frag->type = SWNVG_SHADER_FILLGRAD;
+		frag->radius = paint->radius;
+		frag->feather = paint->feather;
+		frag->solid = memcmp(frag->innerCol, frag->outerCol, sizeof(frag->innerCol)) == 0;
+		nvgTransformInverse(invxform, paint->xform);
+	}
+
+	swnvg__xformToMat2x3(frag->paintMat, invxform);
+
+	return 1;
+}
+
+static void swnvg__renderViewport(void* uptr, int width, int height, float devicePixelRatio)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	NVG_NOTUSED(devicePixelRatio);
+	sw->view[0] = (float)width;
+	sw->view[1] = (float)height;
+	sw->scale[0] = width > 0 ? (float)sw->width / (float)width : 1.0f;
+	sw->scale[1] = height > 0 ? (float)sw->height / (float)height : 1.0f;
+}
+
+static void swnvg__renderCancel(void* uptr) {
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	sw->nverts = 0;
+	sw->npaths = 0;
+	sw->ncalls = 0;
+	sw->npaints = 0;
+	sw->nquads = 0;
+}
+
+static void swnvg__renderFlush(void* uptr)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	int i;
+
+	if (sw->ncalls > 0 && sw->pixels != NULL) {
+		// Textures can't change while the tiles are rendered, resolve them once.
+		for (i = 0; i < sw->npaints; i++)
+			sw->paints[i].tex = sw->paints[i].image != 0 ? swnvg__findTexture(sw, sw->paints[i].image) : NULL;
+
+		if (swnvg__binCalls(sw))
+			swnvg__renderTiles(sw);
+	}
+
+	// Reset calls
+	sw->nverts = 0;
+	sw->npaths = 0;
+	sw->ncalls = 0;
+	sw->npaints = 0;
+	sw->nquads = 0;
+}
+
+static int swnvg__maxVertCount(const NVGpath* paths, int npaths)
+{
+	int i, count = 0;
+	for (i = 0; i < npaths; i++) {
+		count += paths[i].nfill;
+		count += paths[i].nstroke;
+	}
+	return count;
+}
+
+static SWNVGcall* swnvg__allocCall(SWNVGcontext* sw)
+{
+	SWNVGcall* ret = NULL;
+	if (sw->ncalls+1 > sw->ccalls) {
+		SWNVGcall* calls;
+		int ccalls = swnvg__maxi(sw->ncalls+1, 128) + sw->ccalls/2; // 1.5x Overallocate
+		calls = (SWNVGcall*)realloc(sw->calls, sizeof(SWNVGcall) * ccalls);
+		if (calls == NULL) return NULL;
+		sw->calls = calls;
+		sw->ccalls = ccalls;
+	}
+	ret = &sw->calls[sw->ncalls++];
+	memset(ret, 0, sizeof(SWNVGcall));
+	return ret;
+}
+
+static int swnvg__allocPaths(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->npaths+n > sw->cpaths) {
+		SWNVGpath* paths;
+		int cpaths = swnvg__maxi(sw->npaths + n, 128) + sw->cpaths/2; // 1.5x Overallocate
+		paths = (SWNVGpath*)realloc(sw->paths, sizeof(SWNVGpath) * cpaths);
+		if (paths == NULL) return -1;
+		sw->paths = paths;
+		sw->cpaths = cpaths;
+	}
+	ret = sw->npaths;
+	sw->npaths += n;
+	return ret;
+}
+
+static int swnvg__allocVerts(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->nverts+n > sw->cverts) {
+		NVGvertex* verts;
+		int cverts = swnvg__maxi(sw->nverts + n, 4096) + sw->cverts/2; // 1.5x Overallocate
+		verts = (NVGvertex*)realloc(sw->verts, sizeof(NVGvertex) * cverts);
+		if (verts == NULL) return -1;
+		sw->verts = verts;
+		sw->cverts = cverts;
+	}
+	ret = sw->nverts;
+	sw->nverts += n;
+	return ret;
+}
+
+static int swnvg__allocPaints(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->npaints+n > sw->cpaints) {
+		SWNVGpaint* paints;
+		int cpaints = swnvg__maxi(sw->npaints + n, 128) + sw->cpaints/2; // 1.5x Overallocate
+		paints = (SWNVGpaint*)realloc(sw->paints, sizeof(SWNVGpaint) * cpaints);
+		if (paints == NULL) return -1;
+		sw->paints = paints;
+		sw->cpaints = cpaints;
+	}
+	ret = sw->npaints;
+	sw->npaints += n;
+	return ret;
+}
+
+static int swnvg__allocQuads(SWNVGcontext* sw, int n)
+{
+	int ret = 0;
+	if (sw->nquads+n > sw->cquads) {
+		SWNVGquad* quads;
+		int cquads = swnvg__maxi(sw->nquads + n, 1024) + sw->cquads/2; // 1.5x Overallocate
+		quads = (SWNVGquad*)realloc(sw->quads, sizeof(SWNVGquad) * cquads);
+		if (quads == NULL) return -1;
+		sw->quads = quads;
+		sw->cquads = cquads;
+	}
+	ret = sw->nquads;
+	sw->nquads += n;
+	return ret;
+}
+
+static void swnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
+{
+	vtx->x = x;
+	vtx->y = y;
+	vtx->u = u;
+	vtx->v = v;
+}
+
+static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+							  const float* bounds, const NVGpath* paths, int npaths)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = swnvg__allocCall(sw);
+	NVGvertex* quad;
+	float vbounds[4] = { 1e6f, 1e6f, -1e6f, -1e6f };
+	int i, maxverts, offset;
+
+	if (call == NULL) return;
+
+	call->type = SWNVG_FILL;
+	call->triangleCount = 4;
+	call->pathOffset = swnvg__allocPaths(sw, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->blend = swnvg__blendCompositeOperation(compositeOperation);
+
+	if (npaths == 1 && paths[0].convex)
+	{
+		call->type = SWNVG_CONVEXFILL;
+		call->triangleCount = 0;	// Bounding box fill quad not needed for convex fill
+	}
+
+	// Allocate vertices for all the paths.
+	maxverts = swnvg__maxVertCount(paths, npaths) + call->triangleCount;
+	offset = swnvg__allocVerts(sw, maxverts);
+	if (offset == -1) goto error;
+
+	for (i = 0; i < npaths; i++) {
+		SWNVGpath* copy = &sw->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(SWNVGpath));
+		if (path->nfill > 0) {
+			copy->fillOffset = offset;
+			copy->fillCount = path->nfill;
+			memcpy(&sw->verts[offset], path->fill, sizeof(NVGvertex) * path->nfill);
+			offset += path->nfill;
+		}
+		if (path->nstroke > 0) {
+			copy->strokeOffset = offset;
+			copy->strokeCount = path->nstroke;
+			memcpy(&sw->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			offset += path->nstroke;
+		}
+		swnvg__vertexBounds(sw, path->fill, path->nfill, vbounds);
+		swnvg__vertexBounds(sw, path->stroke, path->nstroke, vbounds);
+	}
+
+	if (call->type == SWNVG_FILL) {
+		// Quad
+		call->triangleOffset = offset;
+		quad = &sw->verts[call->triangleOffset];
+		swnvg__vset(&quad[0], bounds[2], bounds[3], 0.5f, 1.0f);
+		swnvg__vset(&quad[1], bounds[2], bounds[1], 0.5f, 1.0f);
+		swnvg__vset(&quad[2], bounds[0], bounds[3], 0.5f, 1.0f);
+		swnvg__vset(&quad[3], bounds[0], bounds[1], 0.5f, 1.0f);
+		swnvg__vertexBounds(sw, quad, 4, vbounds);
+	}
+	swnvg__setPixelBounds(sw, vbounds, call->bounds);
+
+	// Fill shader, the stencil pass doesn't need one.
+	call->paintOffset = swnvg__allocPaints(sw, 1);
+	if (call->paintOffset == -1) goto error;
+	swnvg__convertPaint(sw, &sw->paints[call->paintOffset], paint, scissor, fringe, fringe, -1.0f);
+
+	return;
+
+error:
+	// We get here if call alloc was ok, but something else is not.
+	// Roll back the last call to prevent drawing it.
+	if (sw->ncalls > 0) sw->ncalls--;
+}
+
+static void swnvg__renderStroke(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+								float strokeWidth, const NVGpath* paths, int npaths)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = swnvg__allocCall(sw);
+	float vbounds[4] = { 1e6f, 1e6f, -1e6f, -1e6f };
+	int i, maxverts, offset;
+
+	if (call == NULL) return;
+
+	call->type = SWNVG_STROKE;
+	call->pathOffset = swnvg__allocPaths(sw, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->blend = swnvg__blendCompositeOperation(compositeOperation);
+
+	// Allocate vertices for all the paths.
+	maxverts = swnvg__maxVertCount(paths, npaths);
+	offset = swnvg__allocVerts(sw, maxverts);
+	if (offset == -1) goto error;
+
+	for (i = 0; i < npaths; i++) {
+		SWNVGpath* copy = &sw->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(SWNVGpath));
+		if (path->nstroke) {
+			copy->strokeOffset = offset;
+			copy->strokeCount = path->nstroke;
+			memcpy(&sw->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			offset += path->nstroke;
+		}
+		swnvg__vertexBounds(sw, path->stroke, path->nstroke, vbounds);
+	}
+	swnvg__setPixelBounds(sw, vbounds, call->bounds);
+
+	if (sw->flags & NVGSW_STENCIL_STROKES) {
+		// Fill shader
+		call->paintOffset = swnvg__allocPaints(sw, 2);
+		if (call->paintOffset == -1) goto error;
+
+		swnvg__convertPaint(sw, &sw->paints[call->paintOffset], paint, scissor, strokeWidth, fringe, -1.0f);
+		swnvg__convertPaint(sw, &sw->paints[call->paintOffset + 1], paint, scissor, strokeWidth, fringe, 1.0f - 0.5f/255.0f);
+
+	} else {
+		// Fill shader
+		call->paintOffset = swnvg__allocPaints(sw, 1);
+		if (call->paintOffset == -1) goto error;
+		swnvg__convertPaint(sw, &sw->paints[call->paintOffset], paint, scissor, strokeWidth, fringe, -1.0f);
+	}
+
+	return;
+
+error:
+	// We get here if call alloc was ok, but something else is not.
+	// Roll back the last call to prevent drawing it.
+	if (sw->ncalls > 0) sw->ncalls--;
+}
+
+static void swnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor,
+								   const NVGvertex* verts, int nverts)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = sw->ncalls > 0 ? &sw->calls[sw->ncalls-1] : NULL;
+	SWNVGblend blend = swnvg__blendCompositeOperation(compositeOperation);
+	SWNVGpaint frag;
+	float vbounds[4] = { 1e6f, 1e6f, -1e6f, -1e6f };
+	int bounds[4], offset;
+
+	// Fill shader
+	swnvg__convertPaint(sw, &frag, paint, scissor, 1.0f, 1.0f, -1.0f);
+	frag.type = SWNVG_SHADER_IMG;
+
+	// Allocate vertices for all the paths.
+	offset = swnvg__allocVerts(sw, nverts);
+	if (offset == -1) return;
+	memcpy(&sw->verts[offset], verts, sizeof(NVGvertex) * nverts);
+	swnvg__vertexBounds(sw, verts, nverts, vbounds);
+	swnvg__setPixelBounds(sw, vbounds, bounds);
+
+	// Triangles are appended to the previous call when it has the same state, see glnvg__renderTriangles().
+	if (call == NULL || call->type != SWNVG_TRIANGLES ||
+		memcmp(&call->blend, &blend, sizeof(blend)) != 0 ||
+		memcmp(&sw->paints[call->paintOffset], &frag, sizeof(frag)) != 0) {
+		call = swnvg__allocCall(sw);
+		if (call == NULL) goto error;
+		call->type = SWNVG_TRIANGLES;
+		call->blend = blend;
+		call->triangleOffset = offset;
+		call->bounds[0] = sw->width;
+		call->bounds[1] = sw->height;
+		call->paintOffset = swnvg__allocPaints(sw, 1);
+		if (call->paintOffset == -1) {
+			sw->ncalls--;
+			goto error;
+		}
+		memcpy(&sw->paints[call->paintOffset], &frag, sizeof(frag));
+	}
+	call->triangleCount += nverts;
+	call->bounds[0] = swnvg__mini(call->bounds[0], bounds[0]);
+	call->bounds[1] = swnvg__mini(call->bounds[1], bounds[1]);
+	call->bounds[2] = swnvg__maxi(call->bounds[2], bounds[2]);
+	call->bounds[3] = swnvg__maxi(call->bounds[3], bounds[3]);
+
+	return;
+
+error:
+	sw->nverts -= nverts;
+}
+
+static int swnvg__renderQuads(void* uptr, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, float fringe,
+							  const NVGquad* quads, int nquads)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	SWNVGcall* call = sw->ncalls > 0 ? &sw->calls[sw->ncalls-1] : NULL;
+	SWNVGblend blend = swnvg__blendCompositeOperation(compositeOperation);
+	SWNVGpaint frag;
+	NVGpaint paint;
+	int i, offset;
+
+	// Only the scissor part of the paint is used by quads.
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	swnvg__convertPaint(sw, &frag, &paint, scissor, 1.0f, fringe, -1.0f);
+
+	offset = swnvg__allocQuads(sw, nquads);
+	if (offset == -1) return 0;
+
+	// Quads are appended to the previous call when it is a quad batch with the same state, see glnvg__renderQuads().
+	if (call == NULL || call->type != SWNVG_QUADS ||
+		memcmp(&call->blend, &blend, sizeof(blend)) != 0 ||
+		memcmp(&sw->paints[call->paintOffset], &frag, sizeof(frag)) != 0) {
+		call = swnvg__allocCall(sw);
+		if (call == NULL) goto error;
+		call->type = SWNVG_QUADS;
+		call->blend = blend;
+		call->instanceOffset = offset;
+		call->bounds[0] = sw->width;
+		call->bounds[1] = sw->height;
+		call->paintOffset = swnvg__allocPaints(sw, 1);
+		if (call->paintOffset == -1) {
+			sw->ncalls--;
+			goto error;
+		}
+		memcpy(&sw->paints[call->paintOffset], &frag, sizeof(frag));
+	}
+	call->instanceCount += nquads;
+
+	for (i = 0; i < nquads; i++) {
+		const NVGquad* quad = &quads[i];
+		SWNVGquad* inst = &sw->quads[offset + i];
+		float pad = quad->strokeWidth*0.5f + fringe;
+		float sx = sqrtf(quad->xform[0]*quad->xform[0] + quad->xform[1]*quad->xform[1]);
+		float sy = sqrtf(quad->xform[2]*quad->xform[2] + quad->xform[3]*quad->xform[3]);
+		float vbounds[4] = { 1e6f, 1e6f, -1e6f, -1e6f };
+		int c;
+
+		nvgTransformInverse(inst->invxform, quad->xform);
+		inst->extent[0] = quad->extent[0];
+		inst->extent[1] = quad->extent[1];
+		inst->pad[0] = sx > 1e-6f ? pad / sx : 0.0f;
+		inst->pad[1] = sy > 1e-6f ? pad / sy : 0.0f;
+		swnvg__premulColor(inst->color, quad->color);
+		inst->strokeWidth = quad->strokeWidth / fringe;
+		inst->shape = quad->shape;
+		inst->bevel = quad->shape == NVG_QUAD_RECT && quad->lineJoin == NVG_BEVEL;
+
+		for (c = 0; c < 4; c++) {
+			float lx = (c & 1 ? 1.0f : -1.0f) * (inst->extent[0] + inst->pad[0]);
+			float ly = (c & 2 ? 1.0f : -1.0f) * (inst->extent[1] + inst->pad[1]);
+			float px = quad->xform[0]*lx + quad->xform[2]*ly + quad->xform[4];
+			float py = quad->xform[1]*lx + quad->xform[3]*ly + quad->xform[5];
+			vbounds[0] = swnvg__minf(vbounds[0], px);
+			vbounds[1] = swnvg__minf(vbounds[1], py);
+			vbounds[2] = swnvg__maxf(vbounds[2], px);
+			vbounds[3] = swnvg__maxf(vbounds[3], py);
+		}
+		swnvg__setPixelBounds(sw, vbounds, inst->bounds);
+
+		call->bounds[0] = swnvg__mini(call->bounds[0], inst->bounds[0]);
+		call->bounds[1] = swnvg__mini(call->bounds[1], inst->bounds[1]);
+		call->bounds[2] = swnvg__maxi(call->bounds[2], inst->bounds[2]);
+		call->bounds[3] = swnvg__maxi(call->bounds[3], inst->bounds[3]);
+	}
+
+	return 1;
+
+error:
+	sw->nquads -= nquads;
+	return 0;
+}
+
+static void swnvg__renderDelete(void* uptr)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)uptr;
+	int i;
+	if (sw == NULL) return;
+
+	if (sw->nworkers > 0) {
+		mtx_lock(&sw->lock);
+		sw->quit = 1;
+		cnd_broadcast(&sw->wake);
+		mtx_unlock(&sw->lock);
+		for (i = 0; i < sw->nworkers; i++) {
+			thrd_join(sw->workers[i].thread, NULL);
+			swnvg__freeTile(&sw->workers[i].tile);
+		}
+	}
+	if (sw->workers != NULL) {
+		cnd_destroy(&sw->done);
+		cnd_destroy(&sw->wake);
+		mtx_destroy(&sw->lock);
+		free(sw->workers);
+	}
+	swnvg__freeTile(&sw->tile);
+
+	swnvg__restoreTarget(sw);
+	for (i = 0; i < sw->ntextures; i++)
+		free(sw->textures[i].data);
+	free(sw->textures);
+
+	free(sw->pixels);
+	free(sw->paths);
+	free(sw->verts);
+	free(sw->paints);
+	free(sw->quads);
+	free(sw->calls);
+	free(sw->bins);
+	free(sw->binOffsets);
+
+	free(sw);
+}
+
+static void swnvg__startWorkers(SWNVGcontext* sw, int threads)
+{
+	int i;
+
+	if (threads <= 1) return;
+	sw->workers = (SWNVGworker*)malloc(sizeof(SWNVGworker) * (threads - 1));
+	if (sw->workers == NULL) return;
+	memset(sw->workers, 0, sizeof(SWNVGworker) * (threads - 1));
+	mtx_init(&sw->lock, mtx_plain);
+	cnd_init(&sw->wake);
+	cnd_init(&sw->done);
+
+	for (i = 0; i < threads - 1; i++) {
+		SWNVGworker* worker = &sw->workers[sw->nworkers];
+		worker->sw = sw;
+		if (!swnvg__allocTile(&worker->tile)) {
+			swnvg__freeTile(&worker->tile);
+			break;
+		}
+		if (thrd_create(&worker->thread, swnvg__worker, worker) != thrd_success) {
+			swnvg__freeTile(&worker->tile);
+			break;
+		}
+		sw->nworkers++;
+	}
+}
+
+NVGcontext* nvgCreateSW(int flags, int threads)
+{
+	NVGparams params;
+	NVGcontext* ctx = NULL;
+	SWNVGcontext* sw = (SWNVGcontext*)malloc(sizeof(SWNVGcontext));
+	if (sw == NULL) goto error;
+	memset(sw, 0, sizeof(SWNVGcontext));
+	sw->scale[0] = sw->scale[1] = 1.0f;
+	sw->clip[2] = -1;
+
+	memset(&params, 0, sizeof(params));
+	params.renderCreate = swnvg__renderCreate;
+	params.renderCreateTexture = swnvg__renderCreateTexture;
+	params.renderDeleteTexture = swnvg__renderDeleteTexture;
+	params.renderUpdateTexture = swnvg__renderUpdateTexture;
+	params.renderGetTexturePixelData = swnvg__renderGetTexturePixelData;
+	params.renderGetTextureSize = swnvg__renderGetTextureSize;
+	params.renderViewport = swnvg__renderViewport;
+	params.renderCancel = swnvg__renderCancel;
+	params.renderFlush = swnvg__renderFlush;
+	params.renderFill = swnvg__renderFill;
+	params.renderStroke = swnvg__renderStroke;
+	params.renderTriangles = swnvg__renderTriangles;
+	params.renderQuads = swnvg__renderQuads;
+	params.renderDelete = swnvg__renderDelete;
+	params.userPtr = sw;
+	params.edgeAntiAlias = flags & NVGSW_ANTIALIAS ? 1 : 0;
+
+	sw->flags = flags;
+	if (!swnvg__allocTile(&sw->tile)) {
+		swnvg__renderDelete(sw);
+		return NULL;
+	}
+	swnvg__startWorkers(sw, threads);
+
+	ctx = nvgCreateInternal(&params);
+	if (ctx == NULL) goto error;
+
+	return ctx;
+
+error:
+	// 'sw' is freed by nvgDeleteInternal.
+	if (ctx != NULL) nvgDeleteInternal(ctx);
+	return NULL;
+}
+
+void nvgDeleteSW(NVGcontext* ctx)
+{
+	nvgDeleteInternal(ctx);
+}
+
+int nvgswResize(NVGcontext* ctx, int width, int height)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	unsigned char* pixels;
+
+	if (width <= 0 || height <= 0) return 0;
+	swnvg__restoreTarget(sw);
+	if (width == sw->width && height == sw->height) return 1;
+
+	pixels = (unsigned char*)realloc(sw->pixels, (size_t)width * height * 4);
+	if (pixels == NULL) return 0;
+	memset(pixels, 0, (size_t)width * height * 4);
+	sw->pixels = pixels;
+	sw->width = width;
+	sw->height = height;
+	swnvg__renderViewport(sw, (int)sw->view[0], (int)sw->view[1], 1.0f);
+	return 1;
+}
+
+void nvgswClear(NVGcontext* ctx, NVGcolor color)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	nvgswClearRect(ctx, 0, 0, sw->width, sw->height, color);
+}
+
+void nvgswClearRect(NVGcontext* ctx, int x, int y, int w, int h, NVGcolor color)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	unsigned char c[4];
+	int x0 = swnvg__maxi(x, 0), y0 = swnvg__maxi(y, 0);
+	int x1 = swnvg__mini(x + w, sw->width), y1 = swnvg__mini(y + h, sw->height);
+	int i, j;
+
+	c[0] = (unsigned char)(swnvg__clampf(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+	c[1] = (unsigned char)(swnvg__clampf(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+	c[2] = (unsigned char)(swnvg__clampf(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+	c[3] = (unsigned char)(swnvg__clampf(color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+	for (j = y0; j < y1; j++) {
+		unsigned char* row = &sw->pixels[((size_t)j * sw->width) * 4];
+		for (i = x0; i < x1; i++)
+			memcpy(&row[i * 4], c, 4);
+	}
+}
+
+void nvgswClip(NVGcontext* ctx, int x, int y, int w, int h)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	sw->clip[0] = x;
+	sw->clip[1] = y;
+	sw->clip[2] = w < 0 ? -1 : w;
+	sw->clip[3] = swnvg__maxi(h, 0);
+}
+
+const unsigned char* nvgswPixels(NVGcontext* ctx, int* width, int* height)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	if (width != NULL) *width = sw->width;
+	if (height != NULL) *height = sw->height;
+	return sw->pixels;
+}
+
+int nvgswSetTarget(NVGcontext* ctx, int image)
+{
+	SWNVGcontext* sw = (SWNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	SWNVGtexture* tex;
+
+	swnvg__restoreTarget(sw);
+	if (image == 0) return 1;
+
+	tex = swnvg__findTexture(sw, image);
+	if (tex == NULL || tex->type != NVG_TEXTURE_RGBA) return 0;
+
+	// The image pixels have the same layout as the framebuffer, so they simply stand in for it.
+	sw->framePixels = sw->pixels;
+	sw->frameWidth = sw->width;
+	sw->frameHeight = sw->height;
+	sw->pixels = tex->data;
+	sw->width = tex->width;
+	sw->height = tex->height;
+	sw->target = image;
+	return 1;
+}
+
+#endif /* NANOVG_SW_IMPLEMENTATION */
@@ -0,0 +1,141 @@
+//---------------------------------------------------------
+// file:	BulkDrawDemo.c
+// 
+// CProcessing features in this demo:
+// CP_Graphics_DrawCircles	- draw thousands of circles from arrays in one call
+// CP_Graphics_DrawLines	- draw thousands of lines from arrays in one call
+// Benchmark comparing the bulk functions with one call per shape
+//
+// SPACE switches between bulk and per shape drawing
+// UP and DOWN double or halve the number of shapes
+//---------------------------------------------------------
+
+#include "cprocessing.h"
+#include "BulkDrawDemo.h"
+#include "DemoManager.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BULK_MAX_SHAPES 65536
+
+int bulkShapeCount = 8192;
+CP_BOOL bulkDrawing = TRUE;
+
+CP_Vector* bulkPositions = NULL;
+CP_Vector* bulkVelocities = NULL;
+float* bulkDiameters = NULL;
+CP_Color* bulkColors = NULL;
+CP_Vector* bulkLinePoints = NULL;
+
+// running average of the time spent issuing draw calls, in milliseconds
+float bulkDrawMillis = 0.0f;
+
+void BulkDrawDemoInit(void)
+{
+	CP_Settings_Save();
+
+	// let the frame rate float so the difference shows up
+	CP_System_SetFrameRate(1000.0f);
+
+	bulkPositions = malloc(sizeof(CP_Vector) * BULK_MAX_SHAPES);
+	bulkVelocities = malloc(sizeof(CP_Vector) * BULK_MAX_SHAPES);
+	bulkDiameters = malloc(sizeof(float) * BULK_MAX_SHAPES);
+	bulkColors = malloc(sizeof(CP_Color) * BULK_MAX_SHAPES);
+	bulkLinePoints = malloc(sizeof(CP_Vector) * 2 * BULK_MAX_SHAPES);
+
+	for (int i = 0; i < BULK_MAX_SHAPES; ++i)
+	{
+		bulkPositions[i] = CP_Vector_Set(CP_Random_RangeFloat(0, (float)CP_System_GetWindowWidth()), CP_Random_RangeFloat(0, (float)CP_System_GetWindowHeight()));
+		bulkVelocities[i] = CP_Vector_Set(CP_Random_RangeFloat(-100, 100), CP_Random_RangeFloat(-100, 100));
+		bulkDiameters[i] = CP_Random_RangeFloat(2, 8);
+		bulkColors[i] = CP_Color_FromColorHSL(CP_ColorHSL_Create(CP_Random_RangeInt(0, 360), 70, 60, 200));
+	}
+}
+
+void BulkDrawDemoUpdate(void)
+{
+	CP_Graphics_ClearBackground(GetCommonBackgoundColor());
+
+	// User Input
+	if (CP_Input_KeyTriggered(KEY_SPACE))
+	{
+		bulkDrawing = !bulkDrawing;
+	}
+	if (CP_Input_KeyTriggered(KEY_UP) && bulkShapeCount < BULK_MAX_SHAPES)
+	{
+		bulkShapeCount *= 2;
+	}
+	if (CP_Input_KeyTriggered(KEY_DOWN) && bulkShapeCount > 256)
+	{
+		bulkShapeCount /= 2;
+	}
+
+	// move the shapes, wrapping around the window
+	float dt = CP_System_GetDt();
+	float width = (float)CP_System_GetWindowWidth();
+	float height = (float)CP_System_GetWindowHeight();
+	for (int i = 0; i < bulkShapeCount; ++i)
+	{
+		CP_Vector* pos = &bulkPositions[i];
+		*pos = CP_Vector_Add(*pos, CP_Vector_Scale(bulkVelocities[i], dt));
+		pos->x = pos->x < 0 ? pos->x + width : (pos->x > width ? pos->x - width : pos->x);
+		pos->y = pos->y < 0 ? pos->y + height : (pos->y > height ? pos->y - height : pos->y);
+
+		// a short tail behind each shape
+		bulkLinePoints[i * 2] = *pos;
+		bulkLinePoints[i * 2 + 1] = CP_Vector_Subtract(*pos, CP_Vector_Scale(bulkVelocities[i], 0.1f));
+	}
+
+	float start = CP_System_GetMillis();
+
+	CP_Settings_StrokeWeight(1.0f);
+	CP_Settings_LineCapMode(CP_LINE_CAP_BUTT);
+	if (bulkDrawing)
+	{
+		CP_Graphics_DrawLines(bulkLinePoints, bulkColors, bulkShapeCount);
+	}
+	else
+	{
+		for (int i = 0; i < bulkShapeCount; ++i)
+		{
+			CP_Settings_Stroke(bulkColors[i]);
+			CP_Graphics_DrawLine(bulkLinePoints[i * 2].x, bulkLinePoints[i * 2].y, bulkLinePoints[i * 2 + 1].x, bulkLinePoints[i * 2 + 1].y);
+		}
+	}
+
+	CP_Settings_NoStroke();
+	if (bulkDrawing)
+	{
+		CP_Graphics_DrawCircles(bulkPositions, bulkDiameters, bulkColors, bulkShapeCount);
+	}
+	else
+	{
+		for (int i = 0; i < bulkShapeCount; ++i)
+		{
+			CP_Settings_Fill(bulkColors[i]);
+			CP_Graphics_DrawCircle(bulkPositions[i].x, bulkPositions[i].y, bulkDiameters[i]);
+		}
+	}
+
+	bulkDrawMillis = CP_Math_LerpFloat(bulkDrawMillis, CP_System_GetMillis() - start, 0.05f);
+
+	// results
+	char buffer[128] = { 0 };
+	CP_Settings_Fill(CP_Color_Create(255, 255, 255, 255));
+	CP_Settings_TextSize(24.0f);
+	sprintf_s(buffer, _countof(buffer), "%s: %d circles + %d lines", bulkDrawing ? "Bulk" : "Per shape", bulkShapeCount, bulkShapeCount);
+	CP_Font_DrawText(buffer, 10, 30);
+	sprintf_s(buffer, _countof(buffer), "draw calls: %.2f ms   fps: %.0f", bulkDrawMillis, CP_System_GetFrameRate());
+	CP_Font_DrawText(buffer, 10, 60);
+}
+
+void BulkDrawDemoExit(void)
+{
+	free(bulkPositions);
+	free(bulkVelocities);
+	free(bulkDiameters);
+	free(bulkColors);
+	free(bulkLinePoints);
+	CP_System_SetFrameRate(60.0f);
+	CP_Settings_Restore();
+}
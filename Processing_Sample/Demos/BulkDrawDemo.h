@@ -0,0 +1,12 @@
+//---------------------------------------------------------
+// file:	BulkDrawDemo.h
+// 
+// CProcessing features in this demo:
+// CP_Graphics_DrawCircles	- draw thousands of circles from arrays in one call
+// CP_Graphics_DrawLines	- draw thousands of lines from arrays in one call
+// Benchmark comparing the bulk functions with one call per shape
+//---------------------------------------------------------
+
+void BulkDrawDemoInit(void);
+void BulkDrawDemoUpdate(void);
+void BulkDrawDemoExit(void);
@@ -12,6 +12,7 @@
 #include "DancingLinesDemo.h"
 #include "GamepadDemo.h"
 #include "NoiseDemo.h"
+#include "BulkDrawDemo.h"
 
 // window size and fullscreen
 int windowWidth = 1280;
@@ -42,6 +43,7 @@ GamestateFuncs demoGamestateArray[] =
 	GAMESTATE_FUNCS(DancingLinesDemo),
 	GAMESTATE_FUNCS(GamepadDemo),
 	GAMESTATE_FUNCS(NoiseDemo),
+	GAMESTATE_FUNCS(BulkDrawDemo),
 };
 
 enum GAMESTATE_ENUM
@@ -50,6 +52,7 @@ enum GAMESTATE_ENUM
 	DancingLinesDemo,
 	GamepadDemo,
 	NoiseDemo,
+	BulkDrawDemo,
 	GAMESTATE_MAX,
 };
 
@@ -4,6 +4,7 @@
 // CProcessing features in this demo:
 // CP_Vector				- Lots of math going on here
 // CP_Color_Lerp			- Smooth color changes based on line length
+// CP_Graphics_DrawLines	- Draw every grid edge with its own color in a single call
 //---------------------------------------------------------
 
 #include "cprocessing.h"
@@ -23,12 +24,37 @@ CP_Vector* grid_velocities = NULL;
 CP_Vector* grid_offsets = NULL;
 CP_Vector* grid_offsets_cache = NULL;
 
+// start and end points and a color for every grid edge
+int grid_line_count = 0;
+CP_Vector* grid_line_points = NULL;
+CP_Color* grid_line_colors = NULL;
+
 CP_Color grid_color_base = { 50, 50, 50, 255 };
 CP_Color grid_color_high = { 30, 180, 255, 255 };
 CP_Color grid_color_low = { 255, 180, 30, 255 };
 
+CP_Color GridLineColor(float delta)
+{
+	if (delta >= grid_stride)
+	{
+		return CP_Color_Lerp(grid_color_base, grid_color_high, (delta - grid_stride) / 2.0f);
+	}
+	return CP_Color_Lerp(grid_color_base, grid_color_low, (grid_stride - delta) / 3.0f);
+}
+
+void AddGridLine(CP_Vector p1, CP_Vector p2)
+{
+	float delta = CP_Vector_Length(CP_Vector_Subtract(p2, p1));
+	grid_line_points[grid_line_count * 2] = p1;
+	grid_line_points[grid_line_count * 2 + 1] = p2;
+	grid_line_colors[grid_line_count] = GridLineColor(delta);
+	++grid_line_count;
+}
+
 void DrawGrid(void)
 {
+	// collect all edges, then draw them at once
+	grid_line_count = 0;
 	for (int j = 0; j < grid_height; ++j)
 	{
 		for (int i = 0; i < grid_width; ++i)
@@ -36,36 +62,17 @@ void DrawGrid(void)
 			CP_Vector p1 = CP_Vector_Add(grid_positions[j * grid_width + i], grid_offsets[j * grid_width + i]);
 			if (i < grid_width - 1)
 			{
-				CP_Vector p2 = CP_Vector_Add(grid_positions[j * grid_width + i + 1], grid_offsets[j * grid_width + i + 1]);
-				float delta = CP_Vector_Length(CP_Vector_Subtract(p2, p1));
-				if (delta >= grid_stride)
-				{
-					CP_Settings_Stroke(CP_Color_Lerp(grid_color_base, grid_color_high, (delta - grid_stride) / 2.0f));
-				}
-				else
-				{
-					CP_Settings_Stroke(CP_Color_Lerp(grid_color_base, grid_color_low, (grid_stride - delta) / 3.0f));
-				}
-				CP_Settings_StrokeWeight(2.0f);
-				CP_Graphics_DrawLine(p1.x, p1.y, p2.x, p2.y);
+				AddGridLine(p1, CP_Vector_Add(grid_positions[j * grid_width + i + 1], grid_offsets[j * grid_width + i + 1]));
 			}
 			if (j < grid_height - 1)
 			{
-				CP_Vector p2 = CP_Vector_Add(grid_positions[(j + 1) * grid_width + i], grid_offsets[(j + 1) * grid_width + i]);
-				float delta = CP_Vector_Length(CP_Vector_Subtract(p2, p1));
-				if (delta >= grid_stride)
-				{
-					CP_Settings_Stroke(CP_Color_Lerp(grid_color_base, grid_color_high, (delta - grid_stride) / 2.0f));
-				}
-				else
-				{
-					CP_Settings_Stroke(CP_Color_Lerp(grid_color_base, grid_color_low, (grid_stride - delta) / 3.0f));
-				}
-				CP_Settings_StrokeWeight(2.0f);
-				CP_Graphics_DrawLine(p1.x, p1.y, p2.x, p2.y);
+				AddGridLine(p1, CP_Vector_Add(grid_positions[(j + 1) * grid_width + i], grid_offsets[(j + 1) * grid_width + i]));
 			}
 		}
 	}
+
+	CP_Settings_StrokeWeight(2.0f);
+	CP_Graphics_DrawLines(grid_line_points, grid_line_colors, grid_line_count);
 }
 
 void UpdateGrid(void)
@@ -114,6 +121,10 @@ void GridWaveDemoInit(void)
 	// setup grid offsets
 	grid_offsets = calloc(sizeof(CP_Vector), grid_width * grid_height);
 	grid_offsets_cache = calloc(sizeof(CP_Vector), grid_width * grid_height);
+
+	// setup line buffers, each grid point owns at most two edges
+	grid_line_points = malloc(sizeof(CP_Vector) * 4 * grid_width * grid_height);
+	grid_line_colors = malloc(sizeof(CP_Color) * 2 * grid_width * grid_height);
 }
 
 void GridWaveDemoUpdate(void)
@@ -173,5 +184,7 @@ void GridWaveDemoExit(void)
 	free(grid_velocities);
 	free(grid_offsets);
 	free(grid_offsets_cache);
+	free(grid_line_points);
+	free(grid_line_colors);
 	CP_Settings_Restore();
 }